@@ -9,7 +9,7 @@ SDL_PATH := ../SDL
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/$(SDL_PATH)/include
 
 # Add your application source files here...
-LOCAL_SRC_FILES := main.c game.c osd.c pfs.c utils.c wordlist_de.c wordlist_en.c wordlist_fi.c wordlist_ru.c wordlist_utils.c
+LOCAL_SRC_FILES := main.c adversarial.c arena.c bench.c decision_tree.c framebuffer.c game.c game_core.c headless.c multi_board.c opening_book.c osd.c pfs.c predict.c replay.c save.c shuffle.c stats.c storage.c suggest.c utils.c wordlist_de.c wordlist_en.c wordlist_fi.c wordlist_ru.c wordlist_utils.c
 
 LOCAL_SHARED_LIBRARIES := SDL2
 
@@ -0,0 +1,89 @@
+/** @file adversarial.c
+ *
+ *  Adversarial endless mode: there is no fixed answer.  After each
+ *  guess, the remaining candidates are grouped by the feedback they
+ *  would produce and the largest group is kept, so the game holds out
+ *  as long as possible.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL_stdinc.h"
+#include "game_core.h"
+
+#define PATTERN_SOLVED 242
+
+void adversarial_reset(const wordlist_t* wordlist, adversarial_t* adversarial)
+{
+    Uint32 index;
+
+    if (NULL == wordlist || NULL == adversarial)
+    {
+        return;
+    }
+
+    adversarial->candidate_count = (wordlist->word_count < ADVERSARIAL_MAX_WORDS) ? wordlist->word_count : ADVERSARIAL_MAX_WORDS;
+    adversarial->is_active       = SDL_TRUE;
+
+    for (index = 0; index < adversarial->candidate_count; index += 1)
+    {
+        adversarial->candidate[index] = (Uint16)index;
+    }
+}
+
+// Keeps the candidates of the largest feedback group and returns one
+// of them, which then serves as the answer for scoring the guess.
+// The solved pattern is only picked when nothing else is left; ties go
+// to the lower pattern, i.e. the one revealing less.
+unsigned int adversarial_guess(const unsigned char* guess, const wordlist_t* wordlist, adversarial_t* adversarial)
+{
+    Uint32 index;
+    Uint32 kept = 0;
+    Uint8  best = PATTERN_SOLVED;
+
+    if (NULL == guess || NULL == wordlist || NULL == adversarial || 0 == adversarial->candidate_count)
+    {
+        return 0;
+    }
+
+    // Count the size of each group in one pass, and remember the
+    // pattern of each candidate for the second one.
+    SDL_memset(adversarial->group_size, 0, sizeof(adversarial->group_size));
+
+    for (index = 0; index < adversarial->candidate_count; index += 1)
+    {
+        state_t result[5];
+        Uint8   pattern;
+
+        score_guess(guess, wordlist->list[adversarial->candidate[index]], result);
+
+        pattern                          = get_pattern_code(result);
+        adversarial->pattern[index]      = pattern;
+        adversarial->group_size[pattern] += 1;
+    }
+
+    for (index = 0; index < PATTERN_SOLVED; index += 1)
+    {
+        if (adversarial->group_size[index] > adversarial->group_size[best] || (PATTERN_SOLVED == best && 0 != adversarial->group_size[index]))
+        {
+            best = (Uint8)index;
+        }
+    }
+
+    // Only the kept group is needed, so it is compacted in place
+    // instead of sorting every group into its own range.
+    for (index = 0; index < adversarial->candidate_count; index += 1)
+    {
+        if (best == adversarial->pattern[index])
+        {
+            adversarial->candidate[kept] = adversarial->candidate[index];
+            kept                        += 1;
+        }
+    }
+
+    adversarial->candidate_count = (Uint16)kept;
+
+    return adversarial->candidate[0];
+}
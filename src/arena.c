@@ -0,0 +1,241 @@
+/** @file arena.c
+ *
+ *  Startup memory: a linear arena for everything allocated while the
+ *  resources are loaded, so the temporary buffers of the PNG decoder
+ *  and the file loader do not fragment the heap.  Each game instance
+ *  has its own, which is reset after each texture has been uploaded
+ *  and released once all are; anything that does not fit is taken
+ *  from the heap.
+ *
+ *  Debug builds also count the heap allocations of the main thread,
+ *  see check_heap_allocations().  The count is process-wide, as are
+ *  SDL's memory functions.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL.h"
+#include "game.h"
+
+// Each block starts with its size, which also keeps it aligned.
+#define ARENA_HEADER_SIZE 8
+
+void   arena_init(size_t capacity, arena_t* arena);
+void   arena_quit(arena_t* arena);
+void   arena_reset(arena_t* arena);
+void*  arena_alloc(size_t size, arena_t* arena);
+void*  arena_realloc(void* pointer, size_t size, arena_t* arena);
+void   arena_free(void* pointer, arena_t* arena);
+void   arena_count_heap_allocations(void);
+Uint32 arena_get_heap_allocations(void);
+
+static SDL_bool is_in_arena(const void* pointer, const arena_t* arena);
+
+#ifndef NDEBUG
+static void*  SDLCALL count_malloc(size_t size);
+static void*  SDLCALL count_calloc(size_t count, size_t size);
+static void*  SDLCALL count_realloc(void* pointer, size_t size);
+static void   count_allocation(void);
+
+static SDL_malloc_func  heap_malloc;
+static SDL_calloc_func  heap_calloc;
+static SDL_realloc_func heap_realloc;
+static SDL_free_func    heap_free;
+static SDL_threadID     main_thread;
+static Uint32           heap_allocations;
+static SDL_bool         is_counting;
+#endif
+
+// If the arena cannot be allocated, everything comes from the heap.
+void arena_init(size_t capacity, arena_t* arena)
+{
+    SDL_memset(arena, 0, sizeof(arena_t));
+
+    arena->base = (Uint8*)SDL_malloc(capacity);
+    if (NULL != arena->base)
+    {
+        arena->capacity = capacity;
+    }
+}
+
+void arena_quit(arena_t* arena)
+{
+    SDL_free(arena->base);
+    SDL_memset(arena, 0, sizeof(arena_t));
+}
+
+void arena_reset(arena_t* arena)
+{
+    arena->top  = 0;
+    arena->last = 0;
+}
+
+void* arena_alloc(size_t size, arena_t* arena)
+{
+    size_t block_size = ARENA_HEADER_SIZE + ((size + (ARENA_HEADER_SIZE - 1)) & ~(size_t)(ARENA_HEADER_SIZE - 1));
+    Uint8* block;
+
+    if (block_size < size || block_size > arena->capacity - arena->top)
+    {
+        return SDL_malloc(size);
+    }
+
+    block = &arena->base[arena->top];
+    SDL_memcpy(block, &size, sizeof(size_t));
+
+    arena->last  = arena->top;
+    arena->top  += block_size;
+
+    return block + ARENA_HEADER_SIZE;
+}
+
+// The last block grows in place, as the PNG decoder's buffers do.
+void* arena_realloc(void* pointer, size_t size, arena_t* arena)
+{
+    Uint8* block;
+    size_t old_size;
+    void*  grown;
+
+    if (NULL == pointer)
+    {
+        return arena_alloc(size, arena);
+    }
+
+    if (SDL_FALSE == is_in_arena(pointer, arena))
+    {
+        return SDL_realloc(pointer, size);
+    }
+
+    block = (Uint8*)pointer - ARENA_HEADER_SIZE;
+    SDL_memcpy(&old_size, block, sizeof(size_t));
+
+    if ((size_t)(block - arena->base) == arena->last)
+    {
+        size_t top = arena->top;
+
+        arena->top = arena->last;
+        grown      = arena_alloc(size, arena);
+
+        if (grown == pointer)
+        {
+            return grown;
+        }
+
+        // Moved to the heap.
+        arena->top = top;
+        if (NULL == grown)
+        {
+            return NULL;
+        }
+    }
+    else
+    {
+        grown = arena_alloc(size, arena);
+        if (NULL == grown)
+        {
+            return NULL;
+        }
+    }
+
+    SDL_memcpy(grown, pointer, (old_size < size) ? old_size : size);
+    arena_free(pointer, arena);
+
+    return grown;
+}
+
+// Only the last block is given back, others wait for the reset.
+void arena_free(void* pointer, arena_t* arena)
+{
+    Uint8* block;
+
+    if (NULL == pointer)
+    {
+        return;
+    }
+
+    if (SDL_FALSE == is_in_arena(pointer, arena))
+    {
+        SDL_free(pointer);
+        return;
+    }
+
+    block = (Uint8*)pointer - ARENA_HEADER_SIZE;
+
+    if ((size_t)(block - arena->base) == arena->last)
+    {
+        arena->top = arena->last;
+    }
+}
+
+// Must be called before SDL_Init() to count all heap allocations.  The
+// counting functions are installed once and never replaced, so a
+// second game instance does not wrap them again.
+void arena_count_heap_allocations(void)
+{
+#ifndef NDEBUG
+    if (SDL_TRUE == is_counting)
+    {
+        return;
+    }
+
+    SDL_GetMemoryFunctions(&heap_malloc, &heap_calloc, &heap_realloc, &heap_free);
+    if (0 == SDL_SetMemoryFunctions(count_malloc, count_calloc, count_realloc, heap_free))
+    {
+        main_thread = SDL_ThreadID();
+        is_counting = SDL_TRUE;
+    }
+#endif
+}
+
+// Of the main thread so far, 0 in release builds.
+Uint32 arena_get_heap_allocations(void)
+{
+#ifndef NDEBUG
+    return heap_allocations;
+#else
+    return 0;
+#endif
+}
+
+static SDL_bool is_in_arena(const void* pointer, const arena_t* arena)
+{
+    const Uint8* byte = (const Uint8*)pointer;
+
+    if (NULL == arena->base)
+    {
+        return SDL_FALSE;
+    }
+
+    return ((byte >= arena->base) && (byte < arena->base + arena->capacity)) ? SDL_TRUE : SDL_FALSE;
+}
+
+#ifndef NDEBUG
+static void* SDLCALL count_malloc(size_t size)
+{
+    count_allocation();
+    return heap_malloc(size);
+}
+
+static void* SDLCALL count_calloc(size_t count, size_t size)
+{
+    count_allocation();
+    return heap_calloc(count, size);
+}
+
+static void* SDLCALL count_realloc(void* pointer, size_t size)
+{
+    count_allocation();
+    return heap_realloc(pointer, size);
+}
+
+// The storage thread writes files, which allocates.
+static void count_allocation(void)
+{
+    if (SDL_ThreadID() == main_thread)
+    {
+        heap_allocations += 1;
+    }
+}
+#endif
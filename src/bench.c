@@ -0,0 +1,336 @@
+/** @file bench.c
+ *
+ *  Input latency benchmark: injects key and text events at a fixed
+ *  rate while the game keeps rendering, and measures the time from
+ *  each event being pushed to the end of the frame that handled it,
+ *  i.e. after the frame has been presented.  Results are reported
+ *  separately for the menu, typing and results screens.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include <stdio.h>
+#include "SDL.h"
+#include "game.h"
+
+#define BENCH_MAX_PENDING 256
+#define BENCH_MAX_CHUNK   64
+
+typedef enum
+{
+    PHASE_MENU = 0,
+    PHASE_TYPING,
+    PHASE_RESULTS,
+    PHASE_COUNT
+
+} phase_t;
+
+typedef struct samples
+{
+    Uint32* value;
+    Uint32  count;
+    Uint32  capacity;
+
+} samples_t;
+
+typedef struct pending
+{
+    Uint64   timestamp;
+    phase_t  phase;
+    SDL_bool is_measured;
+
+} pending_t;
+
+typedef struct step
+{
+    SDL_Keycode key;
+    char        text[2];
+
+} step_t;
+
+int bench_run(Uint32 event_count, Uint32 rate, game_t* core);
+
+extern void headless_push_key(SDL_Keycode key);
+extern void headless_push_text(const char* text);
+
+static void    add_sample(Uint32 value, samples_t* samples);
+static Uint32  build_chunk(step_t chunk[BENCH_MAX_CHUNK], phase_t* phase, game_t* core);
+static int     compare_samples(const void* a, const void* b);
+static phase_t current_phase(game_t* core);
+static void    report(const char* name, samples_t* latency, samples_t* frame_time);
+static Uint32  to_microseconds(Uint64 ticks);
+
+int bench_run(Uint32 event_count, Uint32 rate, game_t* core)
+{
+    samples_t    latency[PHASE_COUNT];
+    samples_t    frame_time[PHASE_COUNT];
+    pending_t    pending[BENCH_MAX_PENDING];
+    step_t       chunk[BENCH_MAX_CHUNK];
+    Uint32       pending_head  = 0;
+    Uint32       pending_count = 0;
+    Uint32       chunk_length  = 0;
+    Uint32       chunk_index   = 0;
+    Uint32       injected      = 0;
+    phase_t      chunk_phase   = PHASE_MENU;
+    Uint64       period;
+    Uint64       next_injection;
+    game_hooks_t hooks;
+    int          status        = 0;
+    int          index;
+
+    if (NULL == core || 0 == rate)
+    {
+        return 1;
+    }
+
+    SDL_memset(latency,    0, sizeof(latency));
+    SDL_memset(frame_time, 0, sizeof(frame_time));
+
+    // Keep the save and statistics files out of it.
+    hooks                                = core->state.hooks;
+    core->state.hooks.read_save          = NULL;
+    core->state.hooks.write_save         = NULL;
+    core->state.hooks.append_stats       = NULL;
+    core->state.hooks.write_stats_header = NULL;
+
+    // Let the window settle and drop whatever the driver queued up.
+    for (index = 0; index < 3; index += 1)
+    {
+        game_update(core);
+    }
+    SDL_FlushEvents(SDL_KEYDOWN, SDL_TEXTINPUT);
+
+    period         = SDL_GetPerformanceFrequency() / rate;
+    next_injection = SDL_GetPerformanceCounter();
+
+    while ((injected < event_count || pending_count > 0) && SDL_TRUE == game_is_running(core))
+    {
+        Uint64  frame_start;
+        Uint64  frame_end;
+        phase_t frame_phase = current_phase(core);
+        int     remaining;
+
+        if (injected < event_count && SDL_GetPerformanceCounter() >= next_injection)
+        {
+            // The next chunk depends on the screen the previous one
+            // leads to, so wait until it has been handled.
+            if (chunk_index == chunk_length && 0 == pending_count)
+            {
+                chunk_length = build_chunk(chunk, &chunk_phase, core);
+                chunk_index  = 0;
+            }
+
+            if (chunk_index < chunk_length && pending_count + 2 <= BENCH_MAX_PENDING)
+            {
+                pending_t* entry = &pending[(pending_head + pending_count) % BENCH_MAX_PENDING];
+
+                entry->timestamp   = SDL_GetPerformanceCounter();
+                entry->phase       = chunk_phase;
+                entry->is_measured = SDL_TRUE;
+                pending_count     += 1;
+
+                if (SDLK_UNKNOWN != chunk[chunk_index].key)
+                {
+                    // Key up events are consumed as well, but only the
+                    // key down is measured.
+                    entry               = &pending[(pending_head + pending_count) % BENCH_MAX_PENDING];
+                    entry->timestamp    = SDL_GetPerformanceCounter();
+                    entry->phase        = chunk_phase;
+                    entry->is_measured  = SDL_FALSE;
+                    pending_count      += 1;
+
+                    headless_push_key(chunk[chunk_index].key);
+                }
+                else
+                {
+                    headless_push_text(chunk[chunk_index].text);
+                }
+
+                chunk_index    += 1;
+                injected       += 1;
+                next_injection += period;
+            }
+        }
+
+        frame_start = SDL_GetPerformanceCounter();
+        status      = game_update(core);
+        frame_end   = SDL_GetPerformanceCounter();
+
+        if (0 != status)
+        {
+            break;
+        }
+
+        add_sample(to_microseconds(frame_end - frame_start), &frame_time[frame_phase]);
+
+        // Events are handled in order, so everything no longer queued
+        // was handled by the frame that was just presented.
+        remaining = SDL_PeepEvents(NULL, 0, SDL_PEEKEVENT, SDL_KEYDOWN, SDL_TEXTINPUT);
+        while (remaining >= 0 && pending_count > (Uint32)remaining)
+        {
+            pending_t* entry = &pending[pending_head];
+
+            if (SDL_TRUE == entry->is_measured)
+            {
+                add_sample(to_microseconds(frame_end - entry->timestamp), &latency[entry->phase]);
+            }
+
+            pending_head   = (pending_head + 1) % BENCH_MAX_PENDING;
+            pending_count -= 1;
+        }
+    }
+
+    printf("%u events at %u/s\n", injected, rate);
+    printf("%-8s %7s %8s %8s %8s %8s %8s %8s %8s\n", "screen", "events", "p50 ms", "p99 ms", "max ms", "frames", "p50 ms", "p99 ms", "max ms");
+    report("menu",    &latency[PHASE_MENU],    &frame_time[PHASE_MENU]);
+    report("typing",  &latency[PHASE_TYPING],  &frame_time[PHASE_TYPING]);
+    report("results", &latency[PHASE_RESULTS], &frame_time[PHASE_RESULTS]);
+
+    for (index = 0; index < PHASE_COUNT; index += 1)
+    {
+        SDL_free(latency[index].value);
+        SDL_free(frame_time[index].value);
+    }
+
+    core->state.hooks = hooks;
+
+    return status;
+}
+
+// Returns the input for one pass through the current screen.
+static Uint32 build_chunk(step_t chunk[BENCH_MAX_CHUNK], phase_t* phase, game_t* core)
+{
+    Uint32 length = 0;
+    int    index;
+
+    SDL_memset(chunk, 0, sizeof(step_t) * BENCH_MAX_CHUNK);
+
+    *phase = current_phase(core);
+    switch (*phase)
+    {
+        default:
+        case PHASE_MENU:
+            // Cycle through the menu twice, then start an endless game.
+            for (index = 0; index < 10; index += 1)
+            {
+                chunk[length++].key = SDLK_RIGHT;
+            }
+            chunk[length++].key = SDLK_UP;
+            chunk[length++].key = SDLK_RETURN;
+            break;
+        case PHASE_TYPING:
+        {
+            unsigned char answer[6] = { 0 };
+            int           pass;
+
+            // Type and delete the answer a few times, then solve.
+            get_valid_answer(answer, &core->state);
+            for (pass = 0; pass < 4; pass += 1)
+            {
+                for (index = 0; index < 5; index += 1)
+                {
+                    chunk[length++].text[0] = (char)answer[index];
+                }
+
+                if (pass < 3)
+                {
+                    for (index = 0; index < 4; index += 1)
+                    {
+                        chunk[length++].key = SDLK_BACKSPACE;
+                    }
+                }
+            }
+            chunk[length++].key = SDLK_RETURN;
+            break;
+        }
+        case PHASE_RESULTS:
+            for (index = 0; index < 5; index += 1)
+            {
+                chunk[length++].key = SDLK_RIGHT;
+            }
+            chunk[length++].key = SDLK_RETURN;
+            break;
+    }
+
+    return length;
+}
+
+static phase_t current_phase(game_t* core)
+{
+    if (SDL_TRUE == core->state.show_menu)
+    {
+        return PHASE_MENU;
+    }
+
+    if (core->state.attempt >= 6)
+    {
+        return PHASE_RESULTS;
+    }
+
+    return PHASE_TYPING;
+}
+
+static void add_sample(Uint32 value, samples_t* samples)
+{
+    if (samples->count == samples->capacity)
+    {
+        Uint32  capacity = (0 == samples->capacity) ? 1024 : samples->capacity * 2;
+        Uint32* grown    = (Uint32*)SDL_realloc(samples->value, capacity * sizeof(Uint32));
+
+        if (NULL == grown)
+        {
+            return;
+        }
+
+        samples->value    = grown;
+        samples->capacity = capacity;
+    }
+
+    samples->value[samples->count] = value;
+    samples->count                += 1;
+}
+
+static void report(const char* name, samples_t* latency, samples_t* frame_time)
+{
+    samples_t* set[2];
+    double     result[2][3] = { { 0 } };
+    int        index;
+
+    set[0] = latency;
+    set[1] = frame_time;
+
+    for (index = 0; index < 2; index += 1)
+    {
+        Uint32 count = set[index]->count;
+
+        if (0 == count)
+        {
+            continue;
+        }
+
+        SDL_qsort(set[index]->value, count, sizeof(Uint32), compare_samples);
+        result[index][0] = set[index]->value[(count - 1) * 50 / 100] / 1000.0;
+        result[index][1] = set[index]->value[(count - 1) * 99 / 100] / 1000.0;
+        result[index][2] = set[index]->value[count - 1] / 1000.0;
+    }
+
+    printf("%-8s %7u %8.3f %8.3f %8.3f %8u %8.3f %8.3f %8.3f\n",
+           name,
+           latency->count, result[0][0], result[0][1], result[0][2],
+           frame_time->count, result[1][0], result[1][1], result[1][2]);
+}
+
+static int compare_samples(const void* a, const void* b)
+{
+    Uint32 value_a = *(const Uint32*)a;
+    Uint32 value_b = *(const Uint32*)b;
+
+    return (value_a > value_b) - (value_a < value_b);
+}
+
+static Uint32 to_microseconds(Uint64 ticks)
+{
+    return (Uint32)((ticks * 1000000) / SDL_GetPerformanceFrequency());
+}
@@ -0,0 +1,494 @@
+/** @file build_tree.c
+ *
+ *  Builds the decision tree for the daily word (see decision_tree.c)
+ *  and stores it as tree.bin in a copy of a packed data file:
+ *
+ *    wordle_tree <in.pfs> <out.pfs>
+ *
+ *  At every node, the guess is picked from all allowed words so that
+ *  the remaining answers are split as evenly as possible, preferring
+ *  possible answers when there is a tie.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include <stdio.h>
+#include "SDL.h"
+#include "game_core.h"
+
+#define TREE_FILE_NAME    "tree.bin"
+#define TREE_MAX_NODES    65535
+#define TREE_MAX_ENTRIES  64
+#define TREE_PATTERNS     243
+#define TREE_SOLVED       242
+
+typedef struct pending_node
+{
+    Uint16* answer;
+    Uint16  answer_count;
+    Uint8   depth;
+
+} pending_node_t;
+
+typedef struct tree
+{
+    wordlist_t      wordlist;
+    Uint32          guess_count;
+    Uint8*          pattern;     // [guess][answer]
+    Uint8*          node;
+    Uint32          node_count;
+    pending_node_t* pending;     // Same order as the nodes
+    Uint32          distribution[7];
+    double          entropy_term[TREE_MAX_NODES + 1];
+
+} tree_t;
+
+typedef struct pfs_entry
+{
+    char   name[256];
+    Uint8* data;
+    Uint32 size;
+
+} pfs_entry_t;
+
+static int      build(tree_t* tree);
+static Uint16   choose_guess(const Uint16* answer, Uint16 answer_count, tree_t* tree);
+static int      read_pfs(const char* file_name, pfs_entry_t* entry, Uint32* entry_count);
+static int      write_pfs(const char* file_name, const pfs_entry_t* entry, Uint32 entry_count);
+static void     write_le16(Uint8* data, Uint16 value);
+static void     write_le32(Uint8* data, Uint32 value);
+
+int main(int argc, char *argv[])
+{
+    tree_t*      tree;
+    pfs_entry_t* entry;
+    Uint32       entry_count = 0;
+    Uint32       index;
+    Uint32       games       = 0;
+    double       guesses     = 0.0;
+    int          status      = 1;
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "Usage: %s <in.pfs> <out.pfs>\n", argv[0]);
+        return 1;
+    }
+
+    tree  = (tree_t*)SDL_calloc(1, sizeof(tree_t));
+    entry = (pfs_entry_t*)SDL_calloc(TREE_MAX_ENTRIES, sizeof(pfs_entry_t));
+    if (NULL == tree || NULL == entry)
+    {
+        goto quit;
+    }
+
+    if (0 != read_pfs(argv[1], entry, &entry_count))
+    {
+        fprintf(stderr, "Could not read %s\n", argv[1]);
+        goto quit;
+    }
+
+    load_wordlist(LANG_ENGLISH, &tree->wordlist);
+    if (0 != build(tree))
+    {
+        fprintf(stderr, "Could not build the decision tree\n");
+        goto quit;
+    }
+
+    for (index = 0; index < 7; index += 1)
+    {
+        games += tree->distribution[index];
+    }
+
+    printf("%u nodes, %u bytes\n", tree->node_count, DECISION_TREE_HEADER_SIZE + (tree->node_count * DECISION_TREE_NODE_SIZE));
+    for (index = 0; index < 6; index += 1)
+    {
+        printf("%u: %5u\n", index + 1, tree->distribution[index]);
+        guesses += (double)(index + 1) * tree->distribution[index];
+    }
+    printf("X: %5u\n", tree->distribution[6]);
+    printf("%.4f guesses per solved game\n", (games > tree->distribution[6]) ? guesses / (games - tree->distribution[6]) : 0.0);
+
+    if (0 != tree->distribution[6])
+    {
+        fprintf(stderr, "Not every answer is solved within six guesses\n");
+        goto quit;
+    }
+
+    // Replace an older tree.
+    for (index = 0; index < entry_count; index += 1)
+    {
+        if (0 == SDL_strcmp(entry[index].name, TREE_FILE_NAME))
+        {
+            break;
+        }
+    }
+
+    if (index == entry_count)
+    {
+        if (TREE_MAX_ENTRIES == entry_count)
+        {
+            goto quit;
+        }
+        entry_count += 1;
+    }
+
+    SDL_free(entry[index].data);
+    SDL_strlcpy(entry[index].name, TREE_FILE_NAME, sizeof(entry[index].name));
+    entry[index].size = DECISION_TREE_HEADER_SIZE + (tree->node_count * DECISION_TREE_NODE_SIZE);
+    entry[index].data = (Uint8*)SDL_malloc(entry[index].size);
+    if (NULL == entry[index].data)
+    {
+        goto quit;
+    }
+
+    SDL_memcpy(entry[index].data, "WTRE", 4);
+    entry[index].data[4] = DECISION_TREE_VERSION;
+    entry[index].data[5] = 0;
+    write_le16(&entry[index].data[6],  (Uint16)tree->wordlist.word_count);
+    write_le16(&entry[index].data[8],  (Uint16)tree->wordlist.allowed_count);
+    write_le16(&entry[index].data[10], (Uint16)tree->node_count);
+    write_le32(&entry[index].data[12], get_wordlist_checksum(&tree->wordlist));
+    SDL_memcpy(&entry[index].data[DECISION_TREE_HEADER_SIZE], tree->node, tree->node_count * DECISION_TREE_NODE_SIZE);
+
+    if (0 != write_pfs(argv[2], entry, entry_count))
+    {
+        fprintf(stderr, "Could not write %s\n", argv[2]);
+        goto quit;
+    }
+
+    status = 0;
+
+quit:
+    if (NULL != entry)
+    {
+        for (index = 0; index < TREE_MAX_ENTRIES; index += 1)
+        {
+            SDL_free(entry[index].data);
+        }
+    }
+
+    if (NULL != tree)
+    {
+        SDL_free(tree->pattern);
+        SDL_free(tree->node);
+        SDL_free(tree->pending);
+    }
+
+    SDL_free(entry);
+    SDL_free(tree);
+
+    return status;
+}
+
+// Builds the tree breadth-first, so the children of each node end up
+// next to each other.
+static int build(tree_t* tree)
+{
+    wordlist_t* wordlist = &tree->wordlist;
+    Uint32      guess_index;
+    Uint32      index;
+
+    tree->guess_count = wordlist->word_count + wordlist->allowed_count;
+    tree->pattern     = (Uint8*)SDL_malloc(tree->guess_count * wordlist->word_count);
+    tree->node        = (Uint8*)SDL_malloc(TREE_MAX_NODES * DECISION_TREE_NODE_SIZE);
+    tree->pending     = (pending_node_t*)SDL_calloc(TREE_MAX_NODES, sizeof(pending_node_t));
+
+    if (NULL == tree->pattern || NULL == tree->node || NULL == tree->pending)
+    {
+        return 1;
+    }
+
+    // n * log2(n), the part of the expected information a partition of
+    // n answers does not provide.
+    for (index = 1; index <= TREE_MAX_NODES; index += 1)
+    {
+        tree->entropy_term[index] = (double)index * SDL_log((double)index) / SDL_log(2.0);
+    }
+
+    for (guess_index = 0; guess_index < tree->guess_count; guess_index += 1)
+    {
+        const unsigned char* guess = get_guess_word(wordlist, guess_index);
+        Uint8*               row   = &tree->pattern[guess_index * wordlist->word_count];
+        state_t              result[5];
+
+        for (index = 0; index < wordlist->word_count; index += 1)
+        {
+            score_guess(guess, wordlist->list[index], result);
+            row[index] = get_pattern_code(result);
+        }
+    }
+
+    tree->pending[0].answer = (Uint16*)SDL_malloc(wordlist->word_count * sizeof(Uint16));
+    if (NULL == tree->pending[0].answer)
+    {
+        return 1;
+    }
+
+    for (index = 0; index < wordlist->word_count; index += 1)
+    {
+        tree->pending[0].answer[index] = (Uint16)index;
+    }
+    tree->pending[0].answer_count = (Uint16)wordlist->word_count;
+    tree->node_count              = 1;
+    SDL_memset(tree->node, 0, DECISION_TREE_NODE_SIZE);
+
+    for (index = 0; index < tree->node_count; index += 1)
+    {
+        pending_node_t* pending = &tree->pending[index];
+        Uint8*          node    = &tree->node[index * DECISION_TREE_NODE_SIZE];
+        const Uint8*    row;
+        Uint16          partition_count[TREE_PATTERNS] = { 0 };
+        Uint16          guess;
+        Uint32          answer_index;
+        Uint32          pattern;
+        Uint8           child_count = 0;
+
+        guess = choose_guess(pending->answer, pending->answer_count, tree);
+        row   = &tree->pattern[guess * wordlist->word_count];
+
+        for (answer_index = 0; answer_index < pending->answer_count; answer_index += 1)
+        {
+            partition_count[row[pending->answer[answer_index]]] += 1;
+        }
+
+        if (0 != partition_count[TREE_SOLVED])
+        {
+            tree->distribution[(pending->depth < 6) ? pending->depth : 6] += 1;
+        }
+
+        write_le16(&node[0], guess);
+        write_le16(&node[4], (Uint16)tree->node_count);
+
+        for (pattern = 0; pattern < TREE_SOLVED; pattern += 1)
+        {
+            pending_node_t* child;
+            Uint8*          child_node;
+
+            if (0 == partition_count[pattern])
+            {
+                continue;
+            }
+
+            if (tree->node_count >= TREE_MAX_NODES)
+            {
+                return 1;
+            }
+
+            child               = &tree->pending[tree->node_count];
+            child_node          = &tree->node[tree->node_count * DECISION_TREE_NODE_SIZE];
+            child->answer       = (Uint16*)SDL_malloc(partition_count[pattern] * sizeof(Uint16));
+            child->answer_count = 0;
+            child->depth        = pending->depth + 1;
+
+            if (NULL == child->answer)
+            {
+                return 1;
+            }
+
+            for (answer_index = 0; answer_index < pending->answer_count; answer_index += 1)
+            {
+                if (pattern == row[pending->answer[answer_index]])
+                {
+                    child->answer[child->answer_count++] = pending->answer[answer_index];
+                }
+            }
+
+            SDL_memset(child_node, 0, DECISION_TREE_NODE_SIZE);
+            child_node[2]     = (Uint8)pattern;
+            child_count      += 1;
+            tree->node_count += 1;
+        }
+
+        node[3] = child_count;
+
+        SDL_free(pending->answer);
+        pending->answer = NULL;
+    }
+
+    return 0;
+}
+
+static Uint16 choose_guess(const Uint16* answer, Uint16 answer_count, tree_t* tree)
+{
+    Uint32 guess_index;
+    Uint32 best_guess = answer[0];
+    double best_score = 0.0;
+    Uint16 partition_count[TREE_PATTERNS];
+
+    if (answer_count <= 2)
+    {
+        return answer[0];
+    }
+
+    for (guess_index = 0; guess_index < tree->guess_count; guess_index += 1)
+    {
+        const Uint8* row   = &tree->pattern[guess_index * tree->wordlist.word_count];
+        double       score = 0.0;
+        Uint32       index;
+
+        SDL_memset(partition_count, 0, sizeof(partition_count));
+        for (index = 0; index < answer_count; index += 1)
+        {
+            partition_count[row[answer[index]]] += 1;
+        }
+
+        for (index = 0; index < TREE_PATTERNS; index += 1)
+        {
+            score += tree->entropy_term[partition_count[index]];
+        }
+
+        // A possible answer might be solved right away.
+        if (0 != partition_count[TREE_SOLVED])
+        {
+            score -= 1e-6;
+        }
+
+        if (0 == guess_index || score < best_score)
+        {
+            best_guess = guess_index;
+            best_score = score;
+        }
+    }
+
+    return (Uint16)best_guess;
+}
+
+// See pfs.c for the layout.
+static int read_pfs(const char* file_name, pfs_entry_t* entry, Uint32* entry_count)
+{
+    FILE*  file = fopen(file_name, "rb");
+    Uint8  buffer[4];
+    Uint32 offset[TREE_MAX_ENTRIES];
+    Uint32 index;
+
+    if (NULL == file)
+    {
+        return 1;
+    }
+
+    if (1 != fread(buffer, 2, 1, file))
+    {
+        fclose(file);
+        return 1;
+    }
+
+    *entry_count = (Uint32)(buffer[0] | (buffer[1] << 8));
+    if (*entry_count > TREE_MAX_ENTRIES)
+    {
+        fclose(file);
+        return 1;
+    }
+
+    for (index = 0; index < *entry_count; index += 1)
+    {
+        int name_length;
+
+        if ((1 != fread(buffer, 4, 1, file)) || (EOF == (name_length = fgetc(file))))
+        {
+            fclose(file);
+            return 1;
+        }
+
+        offset[index] = (Uint32)buffer[0] | ((Uint32)buffer[1] << 8) | ((Uint32)buffer[2] << 16) | ((Uint32)buffer[3] << 24);
+
+        if (1 != fread(entry[index].name, (size_t)name_length + 1, 1, file))
+        {
+            fclose(file);
+            return 1;
+        }
+    }
+
+    for (index = 0; index < *entry_count; index += 1)
+    {
+        if ((0 != fseek(file, (long)offset[index], SEEK_SET)) || (1 != fread(buffer, 4, 1, file)))
+        {
+            fclose(file);
+            return 1;
+        }
+
+        entry[index].size = (Uint32)buffer[0] | ((Uint32)buffer[1] << 8) | ((Uint32)buffer[2] << 16) | ((Uint32)buffer[3] << 24);
+        entry[index].data = (Uint8*)SDL_malloc(entry[index].size);
+
+        if ((NULL == entry[index].data) || (1 != fread(entry[index].data, entry[index].size, 1, file)))
+        {
+            fclose(file);
+            return 1;
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
+
+static int write_pfs(const char* file_name, const pfs_entry_t* entry, Uint32 entry_count)
+{
+    FILE*  file = fopen(file_name, "wb");
+    Uint8  buffer[4];
+    Uint32 offset = 2;
+    Uint32 index;
+    int    status = 0;
+
+    if (NULL == file)
+    {
+        return 1;
+    }
+
+    for (index = 0; index < entry_count; index += 1)
+    {
+        offset += 4 + 1 + (Uint32)SDL_strlen(entry[index].name) + 1;
+    }
+
+    write_le16(buffer, (Uint16)entry_count);
+    if (1 != fwrite(buffer, 2, 1, file))
+    {
+        status = 1;
+    }
+
+    for (index = 0; index < entry_count; index += 1)
+    {
+        size_t name_length = SDL_strlen(entry[index].name);
+
+        write_le32(buffer, offset);
+        if ((1 != fwrite(buffer, 4, 1, file)) ||
+            (EOF == fputc((int)name_length, file)) ||
+            (1 != fwrite(entry[index].name, name_length + 1, 1, file)))
+        {
+            status = 1;
+        }
+
+        offset += 4 + entry[index].size;
+    }
+
+    for (index = 0; index < entry_count; index += 1)
+    {
+        write_le32(buffer, entry[index].size);
+        if ((1 != fwrite(buffer, 4, 1, file)) ||
+            (1 != fwrite(entry[index].data, entry[index].size, 1, file)))
+        {
+            status = 1;
+        }
+    }
+
+    if (0 != fclose(file))
+    {
+        status = 1;
+    }
+
+    return status;
+}
+
+static void write_le16(Uint8* data, Uint16 value)
+{
+    data[0] = (Uint8)value;
+    data[1] = (Uint8)(value >> 8);
+}
+
+static void write_le32(Uint8* data, Uint32 value)
+{
+    data[0] = (Uint8)value;
+    data[1] = (Uint8)(value >> 8);
+    data[2] = (Uint8)(value >> 16);
+    data[3] = (Uint8)(value >> 24);
+}
@@ -0,0 +1,143 @@
+/** @file decision_tree.c
+ *
+ *  Precomputed solver for the English word list, used to show how a
+ *  bot would have played the daily word.  The tree is built offline by
+ *  wordle_tree (see build_tree.c) and shipped in data.pfs as tree.bin.
+ *
+ *  Format, all values little-endian:
+ *
+ *    "WTRE" version:u8 reserved:u8 word_count:u16 allowed_count:u16
+ *    node_count:u16 checksum:u32
+ *    node[node_count]
+ *
+ *  Each node holds the word to guess (an index into the answers,
+ *  followed by the allowed guesses), the pattern that leads to it from
+ *  its parent, and its children, which are stored next to each other:
+ *
+ *    guess:u16 pattern:u8 child_count:u8 first_child:u16
+ *
+ *  The root is the first node.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL_stdinc.h"
+#include "game_core.h"
+
+static Uint16 read_le16(const Uint8* data);
+static Uint32 read_le32(const Uint8* data);
+
+// Returns the number of nodes following the header, or 0 if the tree
+// was not built for this word list.
+Uint32 decision_tree_check(const Uint8 header[DECISION_TREE_HEADER_SIZE], const wordlist_t* wordlist)
+{
+    if (NULL == header || NULL == wordlist)
+    {
+        return 0;
+    }
+
+    if ((0 != SDL_memcmp(header, "WTRE", 4)) ||
+        (DECISION_TREE_VERSION != header[4]) ||
+        (wordlist->word_count != read_le16(&header[6])) ||
+        (wordlist->allowed_count != read_le16(&header[8])) ||
+        (get_wordlist_checksum(wordlist) != read_le32(&header[12])))
+    {
+        return 0;
+    }
+
+    return read_le16(&header[10]);
+}
+
+// Follows the tree for the given answer.  Returns the number of
+// guesses the bot needs and fills in its guesses, or 0 if the answer
+// is not covered.
+Uint8 decision_tree_walk(const Uint8* node, Uint32 node_count, const unsigned char* answer, const wordlist_t* wordlist, unsigned char guess[6][6])
+{
+    Uint32 index = 0;
+    Uint8  attempt;
+
+    if (NULL == node || 0 == node_count || NULL == wordlist)
+    {
+        return 0;
+    }
+
+    for (attempt = 0; attempt < 6; attempt += 1)
+    {
+        const Uint8*         current     = &node[index * DECISION_TREE_NODE_SIZE];
+        Uint16               word_index  = read_le16(current);
+        Uint8                child_count = current[3];
+        Uint32               first_child = read_le16(&current[4]);
+        const unsigned char* word;
+        state_t              result[5];
+        Uint8                pattern;
+        Uint32               child;
+
+        word = get_guess_word(wordlist, word_index);
+        if (NULL == word)
+        {
+            return 0;
+        }
+
+        SDL_memcpy(guess[attempt], word, 5);
+        guess[attempt][5] = '\0';
+
+        if (SDL_TRUE == score_guess(word, answer, result))
+        {
+            return attempt + 1;
+        }
+
+        pattern = get_pattern_code(result);
+        for (child = first_child; child < first_child + child_count && child < node_count; child += 1)
+        {
+            if (pattern == node[(child * DECISION_TREE_NODE_SIZE) + 2])
+            {
+                break;
+            }
+        }
+
+        if (child >= first_child + child_count || child >= node_count)
+        {
+            return 0;
+        }
+
+        index = child;
+    }
+
+    return 0;
+}
+
+// Base-3 code of a row: 2 for a correct letter, 1 for one in the wrong
+// position, 0 otherwise.  All correct is 242.
+Uint8 get_pattern_code(const state_t result[5])
+{
+    Uint8 code = 0;
+    int   index;
+
+    for (index = 4; index >= 0; index -= 1)
+    {
+        code *= 3;
+
+        if (CORRECT_LETTER == result[index])
+        {
+            code += 2;
+        }
+        else if (WRONG_POSITION == result[index])
+        {
+            code += 1;
+        }
+    }
+
+    return code;
+}
+
+static Uint16 read_le16(const Uint8* data)
+{
+    return (Uint16)(data[0] | (data[1] << 8));
+}
+
+static Uint32 read_le32(const Uint8* data)
+{
+    return (Uint32)data[0] | ((Uint32)data[1] << 8) | ((Uint32)data[2] << 16) | ((Uint32)data[3] << 24);
+}
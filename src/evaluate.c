@@ -0,0 +1,671 @@
+/** @file evaluate.c
+ *
+ *  Batch guess evaluation: reads lines of "<answer> <guess>" from a
+ *  file or stdin and writes one line per input line, in the same
+ *  order:
+ *
+ *    ok <pattern>           the guess is in the word lists
+ *    not-allowed <pattern>  it is not
+ *    err                    the line is not two five-letter words
+ *
+ *  Patterns use the same notation as the game server.  Regular files
+ *  are mapped into memory, anything else is read in large chunks.  The
+ *  input is cut into batches at line boundaries, which are evaluated
+ *  by a pool of worker threads and written back in order.
+ *
+ *    wordle_eval [--lang en|ru|de|fi] [--threads <n>] [file]
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "SDL.h"
+#include "game_core.h"
+#include "session.h"
+
+#ifndef EVAL_BATCH_SIZE
+#define EVAL_BATCH_SIZE (1 << 20)
+#endif
+
+#ifndef EVAL_MAX_THREADS
+#define EVAL_MAX_THREADS 64
+#endif
+
+#define EVAL_MAX_RESPONSE 32
+
+typedef enum
+{
+    BATCH_FREE = 0,
+    BATCH_READY,
+    BATCH_DONE
+
+} batch_state_t;
+
+typedef struct batch
+{
+    const char*   in;
+    size_t        in_length;
+    char*         in_buffer;
+    char*         out;
+    size_t        out_length;
+    size_t        out_capacity;
+    Uint32        line_count;
+    Uint32        not_allowed_count;
+    Uint32        error_count;
+    int           status;      // Non-zero if the output could not be allocated
+    batch_state_t state;
+
+} batch_t;
+
+typedef struct evaluator
+{
+    lexicon_t   lexicon;
+    batch_t     batch[EVAL_MAX_THREADS * 2];
+    Uint32      batch_count;
+    Uint32      next_batch;  // Next batch to be evaluated
+    Uint32      ready_count; // Batches handed to the workers so far
+    SDL_bool    is_done;
+    SDL_mutex*  lock;
+    SDL_cond*   batch_ready;
+    SDL_cond*   batch_done;
+
+    // Input
+    int         fd;
+    const char* map;
+    size_t      map_size;
+    size_t      map_offset;
+    char*       carry;
+    size_t      carry_length;
+    SDL_bool    skip_line;
+    SDL_bool    is_eof;
+    SDL_bool    is_failed;   // Out of memory, the rest is not read
+
+} evaluator_t;
+
+static int      evaluate_batch(batch_t* batch, const lexicon_t* lexicon);
+static size_t   evaluate_line(const char* line, const char* end, const lexicon_t* lexicon, char* out, batch_t* batch);
+static SDL_bool fill_batch(batch_t* batch, evaluator_t* evaluator);
+static SDL_bool parse_word(const char** line, const char* end, unsigned char word[6]);
+static int      run_worker(void* data);
+static int      write_all(const char* buffer, size_t length);
+
+int main(int argc, char *argv[])
+{
+    evaluator_t* evaluator;
+    SDL_Thread*  thread[EVAL_MAX_THREADS];
+    lang_t       language     = LANG_ENGLISH;
+    const char*  file_name    = NULL;
+    Uint32       thread_count = (Uint32)SDL_GetCPUCount();
+    Uint32       worker_count = 0;
+    Uint32       line_count   = 0;
+    Uint32       not_allowed  = 0;
+    Uint32       errors       = 0;
+    Uint32       filled       = 0;
+    Uint32       written      = 0;
+    Uint32       index;
+    Uint64       start;
+    double       seconds;
+    int          status       = 0;
+    int          arg;
+
+    for (arg = 1; arg < argc; arg += 1)
+    {
+        if ((0 == SDL_strcmp(argv[arg], "--lang")) && ((arg + 1) < argc))
+        {
+            arg += 1;
+            if (0 == SDL_strcmp(argv[arg], "ru"))
+            {
+                language = LANG_RUSSIAN;
+            }
+            else if (0 == SDL_strcmp(argv[arg], "de"))
+            {
+                language = LANG_GERMAN;
+            }
+            else if (0 == SDL_strcmp(argv[arg], "fi"))
+            {
+                language = LANG_FINNISH;
+            }
+        }
+        else if ((0 == SDL_strcmp(argv[arg], "--threads")) && ((arg + 1) < argc))
+        {
+            arg          += 1;
+            thread_count  = (Uint32)SDL_strtoul(argv[arg], NULL, 0);
+        }
+        else
+        {
+            file_name = argv[arg];
+        }
+    }
+
+    thread_count = SDL_clamp(thread_count, 1, EVAL_MAX_THREADS);
+
+    evaluator = (evaluator_t*)SDL_calloc(1, sizeof(evaluator_t));
+    if (NULL == evaluator)
+    {
+        return 1;
+    }
+
+    if (0 != lexicon_init(language, &evaluator->lexicon))
+    {
+        SDL_free(evaluator);
+        return 1;
+    }
+
+    evaluator->fd = STDIN_FILENO;
+    if (NULL != file_name && 0 != SDL_strcmp(file_name, "-"))
+    {
+        struct stat info;
+
+        evaluator->fd = open(file_name, O_RDONLY);
+        if (evaluator->fd < 0)
+        {
+            fprintf(stderr, "Could not open %s: %s\n", file_name, strerror(errno));
+            status = 1;
+            goto quit;
+        }
+
+        // Regular files are evaluated straight from the page cache.
+        if (0 == fstat(evaluator->fd, &info) && S_ISREG(info.st_mode) && info.st_size > 0)
+        {
+            void* map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, evaluator->fd, 0);
+
+            if (MAP_FAILED != map)
+            {
+                madvise(map, (size_t)info.st_size, MADV_SEQUENTIAL);
+                evaluator->map      = (const char*)map;
+                evaluator->map_size = (size_t)info.st_size;
+            }
+        }
+    }
+
+    if (NULL == evaluator->map)
+    {
+        evaluator->carry = (char*)SDL_malloc(EVAL_BATCH_SIZE);
+        if (NULL == evaluator->carry)
+        {
+            status = 1;
+            goto quit;
+        }
+    }
+
+    evaluator->batch_count = thread_count * 2;
+    evaluator->lock        = SDL_CreateMutex();
+    evaluator->batch_ready = SDL_CreateCond();
+    evaluator->batch_done  = SDL_CreateCond();
+
+    if (NULL == evaluator->lock || NULL == evaluator->batch_ready || NULL == evaluator->batch_done)
+    {
+        status = 1;
+        goto quit;
+    }
+
+    for (index = 0; index < thread_count; index += 1)
+    {
+        thread[worker_count] = SDL_CreateThread(run_worker, "evaluate", evaluator);
+        if (NULL != thread[worker_count])
+        {
+            worker_count += 1;
+        }
+    }
+
+    // Without any worker, the batches are evaluated on this thread.
+    if (0 == worker_count)
+    {
+        fprintf(stderr, "Could not create a worker thread: %s\n", SDL_GetError());
+    }
+
+    start = SDL_GetPerformanceCounter();
+
+    for (;;)
+    {
+        batch_t* batch;
+
+        // Keep every batch busy while the oldest one is outstanding.
+        while (SDL_FALSE == evaluator->is_eof && (filled - written) < evaluator->batch_count)
+        {
+            batch = &evaluator->batch[filled % evaluator->batch_count];
+
+            if (SDL_FALSE == fill_batch(batch, evaluator))
+            {
+                break;
+            }
+
+            if (0 == worker_count)
+            {
+                batch->status = evaluate_batch(batch, &evaluator->lexicon);
+                batch->state  = BATCH_DONE;
+            }
+            else
+            {
+                SDL_LockMutex(evaluator->lock);
+                batch->state            = BATCH_READY;
+                evaluator->ready_count  = filled + 1;
+                SDL_CondSignal(evaluator->batch_ready);
+                SDL_UnlockMutex(evaluator->lock);
+            }
+
+            filled += 1;
+        }
+
+        if (written == filled)
+        {
+            if (SDL_TRUE == evaluator->is_failed)
+            {
+                fprintf(stderr, "Out of memory after %u lines\n", line_count);
+                status = 1;
+            }
+            break;
+        }
+
+        batch = &evaluator->batch[written % evaluator->batch_count];
+
+        SDL_LockMutex(evaluator->lock);
+        while (BATCH_DONE != batch->state)
+        {
+            SDL_CondWait(evaluator->batch_done, evaluator->lock);
+        }
+        SDL_UnlockMutex(evaluator->lock);
+
+        // Stop rather than write a batch short.
+        if (0 != batch->status)
+        {
+            fprintf(stderr, "Out of memory after %u lines\n", line_count);
+            status = 1;
+            break;
+        }
+
+        if (0 != write_all(batch->out, batch->out_length))
+        {
+            status = 1;
+            break;
+        }
+
+        line_count  += batch->line_count;
+        not_allowed += batch->not_allowed_count;
+        errors      += batch->error_count;
+
+        batch->state  = BATCH_FREE;
+        written      += 1;
+    }
+
+    SDL_LockMutex(evaluator->lock);
+    evaluator->is_done = SDL_TRUE;
+    SDL_CondBroadcast(evaluator->batch_ready);
+    SDL_UnlockMutex(evaluator->lock);
+
+    for (index = 0; index < worker_count; index += 1)
+    {
+        SDL_WaitThread(thread[index], NULL);
+    }
+
+    seconds = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+
+    fprintf(stderr, "%u lines, %u not allowed, %u errors in %.3f s (%.0f lines/s, %u threads)\n",
+            line_count,
+            not_allowed,
+            errors,
+            seconds,
+            (seconds > 0.0) ? line_count / seconds : 0.0,
+            worker_count);
+
+quit:
+    for (index = 0; index < EVAL_MAX_THREADS * 2; index += 1)
+    {
+        SDL_free(evaluator->batch[index].in_buffer);
+        SDL_free(evaluator->batch[index].out);
+    }
+
+    if (NULL != evaluator->map)
+    {
+        munmap((void*)evaluator->map, evaluator->map_size);
+    }
+
+    if (evaluator->fd > STDIN_FILENO)
+    {
+        close(evaluator->fd);
+    }
+
+    if (NULL != evaluator->batch_done)
+    {
+        SDL_DestroyCond(evaluator->batch_done);
+    }
+    if (NULL != evaluator->batch_ready)
+    {
+        SDL_DestroyCond(evaluator->batch_ready);
+    }
+    if (NULL != evaluator->lock)
+    {
+        SDL_DestroyMutex(evaluator->lock);
+    }
+
+    SDL_free(evaluator->carry);
+    lexicon_free(&evaluator->lexicon);
+    SDL_free(evaluator);
+
+    return status;
+}
+
+static int run_worker(void* data)
+{
+    evaluator_t* evaluator = (evaluator_t*)data;
+
+    for (;;)
+    {
+        batch_t* batch;
+
+        SDL_LockMutex(evaluator->lock);
+        while (evaluator->next_batch == evaluator->ready_count && SDL_FALSE == evaluator->is_done)
+        {
+            SDL_CondWait(evaluator->batch_ready, evaluator->lock);
+        }
+
+        if (evaluator->next_batch == evaluator->ready_count)
+        {
+            SDL_UnlockMutex(evaluator->lock);
+            break;
+        }
+
+        batch                  = &evaluator->batch[evaluator->next_batch % evaluator->batch_count];
+        evaluator->next_batch += 1;
+        SDL_UnlockMutex(evaluator->lock);
+
+        batch->status = evaluate_batch(batch, &evaluator->lexicon);
+
+        SDL_LockMutex(evaluator->lock);
+        batch->state  = BATCH_DONE;
+        SDL_CondBroadcast(evaluator->batch_done);
+        SDL_UnlockMutex(evaluator->lock);
+    }
+
+    return 0;
+}
+
+// Hands the next run of complete lines to the batch.  Returns SDL_FALSE
+// at the end of the input.
+static SDL_bool fill_batch(batch_t* batch, evaluator_t* evaluator)
+{
+    size_t length;
+    size_t complete;
+
+    if (NULL != evaluator->map)
+    {
+        const char* end;
+        size_t      offset = evaluator->map_offset;
+
+        if (offset >= evaluator->map_size)
+        {
+            evaluator->is_eof = SDL_TRUE;
+            return SDL_FALSE;
+        }
+
+        length = evaluator->map_size - offset;
+        if (length > EVAL_BATCH_SIZE)
+        {
+            // Cut after the last complete line, or after the first one
+            // if it is longer than a batch.
+            end = (const char*)memrchr(evaluator->map + offset, '\n', EVAL_BATCH_SIZE);
+            if (NULL == end)
+            {
+                end = (const char*)memchr(evaluator->map + offset, '\n', length);
+            }
+
+            if (NULL != end)
+            {
+                length = (size_t)(end - (evaluator->map + offset)) + 1;
+            }
+        }
+
+        batch->in              = evaluator->map + offset;
+        batch->in_length       = length;
+        evaluator->map_offset += length;
+
+        return SDL_TRUE;
+    }
+
+    if (NULL == batch->in_buffer)
+    {
+        batch->in_buffer = (char*)SDL_malloc(EVAL_BATCH_SIZE);
+        if (NULL == batch->in_buffer)
+        {
+            evaluator->is_eof    = SDL_TRUE;
+            evaluator->is_failed = SDL_TRUE;
+            return SDL_FALSE;
+        }
+    }
+
+    // Start with the incomplete line left over from the last batch.
+    SDL_memcpy(batch->in_buffer, evaluator->carry, evaluator->carry_length);
+    length                  = evaluator->carry_length;
+    evaluator->carry_length = 0;
+
+    for (;;)
+    {
+        const char* end = NULL;
+        ssize_t     count;
+
+        if (length < EVAL_BATCH_SIZE)
+        {
+            count = read(evaluator->fd, batch->in_buffer + length, EVAL_BATCH_SIZE - length);
+            if (count < 0 && EINTR == errno)
+            {
+                continue;
+            }
+
+            if (count > 0)
+            {
+                // Drop the rest of a line that did not fit a batch.
+                if (SDL_TRUE == evaluator->skip_line)
+                {
+                    end = (const char*)memchr(batch->in_buffer + length, '\n', (size_t)count);
+                    if (NULL == end)
+                    {
+                        continue;
+                    }
+
+                    evaluator->skip_line = SDL_FALSE;
+                    complete             = (size_t)(end - (batch->in_buffer + length)) + 1;
+                    SDL_memmove(batch->in_buffer + length, end + 1, (size_t)count - complete);
+                    count               -= (ssize_t)complete;
+                }
+
+                length += (size_t)count;
+            }
+            else
+            {
+                evaluator->is_eof = SDL_TRUE;
+                break;
+            }
+        }
+
+        // Stop at the first read that completes a line, so that input
+        // arriving slowly through a pipe is not held back.
+        end = (const char*)memrchr(batch->in_buffer, '\n', length);
+        if (NULL != end)
+        {
+            complete                = (size_t)(end - batch->in_buffer) + 1;
+            evaluator->carry_length = length - complete;
+            SDL_memcpy(evaluator->carry, end + 1, evaluator->carry_length);
+            length                  = complete;
+            break;
+        }
+
+        if (length == EVAL_BATCH_SIZE)
+        {
+            // One line fills the whole batch; it is reported as an
+            // error and the remainder skipped.
+            evaluator->skip_line = SDL_TRUE;
+            break;
+        }
+    }
+
+    batch->in        = batch->in_buffer;
+    batch->in_length = length;
+
+    return (length > 0) ? SDL_TRUE : SDL_FALSE;
+}
+
+// Returns non-zero if the output buffer could not grow, in which case
+// the batch is incomplete and must not be written.
+static int evaluate_batch(batch_t* batch, const lexicon_t* lexicon)
+{
+    const char* line = batch->in;
+    const char* end  = batch->in + batch->in_length;
+
+    batch->out_length        = 0;
+    batch->line_count        = 0;
+    batch->not_allowed_count = 0;
+    batch->error_count       = 0;
+
+    while (line < end)
+    {
+        const char* line_end = (const char*)memchr(line, '\n', (size_t)(end - line));
+
+        if (NULL == line_end)
+        {
+            line_end = end;
+        }
+
+        if (batch->out_capacity - batch->out_length < EVAL_MAX_RESPONSE)
+        {
+            size_t capacity = (0 == batch->out_capacity) ? EVAL_BATCH_SIZE : batch->out_capacity * 2;
+            char*  grown    = (char*)SDL_realloc(batch->out, capacity);
+
+            if (NULL == grown)
+            {
+                return 1;
+            }
+
+            batch->out          = grown;
+            batch->out_capacity = capacity;
+        }
+
+        batch->out_length += evaluate_line(line, line_end, lexicon, batch->out + batch->out_length, batch);
+        batch->line_count += 1;
+        line               = line_end + 1;
+    }
+
+    return 0;
+}
+
+static size_t evaluate_line(const char* line, const char* end, const lexicon_t* lexicon, char* out, batch_t* batch)
+{
+    unsigned char answer[6];
+    unsigned char guess[6];
+    state_t       result[5];
+    size_t        length;
+    int           index;
+
+    if ((SDL_FALSE == parse_word(&line, end, answer)) ||
+        (SDL_FALSE == parse_word(&line, end, guess))  ||
+        (SDL_TRUE  == parse_word(&line, end, NULL)))
+    {
+        batch->error_count += 1;
+        SDL_memcpy(out, "err\n", 4);
+        return 4;
+    }
+
+    if (SDL_TRUE == lexicon_contains(guess, lexicon))
+    {
+        SDL_memcpy(out, "ok ", 3);
+        length = 3;
+    }
+    else
+    {
+        batch->not_allowed_count += 1;
+        SDL_memcpy(out, "not-allowed ", 12);
+        length = 12;
+    }
+
+    score_guess(guess, answer, result);
+    for (index = 0; index < 5; index += 1)
+    {
+        switch (result[index])
+        {
+            case CORRECT_LETTER:
+                out[length++] = '+';
+                break;
+            case WRONG_POSITION:
+                out[length++] = '?';
+                break;
+            default:
+                out[length++] = '-';
+                break;
+        }
+    }
+    out[length++] = '\n';
+
+    return length;
+}
+
+// Reads the next five-letter word, upper-casing ASCII letters.  With
+// word set to NULL, only checks whether anything but separators is
+// left.
+static SDL_bool parse_word(const char** line, const char* end, unsigned char word[6])
+{
+    const char* start;
+
+    while (*line < end && (' ' == **line || '\t' == **line || ',' == **line || '\r' == **line))
+    {
+        *line += 1;
+    }
+
+    start = *line;
+    while (*line < end && ' ' != **line && '\t' != **line && ',' != **line && '\r' != **line)
+    {
+        *line += 1;
+    }
+
+    if (NULL == word)
+    {
+        return (*line > start) ? SDL_TRUE : SDL_FALSE;
+    }
+
+    if (5 != (*line - start))
+    {
+        return SDL_FALSE;
+    }
+
+    for (; start < *line; start += 1, word += 1)
+    {
+        *word = (unsigned char)*start;
+        if (*word < 0x80)
+        {
+            *word = (unsigned char)SDL_toupper(*word);
+        }
+    }
+    *word = '\0';
+
+    return SDL_TRUE;
+}
+
+static int write_all(const char* buffer, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t count = write(STDOUT_FILENO, buffer, length);
+
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return 1;
+        }
+
+        buffer += count;
+        length -= (size_t)count;
+    }
+
+    return 0;
+}
@@ -0,0 +1,393 @@
+/** @file framebuffer.c
+ *
+ *  Direct framebuffer backend.  Draws tiles and glyphs straight into
+ *  the window surface and only updates the regions that changed.
+ *  Enabled by defining USE_FRAMEBUFFER at build time.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL.h"
+#include "game.h"
+
+#ifdef USE_FRAMEBUFFER
+
+int  fb_begin(game_t* core);
+void fb_clear(game_t* core);
+void fb_blit(SDL_Surface* image, const SDL_Rect* src, const SDL_Rect* dst, game_t* core);
+void fb_blit_scaled(SDL_Surface* image, const SDL_Rect* src, const SDL_Rect* dst, game_t* core);
+void fb_fill_rect(const SDL_Rect* rect, Uint8 r, Uint8 g, Uint8 b, game_t* core);
+void fb_draw_rect(const SDL_Rect* rect, Uint8 r, Uint8 g, Uint8 b, game_t* core);
+int  fb_present(game_t* core);
+
+static SDL_bool clip_rect(SDL_Rect* src, SDL_Rect* dst, game_t* core);
+static void     mark_dirty(const SDL_Rect* rect, game_t* core);
+static void     fill_row_16(Uint16* row, Uint16 color, int count);
+static void     fill_row_32(Uint32* row, Uint32 color, int count);
+
+int fb_begin(game_t* core)
+{
+    SDL_Surface* screen;
+
+    if (NULL == core)
+    {
+        return 1;
+    }
+
+    // The window surface is recreated whenever the window is resized,
+    // e.g. when toggling fullscreen.  Everything has to be redrawn.
+    screen = SDL_GetWindowSurface(core->window);
+    if (NULL == screen)
+    {
+        return 1;
+    }
+
+    if (screen != core->screen)
+    {
+        core->screen           = screen;
+        core->invalidate_tiles = SDL_TRUE;
+    }
+
+    return 0;
+}
+
+void fb_clear(game_t* core)
+{
+    SDL_Rect screen_rect = { 0, 0, 0, 0 };
+
+    screen_rect.w = core->screen->w;
+    screen_rect.h = core->screen->h;
+
+    fb_fill_rect(&screen_rect, 0xff, 0xff, 0xff, core);
+}
+
+void fb_blit(SDL_Surface* image, const SDL_Rect* src, const SDL_Rect* dst, game_t* core)
+{
+    SDL_Rect     src_rect = *src;
+    SDL_Rect     dst_rect = *dst;
+    const Uint8* src_row;
+    Uint8*       dst_row;
+    int          bpp;
+    int          row_size;
+    int          row;
+
+    if (NULL == image)
+    {
+        return;
+    }
+
+    // Source and destination always share the same dimensions here;
+    // there is no scaling in this backend.
+    src_rect.w = dst_rect.w;
+    src_rect.h = dst_rect.h;
+
+    if (SDL_FALSE == clip_rect(&src_rect, &dst_rect, core))
+    {
+        return;
+    }
+
+    if (src_rect.x + src_rect.w > image->w || src_rect.y + src_rect.h > image->h)
+    {
+        return;
+    }
+
+    if (SDL_MUSTLOCK(core->screen))
+    {
+        if (0 != SDL_LockSurface(core->screen))
+        {
+            return;
+        }
+    }
+
+    bpp      = core->screen->format->BytesPerPixel;
+    row_size = dst_rect.w * bpp;
+    src_row  = (const Uint8*)image->pixels + (src_rect.y * image->pitch) + (src_rect.x * bpp);
+    dst_row  = (Uint8*)core->screen->pixels + (dst_rect.y * core->screen->pitch) + (dst_rect.x * bpp);
+
+    // Images share the screen's pixel format, so every row is a plain
+    // copy.
+    for (row = 0; row < dst_rect.h; row += 1)
+    {
+        SDL_memcpy(dst_row, src_row, row_size);
+        src_row += image->pitch;
+        dst_row += core->screen->pitch;
+    }
+
+    if (SDL_MUSTLOCK(core->screen))
+    {
+        SDL_UnlockSurface(core->screen);
+    }
+
+    mark_dirty(&dst_rect, core);
+}
+
+// Nearest-neighbour scaling for the small tiles of multi-board mode.
+// Regions that are partly off screen are skipped.
+void fb_blit_scaled(SDL_Surface* image, const SDL_Rect* src, const SDL_Rect* dst, game_t* core)
+{
+    const Uint8* src_row;
+    Uint8*       dst_row;
+    int          bpp;
+    int          row;
+    int          column;
+
+    if (NULL == image || dst->w <= 0 || dst->h <= 0)
+    {
+        return;
+    }
+
+    if (dst->x < 0 || dst->y < 0 || dst->x + dst->w > core->screen->w || dst->y + dst->h > core->screen->h)
+    {
+        return;
+    }
+
+    if (src->x < 0 || src->y < 0 || src->x + src->w > image->w || src->y + src->h > image->h)
+    {
+        return;
+    }
+
+    if (SDL_MUSTLOCK(core->screen))
+    {
+        if (0 != SDL_LockSurface(core->screen))
+        {
+            return;
+        }
+    }
+
+    bpp     = core->screen->format->BytesPerPixel;
+    dst_row = (Uint8*)core->screen->pixels + (dst->y * core->screen->pitch) + (dst->x * bpp);
+
+    for (row = 0; row < dst->h; row += 1)
+    {
+        src_row = (const Uint8*)image->pixels + ((src->y + ((row * src->h) / dst->h)) * image->pitch) + (src->x * bpp);
+
+        switch (bpp)
+        {
+            case 2:
+                for (column = 0; column < dst->w; column += 1)
+                {
+                    ((Uint16*)dst_row)[column] = ((const Uint16*)src_row)[(column * src->w) / dst->w];
+                }
+                break;
+            case 4:
+                for (column = 0; column < dst->w; column += 1)
+                {
+                    ((Uint32*)dst_row)[column] = ((const Uint32*)src_row)[(column * src->w) / dst->w];
+                }
+                break;
+            default:
+                for (column = 0; column < dst->w; column += 1)
+                {
+                    SDL_memcpy(dst_row + (column * bpp), src_row + (((column * src->w) / dst->w) * bpp), bpp);
+                }
+                break;
+        }
+
+        dst_row += core->screen->pitch;
+    }
+
+    if (SDL_MUSTLOCK(core->screen))
+    {
+        SDL_UnlockSurface(core->screen);
+    }
+
+    mark_dirty(dst, core);
+}
+
+void fb_fill_rect(const SDL_Rect* rect, Uint8 r, Uint8 g, Uint8 b, game_t* core)
+{
+    SDL_Rect dst_rect = *rect;
+    SDL_Rect src_rect = *rect;
+    Uint32   color;
+    Uint8*   dst_row;
+    int      row;
+
+    if (SDL_FALSE == clip_rect(&src_rect, &dst_rect, core))
+    {
+        return;
+    }
+
+    color = SDL_MapRGB(core->screen->format, r, g, b);
+
+    switch (core->screen->format->BytesPerPixel)
+    {
+        case 2:
+        case 4:
+            break;
+        default:
+            SDL_FillRect(core->screen, &dst_rect, color);
+            mark_dirty(&dst_rect, core);
+            return;
+    }
+
+    if (SDL_MUSTLOCK(core->screen))
+    {
+        if (0 != SDL_LockSurface(core->screen))
+        {
+            return;
+        }
+    }
+
+    dst_row = (Uint8*)core->screen->pixels
+        + (dst_rect.y * core->screen->pitch)
+        + (dst_rect.x * core->screen->format->BytesPerPixel);
+
+    for (row = 0; row < dst_rect.h; row += 1)
+    {
+        if (2 == core->screen->format->BytesPerPixel)
+        {
+            fill_row_16((Uint16*)dst_row, (Uint16)color, dst_rect.w);
+        }
+        else
+        {
+            fill_row_32((Uint32*)dst_row, color, dst_rect.w);
+        }
+        dst_row += core->screen->pitch;
+    }
+
+    if (SDL_MUSTLOCK(core->screen))
+    {
+        SDL_UnlockSurface(core->screen);
+    }
+
+    mark_dirty(&dst_rect, core);
+}
+
+void fb_draw_rect(const SDL_Rect* rect, Uint8 r, Uint8 g, Uint8 b, game_t* core)
+{
+    SDL_Rect edge;
+
+    edge.x = rect->x;
+    edge.y = rect->y;
+    edge.w = rect->w;
+    edge.h = 1;
+    fb_fill_rect(&edge, r, g, b, core);
+
+    edge.y = rect->y + rect->h - 1;
+    fb_fill_rect(&edge, r, g, b, core);
+
+    edge.y = rect->y;
+    edge.w = 1;
+    edge.h = rect->h;
+    fb_fill_rect(&edge, r, g, b, core);
+
+    edge.x = rect->x + rect->w - 1;
+    fb_fill_rect(&edge, r, g, b, core);
+}
+
+int fb_present(game_t* core)
+{
+    int status = 0;
+
+    if (core->dirty_count > 0)
+    {
+        status = SDL_UpdateWindowSurfaceRects(core->window, core->dirty_rect, core->dirty_count);
+        core->dirty_count = 0;
+    }
+
+    return (0 > status) ? 1 : 0;
+}
+
+static SDL_bool clip_rect(SDL_Rect* src, SDL_Rect* dst, game_t* core)
+{
+    if (dst->x < 0)
+    {
+        src->x -= dst->x;
+        dst->w += dst->x;
+        dst->x  = 0;
+    }
+
+    if (dst->y < 0)
+    {
+        src->y -= dst->y;
+        dst->h += dst->y;
+        dst->y  = 0;
+    }
+
+    if (dst->x + dst->w > core->screen->w)
+    {
+        dst->w = core->screen->w - dst->x;
+    }
+
+    if (dst->y + dst->h > core->screen->h)
+    {
+        dst->h = core->screen->h - dst->y;
+    }
+
+    if (dst->w <= 0 || dst->h <= 0)
+    {
+        return SDL_FALSE;
+    }
+
+    src->w = dst->w;
+    src->h = dst->h;
+
+    return SDL_TRUE;
+}
+
+static void mark_dirty(const SDL_Rect* rect, game_t* core)
+{
+    int index;
+
+    // Skip regions already covered by a pending update, e.g. the
+    // frame drawn on top of a tile.
+    for (index = 0; index < core->dirty_count; index += 1)
+    {
+        SDL_Rect* pending = &core->dirty_rect[index];
+
+        if (rect->x >= pending->x &&
+            rect->y >= pending->y &&
+            rect->x + rect->w <= pending->x + pending->w &&
+            rect->y + rect->h <= pending->y + pending->h)
+        {
+            return;
+        }
+    }
+
+    if (core->dirty_count < FB_MAX_DIRTY_RECTS)
+    {
+        core->dirty_rect[core->dirty_count] = *rect;
+        core->dirty_count += 1;
+    }
+    else
+    {
+        // Out of slots: grow the last region to cover this one too.
+        SDL_UnionRect(&core->dirty_rect[FB_MAX_DIRTY_RECTS - 1], rect, &core->dirty_rect[FB_MAX_DIRTY_RECTS - 1]);
+    }
+}
+
+static void fill_row_16(Uint16* row, Uint16 color, int count)
+{
+    Uint32 pair = ((Uint32)color << 16) | color;
+
+    if (0 != ((size_t)row & 2) && count > 0)
+    {
+        *row++  = color;
+        count  -= 1;
+    }
+
+    while (count >= 2)
+    {
+        *(Uint32*)row  = pair;
+        row           += 2;
+        count         -= 2;
+    }
+
+    if (count > 0)
+    {
+        *row = color;
+    }
+}
+
+static void fill_row_32(Uint32* row, Uint32 color, int count)
+{
+    while (count > 0)
+    {
+        *row++  = color;
+        count  -= 1;
+    }
+}
+
+#endif /* USE_FRAMEBUFFER */
@@ -11,60 +11,82 @@
 #include <stdlib.h>
 #include <time.h>
 #include "game.h"
+#include "game_core.h"
 
 #define STB_SPRINTF_IMPLEMENTATION
 #include "stb_sprintf.h"
 
-#if defined __SYMBIAN32__
-#define SAVE_FILE       "C:\\wordle.sav"
-#define DAILY_SAVE_FILE "C:\\daily.sav"
-#else
-#define SAVE_FILE       "wordle.sav"
-#define DAILY_SAVE_FILE "daily.sav"
-#endif
-
-#if ! SDL_VERSION_ATLEAST(2, 0, 20)
-int SDL_isalpha(int x) { return isalpha(x); }
-#define SDL_clamp(x, a, b) (((x) < (a)) ? (a) : (((x) > (b)) ? (b) : (x)))
-#endif
-
+static event_t  get_confirm_event(game_t* core);
 static event_t  get_current_event(game_t* core);
-static void     clear_tiles(SDL_bool clear_state, game_t* core);
-static void     delete_letter(game_t* core);
+static event_t  get_mode_event(SDL_bool next, game_t* core);
+static void     handle_event(const input_t* input, game_t* core);
+static SDL_bool is_barrier_event(event_t event, game_t* core);
+static void     poll_events(game_t* core);
+static SDL_bool pop_event(input_t* input, game_t* core);
+static SDL_bool push_event(const input_t* input, game_t* core);
+static SDL_bool resolve_event(input_t* input, game_t* core);
 static int      draw_tiles(game_t* core);
-static void     get_index_limits(int* lower_limit, int* upper_limit, game_t* core);
-static void     go_back_to_menu(game_t* core);
-static void     goto_next_letter(game_t* core);
-static SDL_bool has_game_ended(game_t* core);
-static void     move_rows_up(game_t* core);
-static void     reset_game(SDL_bool nyt_mode, game_t* core);
-static void     select_next_letter(const unsigned char start_char, const unsigned char end_char, game_t* core);
-static void     select_previous_letter(const unsigned char start_char, const unsigned char end_char, game_t* core);
-static void     select_utf8_letter(const Uint16 *text, game_t* core);
-static void     show_results(game_t* core);
+static void     draw_boards(game_t* core);
+static void     draw_osd(game_t* core);
+#ifdef USE_FRAMEBUFFER
+static SDL_bool restore_osd(game_t* core);
+#endif
+static void     get_board_rect(Uint8 board_index, SDL_Rect* rect, int* cell_size, game_t* core);
+static void     get_letter_source(unsigned char letter, state_t state, SDL_Rect* src, game_t* core);
+static void     load_decision_tree(game_t* core);
+static int      load_textures(game_t* core);
+static void     print_bot_analysis(game_t* core);
+static void     print_stats(game_t* core);
+static void     print_suggestions(game_t* core);
+static int      transliterate_word(const unsigned char* word, char* text, int size, game_t* core);
+static size_t   read_save(SDL_bool daily, void* buffer, size_t size, void* user_data);
+static void     write_save(SDL_bool daily, const void* buffer, size_t size, void* user_data);
+static size_t   read_stats(lang_t language, Uint32 offset, void* buffer, size_t size, void* user_data);
+static void     append_stats(lang_t language, const void* buffer, size_t size, void* user_data);
+static void     write_stats_header(lang_t language, const void* buffer, size_t size, void* user_data);
+static void     set_text_input(SDL_bool enabled, void* user_data);
 static void     set_zoom_factor(game_t* core);
-static void     set_render_offset(game_t* core);
 static void     toggle_fullscreen(game_t* core);
 
-extern void          init_file_reader(const char * dataFilePath);
-extern size_t        size_of_file(const char * path);
-extern Uint8        *load_binary_file_from_path(const char * path);
+extern void          init_file_reader(pfs_t * pfs, const char * dataFilePath);
+extern SDL_RWops*    open_binary_file_from_path(const pfs_t * pfs, const char * path);
 extern int           osd_init(game_t* core);
+extern void          arena_init(size_t capacity, arena_t* arena);
+extern void          arena_quit(arena_t* arena);
+extern void          arena_count_heap_allocations(void);
+extern Uint32        arena_get_heap_allocations(void);
+extern void          storage_init(game_t* core);
+extern void          storage_quit(game_t* core);
+extern void          storage_update(game_t* core);
+extern SDL_bool      storage_has_save(void);
+extern SDL_RWops*    storage_open(const char* file_name, const char* mode);
+extern size_t        storage_read_save(SDL_bool daily, void* buffer, size_t size, game_t* core);
+extern void          storage_write_save(SDL_bool daily, const void* buffer, size_t size, game_t* core);
+extern size_t        storage_read_stats(lang_t language, Uint32 offset, void* buffer, size_t size, game_t* core);
+extern void          storage_append_stats(lang_t language, const void* buffer, size_t size, game_t* core);
+extern void          storage_write_stats_header(lang_t language, const void* buffer, size_t size, game_t* core);
 extern void          osd_print(const char* display_text, const int pos_x, const int pos_y, game_t* core);
-extern int           load_texture_from_file(const char* file_name, SDL_Texture** texture, game_t* core);
-extern Uint32        generate_hash(const unsigned char* name);
-extern unsigned int  xorshift(unsigned int* xs);
-extern void          set_language(const lang_t language, const SDL_bool set_title_screen, game_t* core);
-extern void          set_next_language(game_t* core);
-extern unsigned int  get_nyt_daily_index(void);
-extern void          get_valid_answer(unsigned char valid_answer[6], game_t* core);
-extern SDL_bool      is_guess_allowed(const unsigned char* guess, game_t* core);
-extern void          validate_current_guess(SDL_bool* is_won, game_t* core);
+extern int           load_texture_from_file(const char* file_name, image_t** texture, game_t* core);
+extern void          free_texture(image_t* texture);
+extern Uint32        select_texture_format(game_t* core);
+extern int           fb_begin(game_t* core);
+extern void          fb_clear(game_t* core);
+extern void          fb_blit(SDL_Surface* image, const SDL_Rect* src, const SDL_Rect* dst, game_t* core);
+extern void          fb_blit_scaled(SDL_Surface* image, const SDL_Rect* src, const SDL_Rect* dst, game_t* core);
+extern void          fb_fill_rect(const SDL_Rect* rect, Uint8 r, Uint8 g, Uint8 b, game_t* core);
+extern void          fb_draw_rect(const SDL_Rect* rect, Uint8 r, Uint8 g, Uint8 b, game_t* core);
+extern int           fb_present(game_t* core);
+extern void          replay_record_input(const input_t* input, game_t* core);
 
 int game_init(const char* resource_file, const char* title, game_t** core)
 {
     int    status         = 0;
+#ifndef USE_FRAMEBUFFER
     Uint32 renderer_flags = SDL_RENDERER_SOFTWARE;
+#endif
+
+    // Before SDL_Init(), so all heap allocations are counted.
+    arena_count_heap_allocations();
 
     *core = (game_t*)calloc(1, sizeof(struct game));
     if (NULL == *core)
@@ -77,7 +99,7 @@ int game_init(const char* resource_file, const char* title, game_t** core)
         return 1;
     }
 
-#ifndef __SYMBIAN32__
+#if !defined __SYMBIAN32__ && !defined USE_FRAMEBUFFER
     renderer_flags = SDL_RENDERER_ACCELERATED;
 # ifndef __ANDROID__
     renderer_flags |= SDL_RENDERER_PRESENTVSYNC;
@@ -103,6 +125,16 @@ int game_init(const char* resource_file, const char* title, game_t** core)
     toggle_fullscreen((*core));
 #endif
 
+#ifdef USE_FRAMEBUFFER
+    init_file_reader(&(*core)->pfs, resource_file);
+
+    if (0 != fb_begin((*core)))
+    {
+        SDL_DestroyWindow((*core)->window);
+        return 1;
+    }
+    fb_clear((*core));
+#else
     (*core)->renderer = SDL_CreateRenderer((*core)->window, -1, renderer_flags);
     if (NULL == (*core)->renderer)
     {
@@ -112,19 +144,27 @@ int game_init(const char* resource_file, const char* title, game_t** core)
             return 1;
         }
     }
+
+    // The scene is always drawn at native resolution and scaled once
+    // when presented.
+    if (0 != SDL_RenderSetLogicalSize((*core)->renderer, WINDOW_WIDTH, WINDOW_HEIGHT))
+    {
+        /* Nothing to do here. */
+    }
     if (0 != SDL_RenderSetIntegerScale((*core)->renderer, SDL_TRUE))
     {
         /* Nothing to do here. */
     }
 
-    init_file_reader(resource_file);
+    init_file_reader(&(*core)->pfs, resource_file);
 
-    (*core)->render_target = SDL_CreateTexture(
+    (*core)->texture_format = select_texture_format((*core));
+    (*core)->render_target  = SDL_CreateTexture(
         (*core)->renderer,
-        SDL_PIXELFORMAT_RGB444,
+        (*core)->texture_format,
         SDL_TEXTUREACCESS_TARGET,
-        WINDOW_WIDTH  * (*core)->zoom_factor,
-        WINDOW_HEIGHT * (*core)->zoom_factor);
+        WINDOW_WIDTH,
+        WINDOW_HEIGHT);
 
     if (NULL == (*core)->render_target)
     {
@@ -138,50 +178,50 @@ int game_init(const char* resource_file, const char* title, game_t** core)
     }
     SDL_SetRenderDrawColor((*core)->renderer, 0xff, 0xff, 0xff, 0x00);
     SDL_RenderClear((*core)->renderer);
+#endif
+
+    // The arena is released whether or not all textures could be
+    // loaded.
+    arena_init(ARENA_SIZE, &(*core)->arena);
+    status = load_textures((*core));
+    arena_quit(&(*core)->arena);
 
-    status = load_texture_from_file((const char*)"tiles.png", &(*core)->tile_texture, (*core));
     if (0 != status)
     {
         return status;
     }
 
 #ifdef __ANDROID__
-    status = load_texture_from_file((const char*)"disclaimer.png", &(*core)->disclaimer_texture, (*core));
-    if (0 != status)
+    if (SDL_FALSE == storage_has_save())
     {
-        return status;
+        (*core)->show_disclaimer = SDL_TRUE;
     }
+#endif
+
+    load_decision_tree((*core));
 
     {
-        SDL_RWops* save_file           = NULL;
-        char       save_file_path[256] = { 0 };
-        stbsp_snprintf(save_file_path, 256, "%s/%s", SDL_AndroidGetInternalStoragePath(), SAVE_FILE);
-        save_file = SDL_RWFromFile(save_file_path, "rb");
+        game_hooks_t hooks = { 0 };
+        unsigned int seed;
 
-        if (NULL == save_file)
-        {
-            (*core)->show_disclaimer = SDL_TRUE;
-        }
-        else
-        {
-            SDL_RWclose(save_file);
-        }
-    }
+#ifndef __EMSCRIPTEN__
+        hooks.read_save          = read_save;
+        hooks.write_save         = write_save;
+        hooks.read_stats         = read_stats;
+        hooks.append_stats       = append_stats;
+        hooks.write_stats_header = write_stats_header;
 #endif
+        hooks.set_text_input     = set_text_input;
+        hooks.user_data          = *core;
 
-    status = osd_init((*core));
-    if (0 != status)
-    {
-        return status;
+        // Seed each instance separately instead of using the
+        // process-wide rand() state.
+        seed = (unsigned int)time(NULL) ^ (unsigned int)SDL_GetPerformanceCounter() ^ (unsigned int)(size_t)(*core);
+        storage_init(*core);
+        game_state_init(seed, &hooks, &(*core)->state);
     }
 
-    set_language(LANG_ENGLISH, SDL_TRUE, (*core));
-    srand(time(0));
-
-    (*core)->seed          = (unsigned int)rand();
-    (*core)->current_index = 27;
-    (*core)->show_menu     = SDL_TRUE;
-    (*core)->is_running    = SDL_TRUE;
+    (*core)->is_running = SDL_TRUE;
 
     return status;
 }
@@ -200,42 +240,38 @@ SDL_bool game_is_running(game_t* core)
 
 int game_update(game_t *core)
 {
-    int           status       = 0;
-    SDL_bool      redraw_tiles = SDL_FALSE;
-    SDL_Rect      dst          = { 0, 0, WINDOW_WIDTH * core->zoom_factor, WINDOW_HEIGHT * core->zoom_factor };
-    Uint32        delta_time   = 0;
-    event_t       event        = get_current_event(core);
-    unsigned char start_char;
-    unsigned char end_char;
+    int      status       = 0;
+    SDL_bool redraw_tiles = SDL_FALSE;
+    Uint32   delta_time   = 0;
+    input_t  input;
 
     if (NULL == core)
     {
         return 1;
     }
 
-    if (0 == core->tile[0].letter)
+    if (0 == core->state.tile[0].letter)
     {
         redraw_tiles         = SDL_TRUE;
-        core->tile[0].letter = 0;
+        core->state.tile[0].letter = 0;
     }
 
-    if (SDL_TRUE == core->show_menu)
+    if (SDL_TRUE == core->state.show_menu)
     {
-        core->show_stats = SDL_FALSE;
+        core->state.show_stats = SDL_FALSE;
         redraw_tiles     = SDL_TRUE;
     }
 
-    if (EVENT_NONE != event)
-    {
-#ifdef __ANDROID__
-        core->show_disclaimer = SDL_FALSE;
-#endif
-        redraw_tiles = SDL_TRUE;
-    }
-
     core->time_b = core->time_a;
     core->time_a = SDL_GetTicks();
 
+    // Saves are written outside of the frame.
+    CHECK_HEAP_ALLOCATIONS(core);
+    storage_update(core);
+#ifndef NDEBUG
+    core->heap_allocations = arena_get_heap_allocations();
+#endif
+
     if (core->time_a > core->time_b)
     {
         delta_time = core->time_a - core->time_b;
@@ -246,305 +282,20 @@ int game_update(game_t *core)
     }
     core->time_since_last_frame = delta_time;
 
-    switch (event)
+    // Apply every pending input before rendering the frame once.
+    poll_events(core);
+    while (SDL_TRUE == pop_event(&input, core))
     {
-        default:
-        case EVENT_NONE:
-            break;
-        case EVENT_KEY_0:
-            if (0 != core->wordlist.special_chars[0])
-            {
-                unsigned char* current_letter = &core->tile[core->current_index].letter;
-
-                start_char = core->wordlist.first_letter;
-                end_char   = core->wordlist.last_letter;
-
-                if (*current_letter >= start_char && *current_letter < end_char)
-                {
-                    *current_letter = core->wordlist.special_chars[0];
-                }
-                else
-                {
-                    static unsigned int special_char_index = 0;
-
-                    special_char_index += 1;
-                    if (0x00 == core->wordlist.special_chars[special_char_index])
-                    {
-                        special_char_index = 0;
-                    }
-                    *current_letter = core->wordlist.special_chars[special_char_index];
-                }
-            }
-            break;
-        case EVENT_KEY_2:
-            if (SDL_TRUE == core->wordlist.is_cyrillic)
-            {
-                start_char = 0xc0; // А
-                end_char   = 0xc3; // Г
-            }
-            else
-            {
-                start_char = 'A';
-                end_char   = 'C';
-            }
-            select_next_letter(start_char, end_char, core);
-            break;
-        case EVENT_KEY_3:
-            if (SDL_TRUE == core->wordlist.is_cyrillic)
-            {
-                start_char = 0xc4; // Д
-                end_char   = 0xc7; // З
-            }
-            else
-            {
-                start_char = 'D';
-                end_char   = 'F';
-            }
-            select_next_letter(start_char, end_char, core);
-            break;
-        case EVENT_KEY_4:
-            if (SDL_TRUE == core->wordlist.is_cyrillic)
-            {
-                start_char = 0xc8; // И
-                end_char   = 0xca; // Л
-            }
-            else
-            {
-                start_char = 'G';
-                end_char   = 'I';
-            }
-            select_next_letter(start_char, end_char, core);
-            break;
-        case EVENT_KEY_5:
-            if (SDL_TRUE == core->wordlist.is_cyrillic)
-            {
-                start_char = 0xcb; // М
-                end_char   = 0xcf; // П
-            }
-            else
-            {
-                start_char = 'J';
-                end_char   = 'L';
-            }
-            select_next_letter(start_char, end_char, core);
-            break;
-        case EVENT_KEY_6:
-            if (SDL_TRUE == core->wordlist.is_cyrillic)
-            {
-                start_char = 0xd0; // Р
-                end_char   = 0xd3; // У
-            }
-            else
-            {
-                start_char = 'M';
-                end_char   = 'O';
-            }
-            select_next_letter(start_char, end_char, core);
-            break;
-        case EVENT_KEY_7:
-            if (SDL_TRUE == core->wordlist.is_cyrillic)
-            {
-                start_char = 0xd4; // Ф
-                end_char   = 0xd7; // Ч
-            }
-            else
-            {
-                start_char = 'P';
-                end_char   = 'S';
-            }
-            select_next_letter(start_char, end_char, core);
-            break;
-        case EVENT_KEY_8:
-            if (SDL_TRUE == core->wordlist.is_cyrillic)
-            {
-                start_char = 0xd8; // Ш
-                end_char   = 0xdb; // Ы
-            }
-            else
-            {
-                start_char = 'T';
-                end_char   = 'V';
-            }
-            select_next_letter(start_char, end_char, core);
-            break;
-        case EVENT_KEY_9:
-            if (SDL_TRUE == core->wordlist.is_cyrillic)
-            {
-                start_char = 0xdc; // Ь
-                end_char   = 0xdf; // Я
-            }
-            else
-            {
-                start_char = 'W';
-                end_char   = 'Z';
-            }
-            select_next_letter(start_char, end_char, core);
-            break;
-        case EVENT_CONFIRM:
-            if (core->attempt < 6)
-            {
-                if (0 == ((core->current_index + 1) % 5))
-                {
-                    int  index;
-                    int  letter_index;
-                    int  end_index;
-
-                    get_index_limits(&index, &end_index, core);
-
-                    for (letter_index = 0; letter_index < 5; letter_index += 1)
-                    {
-                        core->current_guess[letter_index]  = core->tile[index].letter;
-                        index                             += 1;
-                    }
-
-                    if (SDL_TRUE == is_guess_allowed(core->current_guess, core))
-                    {
-                        if (SDL_TRUE == core->nyt_mode)
-                        {
-                            game_save(core);
-                        }
-
-                        if (SDL_TRUE == has_game_ended(core))
-                        {
-                            if (SDL_TRUE == core->nyt_mode)
-                            {
-                                core->nyt_final_attempt = core->attempt + 1;
-                                core->nyt_has_ended     = SDL_TRUE;
-                                game_save(core);
-                            }
-                            show_results(core);
-                        }
-                        else
-                        {
-                            if ((SDL_TRUE == core->endless_mode) && (4 == core->attempt))
-                            {
-                                move_rows_up(core);
-                                core->current_index -= 5;
-                            }
-                            else
-                            {
-                                core->attempt += 1;
-                            }
-                            goto_next_letter(core);
-                        }
-                    }
-                    else
-                    {
-                        // Word not valid: shake row?
-                    }
-                }
-            }
-            else
-            {
-                game_save(core);
-                clear_tiles(SDL_TRUE, core);
-                core->current_index = 27;
-                set_language(core->wordlist.language, SDL_TRUE, core);
-            }
-            break;
-        case EVENT_CONFIRM_LETTER:
-            goto_next_letter(core);
-            break;
-        case EVENT_DELETE_LETTER:
-            delete_letter(core);
-            switch((core->current_index))
-            {
-                case 0:
-                case 5:
-                case 10:
-                case 15:
-                case 20:
-                case 25:
-                    if (0 == core->tile[core->current_index].letter)
-                    {
-                        go_back_to_menu(core);
-                    }
-                    break;
-                default:
-                    break;
-            }
-            break;
-        case EVENT_NEXT_LETTER:
-            start_char = core->wordlist.first_letter;
-            end_char   = core->wordlist.last_letter;
-            select_next_letter(start_char, end_char, core);
-            break;
-        case EVENT_PREV_LETTER:
-            start_char = core->wordlist.first_letter;
-            end_char   = core->wordlist.last_letter;
-            select_previous_letter(start_char, end_char, core);
-            break;
-        case EVENT_TEXTINPUT:
-            if (SDL_TRUE != core->show_menu)
-            {
-                select_utf8_letter((const Uint16*)core->event.text.text, core);
-            }
-            break;
-        case EVENT_CONFIRM_ENDLESS_MODE:
-            core->endless_mode = SDL_TRUE;
-            core->nyt_mode     = SDL_FALSE;
-            reset_game(SDL_FALSE, core);
-            break;
-        case EVENT_CONFIRM_LOAD_GAME:
-            core->endless_mode = SDL_FALSE;
-            core->nyt_mode     = SDL_FALSE;
-            game_load(SDL_FALSE, core);
-            break;
-        case EVENT_CONFIRM_NEW_GAME:
-            core->endless_mode = SDL_FALSE;
-            core->nyt_mode     = SDL_FALSE;
-            game_save(core);
-            reset_game(SDL_FALSE, core);
-            break;
-        case EVENT_CONFIRM_NYT_MODE:
-            core->endless_mode = SDL_FALSE;
-            core->nyt_mode     = SDL_TRUE;
-            game_load(SDL_TRUE, core);
+#ifdef __ANDROID__
+        core->show_disclaimer = SDL_FALSE;
+#endif
+        redraw_tiles = SDL_TRUE;
+        handle_event(&input, core);
 
-            if (SDL_TRUE == core->nyt_has_ended)
-            {
-                show_results(core);
-            }
-            break;
-        case EVENT_CONFIRM_SET_LANG:
-            core->language_set_once = SDL_TRUE;
-            set_next_language(core);
-            break;
-        case EVENT_MENU_NEXT:
-            core->current_index += 1;
-            if (core->current_index > 29)
-            {
-                core->current_index = 25;
-            }
-            break;
-        case EVENT_MENU_PREV:
-            core->current_index -= 1;
-            if (core->current_index < 25)
-            {
-                core->current_index = 29;
-            }
-            break;
-        case EVENT_MENU_SELECT_ENDLESS_MODE:
-            core->selected_mode = MODE_ENDLESS;
-            break;
-        case EVENT_MENU_SELECT_NYT_MODE:
-            core->selected_mode = MODE_NYT;
-            break;
-        case EVENT_MENU_SELECT_NEW_GAME:
-            core->current_index = 25;
-            break;
-        case EVENT_MENU_SELECT_QUIT:
-            core->current_index = 29;
-            break;
-        case EVENT_BACK:
-            go_back_to_menu(core);
-            break;
-        case EVENT_QUIT:
-            core->is_running = SDL_FALSE;
+        if (SDL_FALSE == core->is_running)
+        {
             return 0;
-        case EVENT_TOGGLE_FS:
-            toggle_fullscreen(core);
-            break;
+        }
     }
 
     if (SDL_TRUE == redraw_tiles)
@@ -555,30 +306,44 @@ int game_update(game_t *core)
             return status;
         }
 
-        if (SDL_TRUE == core->show_stats)
-        {
-            char stats[16]   = { 0 };
-            int  stats_pos_x = 64;
+        draw_osd(core);
 
-            if (get_nyt_daily_index() >= 1000)
+#ifdef USE_FRAMEBUFFER
+        // Once the text changes, the tiles below the old one are
+        // redrawn and the new one is drawn on top again.
+        if (SDL_TRUE == restore_osd(core))
+        {
+            status = draw_tiles(core);
+            if (0 != status)
             {
-                stats_pos_x = 57;
+                return status;
             }
 
-            stbsp_snprintf(stats, 16, "Wordle %u %1u/6", get_nyt_daily_index(), core->nyt_final_attempt);
-            osd_print(stats, stats_pos_x, 12, core);
+            draw_osd(core);
         }
+#endif
+    }
+
+#ifdef USE_FRAMEBUFFER
+#ifdef __ANDROID__
+    if (SDL_TRUE == core->show_disclaimer)
+    {
+        SDL_Rect disclaimer = { 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
+        fb_blit(core->disclaimer_texture, &disclaimer, &disclaimer, core);
     }
+#endif
 
+    if (0 != fb_present(core))
+    {
+        return 1;
+    }
+#else
     if (0 > SDL_SetRenderTarget(core->renderer, NULL))
     {
         return 1;
     }
 
-    dst.x += core->render_offset_x;
-    dst.y += core->render_offset_y;
-
-    if (0 > SDL_RenderCopy(core->renderer, core->render_target, NULL, &dst))
+    if (0 > SDL_RenderCopy(core->renderer, core->render_target, NULL, NULL))
     {
         return 1;
     }
@@ -586,7 +351,7 @@ int game_update(game_t *core)
 #ifdef __ANDROID__
     if (SDL_TRUE == core->show_disclaimer)
     {
-        if (0 > SDL_RenderCopy(core->renderer, core->disclaimer_texture, NULL, &dst))
+        if (0 > SDL_RenderCopy(core->renderer, core->disclaimer_texture, NULL, NULL))
         {
             return 1;
         }
@@ -596,41 +361,57 @@ int game_update(game_t *core)
     SDL_SetRenderDrawColor(core->renderer, 0xff, 0xff, 0xff, 0x00);
     SDL_RenderPresent(core->renderer);
     SDL_RenderClear(core->renderer);
+#endif
 
     return status;
 }
 
 void game_quit(game_t* core)
 {
+    storage_quit(core);
+
 #ifdef __ANDROID__
     if (core->disclaimer_texture)
     {
-        SDL_DestroyTexture(core->disclaimer_texture);
+        free_texture(core->disclaimer_texture);
         core->disclaimer_texture = NULL;
     }
 #endif
 
     if (core->tile_texture)
     {
-        SDL_DestroyTexture(core->tile_texture);
+        free_texture(core->tile_texture);
         core->tile_texture = NULL;
     }
 
+    SDL_free(core->decision_tree);
+    core->decision_tree = NULL;
+
+    if (core->font_texture)
+    {
+        free_texture(core->font_texture);
+        core->font_texture = NULL;
+    }
+
+#ifndef USE_FRAMEBUFFER
     if (core->render_target)
     {
         SDL_DestroyTexture(core->render_target);
         core->render_target = NULL;
     }
+#endif
 
     if (core->window)
     {
         SDL_DestroyWindow(core->window);
     }
 
+#ifndef USE_FRAMEBUFFER
     if (core->renderer)
     {
         SDL_DestroyRenderer(core->renderer);
     }
+#endif
 
     if (core)
     {
@@ -640,225 +421,211 @@ void game_quit(game_t* core)
     SDL_Quit();
 }
 
-/* Since a compiler often appends padding bytes to structures and
- * because this function does not checks the endianness of the system,
- * this function is by definition not portable.  The worst that can
- * happen, however, is that the resulting save file is not usable across
- * different platforms.
- */
 void game_save(game_t* core)
 {
-    SDL_RWops* save_file;
-    int        index;
+    if (NULL == core)
+    {
+        return;
+    }
 
-#ifdef __EMSCRIPTEN__
-    return;
-#endif
+    game_state_save(&core->state);
+}
 
+void game_load(SDL_bool load_daily, game_t* core)
+{
     if (NULL == core)
     {
         return;
     }
 
-    if (SDL_FALSE == core->nyt_mode)
+    game_state_load(load_daily, &core->state);
+}
+
+static void handle_event(const input_t* input, game_t* core)
+{
+    input_t resolved = *input;
+
+    if (SDL_FALSE == resolve_event(&resolved, core))
     {
-        save_state_t state;
+        return;
+    }
+    input = &resolved;
 
-        for (index = 0; index < 30; index += 1)
-        {
-            state.tile[index].letter       = core->tile[index].letter;
-            state.tile[index].letter_index = core->tile[index].letter_index;
-            state.tile[index].state        = core->tile[index].state;
-        }
+    if (NULL != core->record)
+    {
+        replay_record_input(input, core);
+    }
 
-        state.version            = SAVE_VERSION;
-        state.current_index      = core->current_index;
-        state.previous_letter    = core->previous_letter;
-        state.valid_answer_index = core->valid_answer_index;
-        state.attempt            = core->attempt;
-        state.seed               = core->seed;
-        state.language           = core->wordlist.language;
+    switch (input->type)
+    {
+        case EVENT_QUIT:
+            core->is_running = SDL_FALSE;
+            break;
+        case EVENT_TOGGLE_FS:
+            toggle_fullscreen(core);
+            break;
+        default:
+            game_state_apply(input, &core->state);
+            break;
+    }
+}
 
-#ifdef __ANDROID__
-        {
-            char save_file_path[256] = { 0 };
-            stbsp_snprintf(save_file_path, 256, "%s/%s", SDL_AndroidGetInternalStoragePath(), SAVE_FILE);
-            save_file = SDL_RWFromFile(save_file_path, "wb");
-        }
-#else
-        save_file = SDL_RWFromFile(SAVE_FILE, "wb");
-#endif
-        if (NULL == save_file)
-        {
-            return;
-        }
+static void poll_events(game_t* core)
+{
+    input_t input;
 
-        SDL_RWwrite(save_file, &state, sizeof(struct save_state), 1);
-        SDL_RWclose(save_file);
+    if (NULL == core)
+    {
+        return;
     }
-    else
+
+    // Once the queue is full, further events are left with SDL until
+    // the next frame; polled ones could not be put back.
+    while ((((core->event_tail + 1) % EVENT_QUEUE_SIZE) != core->event_head) && SDL_PollEvent(&core->event))
     {
-        nyt_save_state_t state;
+        input.type  = get_current_event(core);
+        input.text  = 0;
+        input.count = 1;
+        input.dx    = 0.f;
+        input.dy    = 0.f;
 
-        for (index = 0; index < 30; index += 1)
+        if (EVENT_NONE == input.type)
         {
-            state.tile[index].letter       = core->tile[index].letter;
-            state.tile[index].letter_index = core->tile[index].letter_index;
-            state.tile[index].state        = core->tile[index].state;
+            continue;
         }
 
-        state.current_index      = core->current_index;
-        state.previous_letter    = core->previous_letter;
-        state.valid_answer_index = core->valid_answer_index;
-        state.has_ended          = core->nyt_has_ended;
-        state.attempt            = core->attempt;
-        state.final_attempt      = core->nyt_final_attempt;
+        // While replaying, only the recorded input is applied.
+        if (NULL != core->replay && EVENT_QUIT != input.type)
+        {
+            continue;
+        }
 
+        if (EVENT_TEXTINPUT == input.type)
+        {
+            input.text = (Uint16)((Uint8)core->event.text.text[0] | ((Uint8)core->event.text.text[1] << 8));
+        }
 #ifdef __ANDROID__
+        else if (EVENT_SWIPE == input.type)
         {
-            char save_file_path[256] = { 0 };
-            stbsp_snprintf(save_file_path, 256, "%s/%s", SDL_AndroidGetInternalStoragePath(), DAILY_SAVE_FILE);
-            save_file = SDL_RWFromFile(save_file_path, "wb");
+            input.dx = core->event.tfinger.dx;
+            input.dy = core->event.tfinger.dy;
+        }
+        else if (EVENT_TOUCH == input.type)
+        {
+            Uint32 touch_duration = (core->touch_up_timestamp - core->touch_down_timestamp);
+
+            input.text = (touch_duration > 0xffff) ? 0xffff : (Uint16)touch_duration;
         }
-#else
-        save_file = SDL_RWFromFile(DAILY_SAVE_FILE, "wb");
 #endif
-        if (NULL == save_file)
+
+        if (SDL_FALSE == push_event(&input, core))
         {
-            return;
+            break;
         }
 
-        SDL_RWwrite(save_file, &state, sizeof(struct nyt_save_state), 1);
-        SDL_RWclose(save_file);
+        // Translating the next event may depend on the state this
+        // one is about to change, so leave the rest for next frame.
+        if (SDL_TRUE == is_barrier_event(input.type, core))
+        {
+            break;
+        }
     }
 }
 
-void game_load(SDL_bool load_daily, game_t* core)
+SDL_bool game_push_input(const input_t* input, game_t* core)
 {
-    SDL_RWops* save_file;
-    int        index;
-
-    if (NULL == core)
+    if (NULL == core || NULL == input)
     {
-        return;
+        return SDL_FALSE;
     }
 
-#ifdef __EMSCRIPTEN__
-    if (SDL_TRUE == load_daily)
-    {
-        reset_game(SDL_TRUE, core);
-    }
-    else
-    {
-        reset_game(SDL_FALSE, core);
-    }
-    return;
-#endif
+    return push_event(input, core);
+}
+
+static SDL_bool push_event(const input_t* input, game_t* core)
+{
+    Uint8 next_tail = (core->event_tail + 1) % EVENT_QUEUE_SIZE;
 
-    if (SDL_FALSE == load_daily)
+    if (core->event_head != core->event_tail)
     {
-        save_state_t state = { 0 };
+        Uint8    last_index = (core->event_tail + EVENT_QUEUE_SIZE - 1) % EVENT_QUEUE_SIZE;
+        input_t* last       = &core->event_queue[last_index];
 
-#ifdef __ANDROID__
-        {
-            char save_file_path[256] = { 0 };
-            stbsp_snprintf(save_file_path, 256, "%s/%s", SDL_AndroidGetInternalStoragePath(), SAVE_FILE);
-            save_file = SDL_RWFromFile(save_file_path, "rb");
-        }
-#else
-        save_file = SDL_RWFromFile(SAVE_FILE, "rb");
-#endif
-        if (NULL == save_file)
-        {
-            /* Nothing to do here. */
-        }
-        else
+        // Coalesce repeated letter cycling into a single entry.  In
+        // the menu, each step selects the next mode from the one
+        // before, so these are kept apart.
+        if ((last->type == input->type) &&
+            ((EVENT_NEXT_LETTER == input->type) || (EVENT_PREV_LETTER == input->type)) &&
+            (SDL_FALSE == core->state.show_menu) &&
+            (last->count < 0xff))
         {
-            if (1 != SDL_RWread(save_file, &state, sizeof(struct save_state), 1))
-            {
-                /* Nothing to do here. */
-            }
-            SDL_RWclose(save_file);
+            last->count += 1;
+            return SDL_TRUE;
         }
 
-        if (SAVE_VERSION != state.version)
+        // Sum up consecutive finger motion the same way.
+        if ((last->type == input->type) && (EVENT_SWIPE == input->type))
         {
-            // Do not load outdated or invalid save states.
-            return;
+            last->dx += input->dx;
+            last->dy += input->dy;
+            return SDL_TRUE;
         }
+    }
 
-        core->show_menu = SDL_FALSE;
-        clear_tiles(SDL_TRUE, core);
+    if (next_tail == core->event_head)
+    {
+        // Queue is full.
+        return SDL_FALSE;
+    }
 
-        for (index = 0; index < 30; index += 1)
-        {
-            core->tile[index].letter       = state.tile[index].letter;
-            core->tile[index].letter_index = state.tile[index].letter_index;
-            core->tile[index].state        = state.tile[index].state;
-        }
+    core->event_queue[core->event_tail] = *input;
+    core->event_tail                    = next_tail;
 
-        core->current_index      = state.current_index;
-        core->previous_letter    = state.previous_letter;
-        core->valid_answer_index = state.valid_answer_index;
-        core->attempt            = state.attempt;
-        core->seed               = state.seed;
+    return SDL_TRUE;
+}
 
-        set_language(state.language, SDL_FALSE, core);
-    }
-    else
+static SDL_bool pop_event(input_t* input, game_t* core)
+{
+    if (core->event_head == core->event_tail)
     {
-        nyt_save_state_t state = { 0 };
+        return SDL_FALSE;
+    }
 
-#ifdef __ANDROID__
-        {
-            char save_file_path[256] = { 0 };
-            stbsp_snprintf(save_file_path, 256, "%s/%s", SDL_AndroidGetInternalStoragePath(), DAILY_SAVE_FILE);
-            save_file = SDL_RWFromFile(save_file_path, "rb");
-        }
-#else
-        save_file = SDL_RWFromFile(DAILY_SAVE_FILE, "rb");
-#endif
-        if (NULL == save_file)
-        {
-            /* Nothing to do here. */
-        }
-        else
-        {
-            if (1 != SDL_RWread(save_file, &state, sizeof(struct nyt_save_state), 1))
-            {
-                /* Nothing to do here. */
-            }
-            SDL_RWclose(save_file);
-        }
+    *input           = core->event_queue[core->event_head];
+    core->event_head = (core->event_head + 1) % EVENT_QUEUE_SIZE;
+
+    return SDL_TRUE;
+}
 
-        if (state.valid_answer_index != get_nyt_daily_index())
+static SDL_bool is_barrier_event(event_t event, game_t* core)
+{
+    // Menu navigation is resolved against the state when it is
+    // applied, see resolve_event(); only leaving the menu or changing
+    // the language or mode changes how the next event is translated.
+    if (SDL_TRUE == core->state.show_menu)
+    {
+        switch (event)
         {
-            /* New daily world available. */
-            reset_game(SDL_TRUE, core);
+            case EVENT_CONFIRM:
+            case EVENT_TOUCH:
+            case EVENT_BACK:
+            case EVENT_QUIT:
+                return SDL_TRUE;
+            default:
+                return SDL_FALSE;
         }
-        else
-        {
-            core->show_menu = SDL_FALSE;
-            clear_tiles(SDL_TRUE, core);
-
-            for (index = 0; index < 30; index += 1)
-            {
-                core->tile[index].letter       = state.tile[index].letter;
-                core->tile[index].letter_index = state.tile[index].letter_index;
-                core->tile[index].state        = state.tile[index].state;
-            }
-
-            core->current_index      = state.current_index;
-            core->previous_letter    = state.previous_letter;
-            core->valid_answer_index = state.valid_answer_index;
-            core->attempt            = state.attempt;
-            core->nyt_has_ended      = state.has_ended;
-            core->nyt_final_attempt  = state.final_attempt;
+    }
 
-            set_language(LANG_ENGLISH, SDL_FALSE, core);
-        }
+    switch (event)
+    {
+        case EVENT_CONFIRM:
+        case EVENT_DELETE_LETTER:
+        case EVENT_BACK:
+        case EVENT_QUIT:
+            return SDL_TRUE;
+        default:
+            return SDL_FALSE;
     }
-    SDL_StartTextInput();
 }
 
 static event_t get_current_event(game_t* core)
@@ -870,292 +637,314 @@ static event_t get_current_event(game_t* core)
         return current_event;
     }
 
-    if (SDL_PollEvent(&core->event))
+    switch (core->event.type)
     {
-        switch (core->event.type)
-        {
-            case SDL_QUIT:
-                return EVENT_QUIT;
+        case SDL_QUIT:
+            return EVENT_QUIT;
 #ifdef __ANDROID__
-            case SDL_FINGERMOTION:
-                core->swipe_v += core->event.tfinger.dy;
-                core->swipe_h += core->event.tfinger.dx;
-                break;
-            case SDL_FINGERUP:
-            case SDL_FINGERDOWN:
-                if ((SDL_FINGERDOWN == core->event.type))
+        case SDL_FINGERMOTION:
+            return EVENT_SWIPE;
+        case SDL_FINGERUP:
+        case SDL_FINGERDOWN:
+            if ((SDL_FINGERDOWN == core->event.type))
+            {
+                core->touch_down_timestamp = core->event.tfinger.timestamp;
+            }
+            if ((SDL_FINGERUP == core->event.type))
+            {
+                core->touch_up_timestamp = core->event.tfinger.timestamp;
+            }
+            return EVENT_TOUCH;
+#endif
+        case SDL_KEYDOWN:
+        {
+#ifndef __SYMBIAN32__
+            switch (core->event.key.keysym.sym)
+            {
+                case SDLK_F11:
+                    return EVENT_TOGGLE_FS;
+            }
+#endif
+            if (SDL_TRUE == core->state.show_menu)
+            {
+                switch (core->event.key.keysym.sym)
                 {
-                    core->touch_down_timestamp = core->event.tfinger.timestamp;
+                    case SDLK_KP_ENTER:
+                    case SDLK_RETURN:
+                    case SDLK_SELECT:
+                    case SDLK_5:
+                    case SDLK_KP_5:
+                        return EVENT_CONFIRM;
+                    case SDLK_LEFT:
+                        return EVENT_MENU_PREV;
+                    case SDLK_RIGHT:
+                        return EVENT_MENU_NEXT;
+                    case SDLK_UP:
+                        return EVENT_NEXT_LETTER;
+                    case SDLK_DOWN:
+                        return EVENT_PREV_LETTER;
+#ifdef __SYMBIAN32__
+                    case SDLK_SOFTLEFT:
+                        return EVENT_MENU_SELECT_NEW_GAME;
+                    case SDLK_SOFTRIGHT:
+                        return EVENT_MENU_SELECT_QUIT;
+#endif
+                    case SDLK_AC_BACK:
+                    case SDLK_ESCAPE:
+                        SDL_StopTextInput();
+                        return EVENT_QUIT;
                 }
-                if ((SDL_FINGERUP == core->event.type))
+            }
+            else
+            {
+                // Interpret key-presses while being not in the
+                // menu.
+                switch (core->event.key.keysym.sym)
                 {
-                    core->touch_up_timestamp = core->event.tfinger.timestamp;
+                    case SDLK_1:
+                    case SDLK_KP_1:
+                        return EVENT_TOGGLE_PREDICTIVE_INPUT;
+                    case SDLK_2:
+                    case SDLK_KP_2:
+                        return EVENT_KEY_2;
+                    case SDLK_3:
+                    case SDLK_KP_3:
+                        return EVENT_KEY_3;
+                    case SDLK_4:
+                    case SDLK_KP_4:
+                        return EVENT_KEY_4;
+                    case SDLK_5:
+                    case SDLK_KP_5:
+                        return EVENT_KEY_5;
+                    case SDLK_6:
+                    case SDLK_KP_6:
+                        return EVENT_KEY_6;
+                    case SDLK_7:
+                    case SDLK_KP_7:
+                        return EVENT_KEY_7;
+                    case SDLK_8:
+                    case SDLK_KP_8:
+                        return EVENT_KEY_8;
+                    case SDLK_9:
+                    case SDLK_KP_9:
+                        return EVENT_KEY_9;
+                    case SDLK_0:
+                    case SDLK_KP_0:
+                        return EVENT_KEY_0;
+                    case SDLK_UP:
+                        return EVENT_NEXT_LETTER;
+                    case SDLK_DOWN:
+                        return EVENT_PREV_LETTER;
+                    case SDLK_KP_ENTER:
+                    case SDLK_RETURN:
+                    case SDLK_SELECT:
+                        return EVENT_CONFIRM;
+                    case SDLK_BACKSPACE:
+                    case SDLK_LEFT:
+                        return EVENT_DELETE_LETTER;
+                    case SDLK_RIGHT:
+                        return EVENT_CONFIRM_LETTER;
+                    case SDLK_AC_BACK:
+                    case SDLK_ESCAPE:
+#ifdef __SYMBIAN32__
+                    case SDLK_SOFTLEFT:
+                    case SDLK_SOFTRIGHT:
+#endif
+                        SDL_StopTextInput();
+                        return EVENT_BACK;
                 }
+            }
+            break;
+        }
+        case SDL_TEXTINPUT:
+            return EVENT_TEXTINPUT;
+            break;
+    }
 
-                if (SDL_TRUE == core->show_menu)
-                {
-                    Uint32 touch_duration = (core->touch_up_timestamp - core->touch_down_timestamp);
-
-                    if (core->swipe_h >= 0.1f)
-                    {
-                        core->swipe_h = 0.f;
-                        return EVENT_MENU_NEXT;
-                    }
-                    else if (core->swipe_h <= -0.1f)
-                    {
-                        core->swipe_h = 0.f;
-                        return EVENT_MENU_PREV;
-                    }
-
-                    if (core->swipe_v >= 0.1f)
-                    {
-                        if (27 == core->current_index)
-                        {
-                            core->swipe_v = 0.f;
-                            return EVENT_MENU_SELECT_NYT_MODE;
-                        }
-                    }
-                    else if (core->swipe_v <= -0.1f)
-                    {
-                        if (27 == core->current_index)
-                        {
-                            core->swipe_v = 0.f;
-                            return EVENT_MENU_SELECT_ENDLESS_MODE;
-                        }
-                    }
+    return EVENT_NONE;
+}
 
-                    if ((touch_duration >= 100) && (touch_duration <= 1000))
-                    {
-                        switch (core->current_index)
-                        {
-                            case 25:
-                                return EVENT_CONFIRM_NEW_GAME;
-                            case 26:
-                                return EVENT_CONFIRM_LOAD_GAME;
-                            case 27:
-                                switch (core->selected_mode)
-                                {
-                                    default:
-                                    case MODE_NYT:
-                                        return EVENT_CONFIRM_NYT_MODE;
-                                    case MODE_ENDLESS:
-                                        return EVENT_CONFIRM_ENDLESS_MODE;
-                                }
-                            case 28:
-                                return EVENT_CONFIRM_SET_LANG;
-                            case 29:
-                                return EVENT_QUIT;
-                            default:
-                                break;
-                        }
-                    }
-                    break;
+// Menu events are queued as the plain key or touch and only resolved
+// here, against the state left by the events applied before them.
+// Returns SDL_FALSE if there is nothing left to apply.
+static SDL_bool resolve_event(input_t* input, game_t* core)
+{
+    switch (input->type)
+    {
+        case EVENT_NONE:
+            return SDL_FALSE;
+#ifdef __ANDROID__
+        case EVENT_SWIPE:
+            core->swipe_h += input->dx;
+            core->swipe_v += input->dy;
+            return SDL_FALSE;
+        case EVENT_TOUCH:
+            input->type = EVENT_NONE;
+
+            if (SDL_TRUE == core->state.show_menu)
+            {
+                if (core->swipe_h >= 0.1f)
+                {
+                    core->swipe_h = 0.f;
+                    input->type   = EVENT_MENU_NEXT;
                 }
-                else
+                else if (core->swipe_h <= -0.1f)
                 {
-                    Uint32 touch_duration = (core->touch_up_timestamp - core->touch_down_timestamp);
-                    if ((touch_duration >= 100) && (touch_duration <= 1000))
-                    {
-                        SDL_StartTextInput();
-                    }
+                    core->swipe_h = 0.f;
+                    input->type   = EVENT_MENU_PREV;
                 }
-                break;
-#endif
-            case SDL_KEYDOWN:
-            {
-#ifndef __SYMBIAN32__
-                switch (core->event.key.keysym.sym)
+                else if ((core->swipe_v >= 0.1f) && (27 == core->state.current_index))
                 {
-                    case SDLK_F11:
-                        return EVENT_TOGGLE_FS;
+                    core->swipe_v = 0.f;
+                    input->type   = get_mode_event(SDL_FALSE, core);
                 }
-#endif
-                if (SDL_TRUE == core->show_menu)
+                else if ((core->swipe_v <= -0.1f) && (27 == core->state.current_index))
                 {
-                    switch (core->event.key.keysym.sym)
-                    {
-                        case SDLK_KP_ENTER:
-                        case SDLK_RETURN:
-                        case SDLK_SELECT:
-                        case SDLK_5:
-                        case SDLK_KP_5:
-                            switch (core->current_index)
-                            {
-                                case 25:
-                                    return EVENT_CONFIRM_NEW_GAME;
-                                case 26:
-                                    return EVENT_CONFIRM_LOAD_GAME;
-                                case 27:
-                                    switch (core->selected_mode)
-                                    {
-                                        default:
-                                        case MODE_NYT:
-                                            return EVENT_CONFIRM_NYT_MODE;
-                                        case MODE_ENDLESS:
-                                            return EVENT_CONFIRM_ENDLESS_MODE;
-                                    }
-                                case 28:
-                                    return EVENT_CONFIRM_SET_LANG;
-                                case 29:
-                                    return EVENT_QUIT;
-                                default:
-                                    break;
-                            }
-                            break;
-                        case SDLK_LEFT:
-                            return EVENT_MENU_PREV;
-                        case SDLK_RIGHT:
-                            return EVENT_MENU_NEXT;
-                        case SDLK_UP:
-                            if (27 == core->current_index)
-                            {
-                                return EVENT_MENU_SELECT_ENDLESS_MODE;
-                            }
-                            break;
-                        case SDLK_DOWN:
-                            if (27 == core->current_index)
-                            {
-                                return EVENT_MENU_SELECT_NYT_MODE;
-                            }
-                            break;
-#ifdef __SYMBIAN32__
-                        case SDLK_SOFTLEFT:
-                            return EVENT_MENU_SELECT_NEW_GAME;
-                        case SDLK_SOFTRIGHT:
-                            return EVENT_MENU_SELECT_QUIT;
-#endif
-                        case SDLK_AC_BACK:
-                        case SDLK_ESCAPE:
-                            SDL_StopTextInput();
-                            return EVENT_QUIT;
-                    }
+                    core->swipe_v = 0.f;
+                    input->type   = get_mode_event(SDL_TRUE, core);
                 }
-                else
+                else if ((input->text >= 100) && (input->text <= 1000))
                 {
-                    // Interpret key-presses while being not in the
-                    // menu.
-                    switch (core->event.key.keysym.sym)
-                    {
-                        case SDLK_2:
-                        case SDLK_KP_2:
-                            return EVENT_KEY_2;
-                        case SDLK_3:
-                        case SDLK_KP_3:
-                            return EVENT_KEY_3;
-                        case SDLK_4:
-                        case SDLK_KP_4:
-                            return EVENT_KEY_4;
-                        case SDLK_5:
-                        case SDLK_KP_5:
-                            return EVENT_KEY_5;
-                        case SDLK_6:
-                        case SDLK_KP_6:
-                            return EVENT_KEY_6;
-                        case SDLK_7:
-                        case SDLK_KP_7:
-                            return EVENT_KEY_7;
-                        case SDLK_8:
-                        case SDLK_KP_8:
-                            return EVENT_KEY_8;
-                        case SDLK_9:
-                        case SDLK_KP_9:
-                            return EVENT_KEY_9;
-                        case SDLK_0:
-                        case SDLK_KP_0:
-                            return EVENT_KEY_0;
-                        case SDLK_UP:
-                            return EVENT_NEXT_LETTER;
-                        case SDLK_DOWN:
-                            return EVENT_PREV_LETTER;
-                        case SDLK_KP_ENTER:
-                        case SDLK_RETURN:
-                        case SDLK_SELECT:
-                            return EVENT_CONFIRM;
-                        case SDLK_BACKSPACE:
-                        case SDLK_LEFT:
-                            return EVENT_DELETE_LETTER;
-                        case SDLK_RIGHT:
-                            return EVENT_CONFIRM_LETTER;
-                        case SDLK_AC_BACK:
-                        case SDLK_ESCAPE:
-#ifdef __SYMBIAN32__
-                        case SDLK_SOFTLEFT:
-                        case SDLK_SOFTRIGHT:
+                    input->type = get_confirm_event(core);
+                }
+            }
+            else if ((input->text >= 100) && (input->text <= 1000))
+            {
+                SDL_StartTextInput();
+            }
+            input->text = 0;
+            break;
 #endif
-                            SDL_StopTextInput();
-                            return EVENT_BACK;
-                    }
+        case EVENT_CONFIRM:
+            if (SDL_TRUE == core->state.show_menu)
+            {
+                input->type = get_confirm_event(core);
+            }
+            break;
+        case EVENT_NEXT_LETTER:
+        case EVENT_PREV_LETTER:
+            if (SDL_TRUE == core->state.show_menu)
+            {
+                SDL_bool next = (EVENT_NEXT_LETTER == input->type) ? SDL_TRUE : SDL_FALSE;
+
+                input->type = EVENT_NONE;
+                if (27 == core->state.current_index)
+                {
+                    input->type = get_mode_event(next, core);
                 }
-                break;
             }
-            case SDL_TEXTINPUT:
-                return EVENT_TEXTINPUT;
-                break;
-        }
+            break;
+        default:
+            break;
     }
 
-    return EVENT_NONE;
+    return (EVENT_NONE == input->type) ? SDL_FALSE : SDL_TRUE;
 }
 
-static void clear_tiles(SDL_bool clear_state, game_t* core)
+static event_t get_confirm_event(game_t* core)
 {
-    int index;
-
-    if (NULL == core)
-    {
-        return;
+    switch (core->state.current_index)
+    {
+        case 25:
+            return EVENT_CONFIRM_NEW_GAME;
+        case 26:
+            return EVENT_CONFIRM_LOAD_GAME;
+        case 27:
+            switch (core->state.selected_mode)
+            {
+                default:
+                case MODE_NYT:
+                    return EVENT_CONFIRM_NYT_MODE;
+                case MODE_ENDLESS:
+                    return EVENT_CONFIRM_ENDLESS_MODE;
+                case MODE_MULTI:
+                    return EVENT_CONFIRM_MULTI_MODE;
+                case MODE_ADVERSARIAL:
+                    return EVENT_CONFIRM_ADVERSARIAL_MODE;
+            }
+        case 28:
+            return EVENT_CONFIRM_SET_LANG;
+        case 29:
+            return EVENT_QUIT;
+        default:
+            return EVENT_NONE;
     }
+}
 
-    for (index = 0; index < 30; index += 1)
+// The game modes are ordered daily word, endless, adversarial and 2, 4
+// and 8 boards.
+static event_t get_mode_event(SDL_bool next, game_t* core)
+{
+    switch (core->state.selected_mode)
     {
-        core->tile[index].letter = 0;
-        if (SDL_TRUE == clear_state)
-        {
-            core->tile[index].state = LETTER_SELECT;
-        }
+        default:
+        case MODE_NYT:
+            return (SDL_TRUE == next) ? EVENT_MENU_SELECT_ENDLESS_MODE : EVENT_MENU_SELECT_NYT_MODE;
+        case MODE_ENDLESS:
+            return (SDL_TRUE == next) ? EVENT_MENU_SELECT_ADVERSARIAL_MODE : EVENT_MENU_SELECT_NYT_MODE;
+        case MODE_ADVERSARIAL:
+            return (SDL_TRUE == next) ? EVENT_MENU_SELECT_MULTI_MODE : EVENT_MENU_SELECT_ENDLESS_MODE;
+        case MODE_MULTI:
+            if (SDL_FALSE == next)
+            {
+                return EVENT_MENU_SELECT_ADVERSARIAL_MODE;
+            }
+            if (core->state.selected_boards >= MULTI_BOARD_MAX)
+            {
+                return EVENT_NONE;
+            }
+            return EVENT_MENU_SELECT_MULTI_MODE;
     }
 }
 
-static void delete_letter(game_t* core)
+static int draw_tiles(game_t* core)
 {
-    int lower_index_limit = 0;
-    int upper_index_limit = 0;
+    SDL_Rect src         = { 0, 0, 32, 32 };
+    SDL_Rect dst         = { 4, 2, 32, 32 };
+    int      index       = 0;
+    int      first_index = 0;
+    SDL_bool is_ngage    = SDL_FALSE;
+    SDL_bool show_boards = SDL_FALSE;
 
     if (NULL == core)
     {
-        return;
+        return 0;
     }
 
-    if (core->attempt >= 6)
+    if (NULL == core->tile_texture)
     {
-        return;
+        return 0;
     }
 
-    get_index_limits(&lower_index_limit, &upper_index_limit, core);
-
-    core->tile[core->current_index].letter  = 0;
-    core->current_index                    -= 1;
-    core->current_index                     = SDL_clamp(core->current_index, lower_index_limit, upper_index_limit);
-}
-
-static int draw_tiles(game_t* core)
-{
-    SDL_Rect src   = { 0, 0, 32, 32 };
-    SDL_Rect dst   = { 4 * core->zoom_factor, 2 * core->zoom_factor, 32 * core->zoom_factor, 32 * core->zoom_factor};
-    int      index = 0;
-    int      count = 0;
+    // In multi-board mode, the boards replace the first five rows.
+    if ((0 != core->state.multi.board_count) && (SDL_FALSE == core->state.show_menu))
+    {
+        show_boards = SDL_TRUE;
+        first_index = 25;
+    }
 
-    if (NULL == core)
+    if (show_boards != core->show_boards)
     {
-        return 0;
+        core->show_boards       = show_boards;
+        core->invalidate_boards = SDL_TRUE;
     }
 
-    if (NULL == core->render_target)
+#ifdef USE_FRAMEBUFFER
+    if (0 != fb_begin(core))
     {
-        return 0;
+        return 1;
     }
 
-    if (NULL == core->tile_texture)
+    if ((SDL_TRUE == core->invalidate_tiles) || (SDL_TRUE == core->invalidate_boards))
+    {
+        fb_clear(core);
+        SDL_memset(core->tile_cache, 0xff, sizeof(core->tile_cache));
+        SDL_memset(core->board_cache, 0xff, sizeof(core->board_cache));
+        core->invalidate_tiles  = SDL_FALSE;
+        core->invalidate_boards = SDL_FALSE;
+    }
+#else
+    if (NULL == core->render_target)
     {
         return 0;
     }
@@ -1164,11 +953,32 @@ static int draw_tiles(game_t* core)
     {
         return 1;
     }
-    SDL_RenderClear(core->renderer);
 
-    for (index = 0; index < 30; index += 1)
+    // The boards stay on the render target between frames.
+    if ((SDL_FALSE == show_boards) || (SDL_TRUE == core->invalidate_boards))
     {
-        static SDL_bool is_ngage = SDL_FALSE;
+        SDL_RenderClear(core->renderer);
+        SDL_memset(core->board_cache, 0xff, sizeof(core->board_cache));
+        core->invalidate_boards = SDL_FALSE;
+    }
+    else
+    {
+        SDL_Rect input_row = { 0, 172, WINDOW_WIDTH, 34 };
+
+        SDL_SetRenderDrawColor(core->renderer, 0xff, 0xff, 0xff, 0x00);
+        SDL_RenderFillRect(core->renderer, &input_row);
+    }
+#endif
+
+    if (SDL_TRUE == show_boards)
+    {
+        draw_boards(core);
+    }
+
+    for (index = first_index; index < 30; index += 1)
+    {
+        dst.x = 4 + ((index % 5) * 34);
+        dst.y = 2 + ((index / 5) * 34);
 
         if ((0 == index) || (0 == (index % 5)))
         {
@@ -1178,7 +988,7 @@ static int draw_tiles(game_t* core)
 
             for (letter_index = 0; letter_index < 5; letter_index += 1)
             {
-                check_pattern[letter_index] = core->tile[index + letter_index].letter;
+                check_pattern[letter_index] = core->state.tile[index + letter_index].letter;
             }
 
             if (hash_ngage == generate_hash(check_pattern))
@@ -1189,54 +999,10 @@ static int draw_tiles(game_t* core)
 
         if (SDL_FALSE == is_ngage)
         {
-            switch(core->tile[index].state)
+            switch (core->state.tile[index].letter)
             {
                 default:
-                case LETTER_SELECT:
-                    src.x = 0;
-                    src.y = 0;
-                    break;
-                case CORRECT_LETTER:
-                    src.x = 0;
-                    src.y = 96;
-                    break;
-                case WRONG_LETTER:
-                    src.x = 0;
-                    src.y = 32;
-                    break;
-                case WRONG_POSITION:
-                    src.x = 0;
-                    src.y = 64;
-                    break;
-            }
-
-            // Special characters.
-            if (SDL_FALSE == core->wordlist.is_cyrillic)
-            {
-                switch (core->tile[index].letter)
-                {
-                    case 0xc4: // Ä
-                        src.x = 864;
-                        break;
-                    case 0xd6: // Ö
-                        src.x = 896;
-                        break;
-                    case 0xdc: // Ü
-                        src.x = 928;
-                        break;
-                    case 0xdf: // ß
-                        src.x = 960;
-                        break;
-                }
-            }
-
-            switch (core->tile[index].letter)
-            {
-                case 0x00: // Empty tile
-                    src.x = 0;
-                    break;
-                case 0x2d: // Hyphen
-                    src.x = 992;
+                    get_letter_source(core->state.tile[index].letter, core->state.tile[index].state, &src, core);
                     break;
                 case 0x01: // New game icon
                     src.x = 0;
@@ -1249,18 +1015,20 @@ static int draw_tiles(game_t* core)
                 case 0x03: // Game mode icon
                     src.x = 1056;
 
-                    switch(core->selected_mode)
+                    switch(core->state.selected_mode)
                     {
                         default:
                         case MODE_NYT:
                             src.y = 64;
                             break;
                         case MODE_ENDLESS:
+                        case MODE_MULTI:
+                        case MODE_ADVERSARIAL:
                             src.y = 0;
                             break;
                     }
 
-                    if (27 == core->current_index)
+                    if (27 == core->state.current_index)
                     {
                         src.y += 32;
                     }
@@ -1275,7 +1043,7 @@ static int draw_tiles(game_t* core)
                     break;
                 case 0x06: // Flag icon
                     src.x = 1056;
-                    switch (core->wordlist.language)
+                    switch (core->state.wordlist.language)
                     {
                         default:
                         case LANG_ENGLISH:
@@ -1293,30 +1061,11 @@ static int draw_tiles(game_t* core)
                     }
                     break;
             }
-
-            if (SDL_TRUE == core->wordlist.is_cyrillic &&
-                0x00     != core->tile[index].letter   &&
-                0x2d     != core->tile[index].letter   &&
-                0x01     != core->tile[index].letter   &&
-                0x02     != core->tile[index].letter   &&
-                0x03     != core->tile[index].letter   &&
-                0x04     != core->tile[index].letter   &&
-                0x05     != core->tile[index].letter   &&
-                0x06     != core->tile[index].letter)
-            {
-                src.y += 128;
-            }
-
-            if (core->tile[index].letter >= core->wordlist.first_letter && core->tile[index].letter <= core->wordlist.last_letter)
-            {
-                src.x  = (core->tile[index].letter - core->wordlist.first_letter) * 32;
-                src.x += 32;
-            }
         }
         else
         {
             src.x = 1024;
-            switch(core->tile[index].letter)
+            switch(core->state.tile[index].letter)
             {
                 case 'N':
                     src.y = 0;
@@ -1334,13 +1083,32 @@ static int draw_tiles(game_t* core)
             }
         }
 
+#ifdef USE_FRAMEBUFFER
+        {
+            // Only tiles that look different from what is already on
+            // screen are drawn and updated.
+            Uint32 tile_key = ((Uint32)src.x << 16) | ((Uint32)src.y << 1) | (index == core->state.current_index);
+
+            if (tile_key == core->tile_cache[index])
+            {
+                continue;
+            }
+            core->tile_cache[index] = tile_key;
+        }
+
+        fb_blit(core->tile_texture, &src, &dst, core);
+#else
+        CHECK_BLIT_FORMAT(core->tile_texture, core);
         SDL_RenderCopy(core->renderer, core->tile_texture, &src, &dst);
+#endif
 
-        if (index == core->current_index)
+        if (index == core->state.current_index)
         {
             unsigned int frame_count = 0;
+#ifndef USE_FRAMEBUFFER
             SDL_SetRenderDrawColor(core->renderer, 0xf5, 0x79, 0x3a, 0x00);
-            for (frame_count = 0; frame_count < (core->zoom_factor * 2); frame_count += 1)
+#endif
+            for (frame_count = 0; frame_count < 2; frame_count += 1)
             {
                 SDL_Rect inner_frame = {
                     (dst.x + frame_count),
@@ -1348,459 +1116,576 @@ static int draw_tiles(game_t* core)
                     (dst.w - (frame_count * 2)),
                     (dst.h - (frame_count * 2))
                 };
+#ifdef USE_FRAMEBUFFER
+                fb_draw_rect(&inner_frame, 0xf5, 0x79, 0x3a, core);
+#else
                 SDL_RenderDrawRect(core->renderer, &inner_frame);
+#endif
             }
         }
+    }
 
-        dst.x += (34 * core->zoom_factor);
-        count += 1;
+    return 0;
+}
 
-        if (count > 4)
+// Draws the boards whose rows have changed since they were last drawn,
+// scaled down from the regular tiles.  Once the game has ended, the
+// answers of the unsolved boards are shown below them.
+static void draw_boards(game_t* core)
+{
+    multi_board_t* multi     = &core->state.multi;
+    SDL_bool       has_ended = multi_board_has_ended(multi);
+    Uint8          board_index;
+
+    for (board_index = 0; board_index < multi->board_count; board_index += 1)
+    {
+        board_t* board = &multi->board[board_index];
+        Uint8    rows  = (0 != board->solved_rows) ? board->solved_rows : multi->attempt;
+        Uint16   key   = rows;
+        SDL_Rect rect;
+        SDL_Rect src   = { 0, 0, 32, 32 };
+        SDL_Rect dst;
+        int      cell_size;
+        Uint8    row;
+        int      letter_index;
+
+        if ((SDL_TRUE == has_ended) && (0 == board->solved_rows))
         {
-            count  = 0;
-            dst.x  = (4  * core->zoom_factor);
-            dst.y += (34 * core->zoom_factor);
+            key |= 0x100;
         }
-    }
 
-    return 0;
+        if (key == core->board_cache[board_index])
+        {
+            continue;
+        }
+        core->board_cache[board_index] = key;
+
+        get_board_rect(board_index, &rect, &cell_size, core);
+
+#ifdef USE_FRAMEBUFFER
+        fb_fill_rect(&rect, 0xff, 0xff, 0xff, core);
+#else
+        SDL_SetRenderDrawColor(core->renderer, 0xff, 0xff, 0xff, 0x00);
+        SDL_RenderFillRect(core->renderer, &rect);
+#endif
+
+        dst.w = cell_size - 1;
+        dst.h = cell_size - 1;
+
+        // Solved boards end with the solving row, unsolved ones show
+        // the remaining attempts as empty rows.
+        for (row = 0; row <= multi->row_count; row += 1)
+        {
+            const unsigned char  empty[5]  = { 0 };
+            const unsigned char* letters   = empty;
+            state_t              result[5] = { LETTER_SELECT, LETTER_SELECT, LETTER_SELECT, LETTER_SELECT, LETTER_SELECT };
+
+            if (row < rows)
+            {
+                letters = multi->guess[row];
+                get_pattern_states(board->pattern[row], result);
+            }
+            else if (0 != board->solved_rows)
+            {
+                break;
+            }
+            else if (row == multi->row_count)
+            {
+                if (0 == (key & 0x100))
+                {
+                    break;
+                }
+                letters = core->state.wordlist.list[board->answer_index];
+            }
+
+            for (letter_index = 0; letter_index < 5; letter_index += 1)
+            {
+                get_letter_source(letters[letter_index], result[letter_index], &src, core);
+
+                dst.x = rect.x + (letter_index * cell_size);
+                dst.y = rect.y + (row * cell_size);
+
+#ifdef USE_FRAMEBUFFER
+                fb_blit_scaled(core->tile_texture, &src, &dst, core);
+#else
+                CHECK_BLIT_FORMAT(core->tile_texture, core);
+                SDL_RenderCopy(core->renderer, core->tile_texture, &src, &dst);
+#endif
+            }
+        }
+    }
 }
 
-static void get_index_limits(int* lower_limit, int* upper_limit, game_t* core)
+static void draw_osd(game_t* core)
 {
-    if (NULL == core)
+#ifdef USE_FRAMEBUFFER
+    core->osd_count = 0;
+    core->osd_hash  = 0x811c9dc5;
+#endif
+
+    if (SDL_TRUE == core->state.show_stats)
     {
-        return;
+        char stats[16]   = { 0 };
+        int  stats_pos_x = 64;
+
+        if (game_state_daily_index(&core->state) >= 1000)
+        {
+            stats_pos_x = 57;
+        }
+
+        stbsp_snprintf(stats, 16, "Wordle %u %1u/6", game_state_daily_index(&core->state), core->state.nyt_final_attempt);
+        osd_print(stats, stats_pos_x, 12, core);
+        print_stats(core);
+        print_bot_analysis(core);
     }
 
-    switch (core->attempt)
+    if (0 != core->state.suggestion_count)
     {
-        default:
-        case 0:
-            *lower_limit = 0;
-            *upper_limit = 4;
-            break;
-        case 1:
-            *lower_limit = 5;
-            *upper_limit = 9;
-            break;
-        case 2:
-            *lower_limit = 10;
-            *upper_limit = 14;
-            break;
-        case 3:
-            *lower_limit = 15;
-            *upper_limit = 19;
-            break;
-        case 4:
-            *lower_limit = 20;
-            *upper_limit = 24;
-            break;
-        case 5:
-            *lower_limit = 25;
-            *upper_limit = 29;
-            break;
+        print_suggestions(core);
     }
-}
 
-static void go_back_to_menu(game_t* core)
-{
-    SDL_StopTextInput();
-    game_save(core);
-    clear_tiles(SDL_TRUE, core);
-    core->current_index = 27;
-    set_language(core->wordlist.language, SDL_TRUE, core);
+    // Modes sharing the endless mode icon are labelled.
+    if (SDL_TRUE == core->state.show_menu)
+    {
+        char mode_label[4] = { 0 };
+
+        switch (core->state.selected_mode)
+        {
+            case MODE_MULTI:
+                stbsp_snprintf(mode_label, 4, "%u", core->state.selected_boards);
+                osd_print(mode_label, 94, 192, core);
+                break;
+            case MODE_ADVERSARIAL:
+                osd_print("A", 94, 192, core);
+                break;
+            default:
+                break;
+        }
+    }
 }
 
-static void goto_next_letter(game_t* core)
+#ifdef USE_FRAMEBUFFER
+// Clears the text on screen if it differs from the text just drawn and
+// marks the tiles and boards it covered for redrawing.  Returns
+// SDL_TRUE if it did.
+static SDL_bool restore_osd(game_t* core)
 {
-    int lower_index_limit = 0;
-    int upper_index_limit = 0;
+    int   rect_index;
+    int   index;
+    Uint8 board_index;
 
-    if (NULL == core)
+    if ((core->osd_hash == core->shown_osd_hash) && (core->osd_count == core->shown_osd_count))
     {
-        return;
+        return SDL_FALSE;
     }
 
-    if (core->attempt >= 6)
+    // Too much text to keep track of.
+    if ((core->osd_count > FB_MAX_OSD_RECTS) || (core->shown_osd_count > FB_MAX_OSD_RECTS))
     {
-        return;
+        core->invalidate_tiles = SDL_TRUE;
     }
 
-    get_index_limits(&lower_index_limit, &upper_index_limit, core);
-
-    if (core->tile[core->current_index].letter != 0)
+    for (rect_index = 0; (rect_index < core->shown_osd_count) && (rect_index < FB_MAX_OSD_RECTS); rect_index += 1)
     {
-        core->current_index                    += 1;
-        core->current_index                     = SDL_clamp(core->current_index, lower_index_limit, upper_index_limit);
-        core->tile[core->current_index].letter  = 0;
+        const SDL_Rect* osd_rect = &core->shown_osd_rect[rect_index];
+
+        fb_fill_rect(osd_rect, 0xff, 0xff, 0xff, core);
+
+        for (index = 0; index < 30; index += 1)
+        {
+            SDL_Rect tile = { 0, 0, 32, 32 };
+
+            tile.x = 4 + ((index % 5) * 34);
+            tile.y = 2 + ((index / 5) * 34);
+
+            if (SDL_TRUE == SDL_HasIntersection(osd_rect, &tile))
+            {
+                core->tile_cache[index] = 0xffffffff;
+            }
+        }
+
+        for (board_index = 0; (SDL_TRUE == core->show_boards) && (board_index < core->state.multi.board_count); board_index += 1)
+        {
+            SDL_Rect board;
+            int      cell_size;
+
+            get_board_rect(board_index, &board, &cell_size, core);
+            if (SDL_TRUE == SDL_HasIntersection(osd_rect, &board))
+            {
+                core->board_cache[board_index] = 0xffff;
+            }
+        }
     }
+
+    SDL_memcpy(core->shown_osd_rect, core->osd_rect, sizeof(core->osd_rect));
+    core->shown_osd_count = core->osd_count;
+    core->shown_osd_hash  = core->osd_hash;
+
+    return SDL_TRUE;
 }
+#endif
 
-static SDL_bool has_game_ended(game_t* core)
+// Boards are laid out in up to four columns and two rows above the
+// input row, with one spare row for the answer.
+static void get_board_rect(Uint8 board_index, SDL_Rect* rect, int* cell_size, game_t* core)
 {
-    SDL_bool is_won = SDL_FALSE;
-    validate_current_guess(&is_won, core);
-
-    if ((SDL_TRUE == core->nyt_mode) && (core->nyt_has_ended))
-    {
-        return SDL_TRUE;
-    }
+    int columns    = (core->state.multi.board_count > 4) ? 4 : 2;
+    int lines      = (core->state.multi.board_count + columns - 1) / columns;
+    int slot_w     = WINDOW_WIDTH / columns;
+    int slot_h     = 170 / lines;
+    int rows       = core->state.multi.row_count + 1;
 
-    if ((SDL_TRUE == is_won) || (SDL_FALSE == is_won && 5 == core->attempt))
+    *cell_size = (slot_w - 4) / 5;
+    if ((slot_h - 4) / rows < *cell_size)
     {
-        return SDL_TRUE;
+        *cell_size = (slot_h - 4) / rows;
     }
 
-    return SDL_FALSE;
+    rect->w = *cell_size * 5;
+    rect->h = *cell_size * rows;
+    rect->x = ((board_index % columns) * slot_w) + ((slot_w - rect->w) / 2);
+    rect->y = ((board_index / columns) * slot_h) + ((slot_h - rect->h) / 2);
 }
 
-static void move_rows_up(game_t* core)
+// Selects the tile of a letter in the given state.
+static void get_letter_source(unsigned char letter, state_t state, SDL_Rect* src, game_t* core)
 {
-    int counter;
-    int tile_index;
-    for (counter = 0; counter < 5; counter += 1)
+    src->x = 0;
+
+    switch (state)
     {
-        for (tile_index = 1; tile_index < 30; tile_index += 1)
+        default:
+        case LETTER_SELECT:
+            src->y = 0;
+            break;
+        case CORRECT_LETTER:
+            src->y = 96;
+            break;
+        case WRONG_LETTER:
+            src->y = 32;
+            break;
+        case WRONG_POSITION:
+            src->y = 64;
+            break;
+    }
+
+    // Special characters.
+    if (SDL_FALSE == core->state.wordlist.is_cyrillic)
+    {
+        switch (letter)
         {
-            core->tile[tile_index - 1].letter       = core->tile[tile_index].letter;
-            core->tile[tile_index - 1].letter_index = core->tile[tile_index].letter_index;
-            core->tile[tile_index - 1].state        = core->tile[tile_index].state;
+            case 0xc4: // Ä
+                src->x = 864;
+                break;
+            case 0xd6: // Ö
+                src->x = 896;
+                break;
+            case 0xdc: // Ü
+                src->x = 928;
+                break;
+            case 0xdf: // ß
+                src->x = 960;
+                break;
         }
     }
-}
 
-static void reset_game(SDL_bool nyt_mode, game_t* core)
-{
-    if (NULL == core)
+    if (0x2d == letter) // Hyphen
     {
-        return;
+        src->x = 992;
+    }
+    else if (SDL_TRUE == core->state.wordlist.is_cyrillic && 0x00 != letter)
+    {
+        src->y += 128;
     }
 
-    clear_tiles(SDL_TRUE, core);
+    if (letter >= core->state.wordlist.first_letter && letter <= core->state.wordlist.last_letter)
+    {
+        src->x  = (letter - core->state.wordlist.first_letter) * 32;
+        src->x += 32;
+    }
+}
 
-    core->attempt       = 0;
-    core->current_index = 0;
-    core->show_menu     = SDL_FALSE;
+// The tree is optional: without it, or if it was built for another
+// word list, the analysis is not shown.
+static void load_decision_tree(game_t* core)
+{
+    SDL_RWops* tree_file = open_binary_file_from_path(&core->pfs, "tree.bin");
+    Uint8      header[DECISION_TREE_HEADER_SIZE];
+    wordlist_t wordlist;
+    Uint32     node_count;
 
-    if (SDL_TRUE == core->show_stats)
+    if (NULL == tree_file)
     {
-        core->show_stats = SDL_FALSE;
-        draw_tiles(core);
+        return;
     }
 
-    if (SDL_FALSE == nyt_mode)
+    load_wordlist(LANG_ENGLISH, &wordlist);
+
+    if (1 == SDL_RWread(tree_file, header, sizeof(header), 1))
     {
-        core->valid_answer_index = xorshift(&core->seed) % core->wordlist.word_count;
-        while (core->valid_answer_index > core->wordlist.word_count)
+        node_count = decision_tree_check(header, &wordlist);
+        if (0 != node_count)
         {
-            core->valid_answer_index = xorshift(&core->seed) % core->wordlist.word_count;
+            core->decision_tree = (Uint8*)SDL_malloc(node_count * DECISION_TREE_NODE_SIZE);
+            if (NULL != core->decision_tree)
+            {
+                if (1 == SDL_RWread(tree_file, core->decision_tree, node_count * DECISION_TREE_NODE_SIZE, 1))
+                {
+                    core->decision_tree_nodes = node_count;
+                }
+                else
+                {
+                    SDL_free(core->decision_tree);
+                    core->decision_tree = NULL;
+                }
+            }
         }
-        core->nyt_mode = SDL_FALSE;
     }
-    else
+
+    SDL_RWclose(tree_file);
+}
+
+// From the arena, see arena.c.
+static int load_textures(game_t* core)
+{
+    int status;
+
+    status = load_texture_from_file((const char*)"tiles.png", &core->tile_texture, core);
+    if (0 != status)
+    {
+        return status;
+    }
+
+#ifdef __ANDROID__
+    status = load_texture_from_file((const char*)"disclaimer.png", &core->disclaimer_texture, core);
+    if (0 != status)
     {
-        set_language(LANG_ENGLISH, SDL_FALSE, core);
-        core->valid_answer_index = get_nyt_daily_index();
-        core->nyt_mode           = SDL_TRUE;
+        return status;
     }
-    SDL_StartTextInput();
+#endif
+
+    return osd_init(core);
 }
 
-static void select_next_letter(const unsigned char start_char, const unsigned char end_char, game_t* core)
+// Shows how the bot would have solved the daily word, below the stats.
+static void print_bot_analysis(game_t* core)
 {
-    unsigned char* current_letter = &core->tile[core->current_index].letter;
+    unsigned char answer[6] = { 0 };
+    unsigned char guess[6][6];
+    char          summary[8] = { 0 };
+    Uint8         attempts;
+    Uint8         index;
 
-    if (core->attempt >= 6)
+    if (NULL == core->decision_tree || LANG_ENGLISH != core->state.wordlist.language)
     {
         return;
     }
 
-    if (*current_letter >= start_char && *current_letter < end_char)
+    get_valid_answer(answer, &core->state);
+    attempts = decision_tree_walk(core->decision_tree, core->decision_tree_nodes, answer, &core->state.wordlist, guess);
+    if (0 == attempts)
     {
-        *current_letter += 1;
+        return;
     }
-    else
+
+    stbsp_snprintf(summary, 8, "Bot %1u/6", attempts);
+    osd_print(summary, 123, 26, core);
+
+    for (index = 0; index < attempts; index += 1)
     {
-        *current_letter = start_char;
+        osd_print((const char*)guess[index], 137, 40 + (index * 12), core);
     }
 }
 
-static void select_previous_letter(const unsigned char start_char, const unsigned char end_char, game_t* core)
+// Shows the daily statistics: the games won with each number of
+// guesses next to the rows, and the totals below.
+static void print_stats(game_t* core)
 {
-    unsigned char* current_letter = &core->tile[core->current_index].letter;
+    const stats_summary_t* summary  = &core->state.stats.summary[MODE_NYT];
+    char                   text[24] = { 0 };
+    int                    length;
+    int                    index;
 
-    if (core->attempt >= 6)
+    if (0 == summary->played)
     {
         return;
     }
 
-    if (0 == *current_letter)
+    for (index = 0; index < 6; index += 1)
     {
-        *current_letter = start_char;
+        stbsp_snprintf(text, 24, "%u", summary->distribution[index]);
+        osd_print(text, 6, 2 + (index * 34) + 3, core);
     }
 
-    *current_letter -= 1;
+    length = stbsp_snprintf(text, 24, "Streak %u Max %u",
+                            stats_get_streak(&core->state.stats, MODE_NYT, game_state_day(&core->state)),
+                            summary->max_streak);
+    osd_print(text, (WINDOW_WIDTH - ((length * 7) + 2)) / 2, 180, core);
 
-    if (*current_letter < start_char)
-    {
-        *current_letter = end_char;
-    }
+    length = stbsp_snprintf(text, 24, "Played %u Won %u%%", summary->played, stats_get_win_rate(&core->state.stats, MODE_NYT));
+    osd_print(text, (WINDOW_WIDTH - ((length * 7) + 2)) / 2, 194, core);
 }
 
-static void select_utf8_letter(const Uint16 *text, game_t* core)
+// Shows the closest allowed words after a guess was rejected, next to
+// the row of the guess.
+static void print_suggestions(game_t* core)
 {
-    unsigned char* current_letter  = (unsigned char*)&core->tile[core->current_index].letter;
-    unsigned char  selected_letter = 0;
-    SDL_bool       is_alpha        = SDL_FALSE;
+    char text[32] = { 0 };
+    int  length   = 0;
+    int  row      = (core->state.current_index < 0) ? 5 : (core->state.current_index / 5);
+    int  pos_y;
+    int  index;
 
-    switch(*text)
+    for (index = 0; index < core->state.suggestion_count; index += 1)
     {
-        case 0xa4c3: // ä
-        case 0x84c3: // Ä
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xc4;
-            break;
-        case 0xb6c3: // ö
-        case 0x96c3: // Ö
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xd6;
-            break;
-        case 0xbcc3: // ü
-        case 0x9cc3: // Ü
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xdc;
-            break;
-        case 0x9fc3: // ß
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xdf;
-            break;
-        case 0xb0d0: // а
-        case 0x90d0: // А
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xc0;
-            break;
-        case 0xb1d0: // б
-        case 0x91d0: // Б
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xc1;
-            break;
-        case 0xb2d0: // в
-        case 0x92d0: // В
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xc2;
-            break;
-        case 0xb3d0: // г
-        case 0x93d0: // Г
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xc3;
-            break;
-        case 0xb4d0: // д
-        case 0x94d0: // Д
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xc4;
-            break;
-        case 0xb5d0: // е
-        case 0x95d0: // Е
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xc5;
-            break;
-        case 0xb6d0: // ж
-        case 0x96d0: // Ж
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xc6;
-            break;
-        case 0xb7d0: // з
-        case 0x97d0: // З
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xc7;
-            break;
-        case 0xb8d0: // и
-        case 0x98d0: // И
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xc8;
-            break;
-        case 0xb9d0: // й
-        case 0x99d0: // Й
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xc9;
-            break;
-        case 0xbad0: // к
-        case 0x9ad0: // К
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xca;
-            break;
-        case 0xbbd0: // л
-        case 0x9bd0: // Л
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xcb;
-            break;
-        case 0xbcd0: // м
-        case 0x9cd0: // М
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xcc;
-            break;
-        case 0xbdd0: // н
-        case 0x9dd0: // Н
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xcd;
-            break;
-        case 0xbed0: // о
-        case 0x9ed0: // О
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xce;
-            break;
-        case 0xbfd0: // п
-        case 0x9fd0: // П
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xcf;
-            break;
-        case 0x80d1: // р
-        case 0xa0d0: // Р
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xd0;
-            break;
-        case 0x81d1: // с
-        case 0xa1d0: // С
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xd1;
-            break;
-        case 0x82d1: // т
-        case 0xa2d0: // Т
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xd2;
-            break;
-        case 0x83d1: // у
-        case 0xa3d0: // У
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xd3;
-            break;
-        case 0x84d1: // ф
-        case 0xa4d0: // Ф
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xd4;
-            break;
-        case 0x85d1: // х
-        case 0xa5d0: // Х
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xd5;
-            break;
-        case 0x86d1: // ц
-        case 0xa6d0: // Ц
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xd6;
-            break;
-        case 0x87d1: // ч
-        case 0xa7d0: // Ч
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xd7;
-            break;
-        case 0x88d1: // ш
-        case 0xa8d0: // Ш
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xd8;
-            break;
-        case 0x89d1: // щ
-        case 0xa9d0: // Щ
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xd9;
-            break;
-        case 0x8ad1: // ъ
-        case 0xaad0: // Ъ
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xda;
-            break;
-        case 0x8bd1: // ы
-        case 0xabd0: // Ы
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xdb;
-            break;
-        case 0x8cd1: // ь
-        case 0xacd0: // Ь
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xdc;
-            break;
-        case 0x8dd1: // э
-        case 0xadd0: // Э
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xdd;
-            break;
-        case 0x8ed1: // ю
-        case 0xaed0: // Ю
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xde;
-            break;
-        case 0x8fd1: // я
-        case 0xafd0: // Я
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0xdf;
-            break;
-        case 0x2d: // -
-            is_alpha        = SDL_TRUE;
-            selected_letter = 0x2d;
-            break;
-        default:
-            if (SDL_isalpha(*text))
-            {
-                is_alpha        = SDL_TRUE;
-                selected_letter = (unsigned char)SDL_toupper(*text);
-            }
+        const unsigned char* word = get_guess_word(&core->state.wordlist, core->state.suggestion[index]);
+        char                 word_text[16];
+        int                  word_length;
+
+        if (NULL == word)
+        {
+            continue;
+        }
+
+        word_length = transliterate_word(word, word_text, sizeof(word_text), core);
+
+        // At most 24 characters fit on the screen.
+        if (length + word_length + 1 > 24)
+        {
             break;
-    }
+        }
 
-    if (SDL_TRUE == core->wordlist.is_cyrillic)
-    {
-        if (((selected_letter < 0xc0) || (selected_letter > 0xdf)) && (selected_letter != 0x2d))
+        if (0 != length)
         {
-            // Only accept cyrillic letters and hypen in cyrillic
-            // wordlists.
-            return;
+            text[length] = ' ';
+            length      += 1;
         }
+
+        SDL_memcpy(&text[length], word_text, word_length);
+        length       += word_length;
+        text[length]  = '\0';
+    }
+
+    if (0 == length)
+    {
+        return;
+    }
+
+    if (row < 5)
+    {
+        pos_y = 2 + ((row + 1) * 34) + 1;
     }
     else
     {
-        if (((selected_letter >= 0xc0) && (selected_letter <= 0xdf)))
-        {
-            // Do not accept cyrillic letters in non-cyrillic wordlists.
-            return;
-        }
+        pos_y = 2 + (row * 34) - 13;
     }
 
-    *current_letter = selected_letter;
+    osd_print(text, (WINDOW_WIDTH - ((length * 7) + 2)) / 2, pos_y, core);
+
+    // The boards below the text are not cleared on every frame.
+    core->invalidate_boards = SDL_TRUE;
+}
+
+// The font only covers ASCII, so other letters are spelled out.
+// Returns the length of the text.
+static int transliterate_word(const unsigned char* word, char* text, int size, game_t* core)
+{
+    static const char* cyrillic[32] =
+    {
+        "A", "B", "V", "G", "D", "E", "ZH", "Z", "I", "J", "K", "L", "M", "N", "O", "P",
+        "R", "S", "T", "U", "F", "KH", "TS", "CH", "SH", "SHCH", "\"", "Y", "'", "E", "YU", "YA"
+    };
+    int length = 0;
+    int index;
 
-    if (0 != ((core->current_index + 1) % 5))
+    for (index = 0; index < 5; index += 1)
     {
-        if (SDL_TRUE == is_alpha)
+        const char* letter;
+        char        ascii[2] = { 0 };
+        size_t      letter_length;
+
+        if (SDL_TRUE == core->state.wordlist.is_cyrillic && word[index] >= 0xc0 && word[index] <= 0xdf)
         {
-            core->current_index++;
+            letter = cyrillic[word[index] - 0xc0];
+        }
+        else
+        {
+            switch (word[index])
+            {
+                case 0xc4: // Ä
+                    letter = "AE";
+                    break;
+                case 0xd6: // Ö
+                    letter = "OE";
+                    break;
+                case 0xdc: // Ü
+                    letter = "UE";
+                    break;
+                case 0xdf: // ß
+                    letter = "SS";
+                    break;
+                default:
+                    ascii[0] = (char)word[index];
+                    letter   = ascii;
+                    break;
+            }
         }
+
+        letter_length = SDL_strlen(letter);
+        if (length + (int)letter_length >= size)
+        {
+            break;
+        }
+
+        SDL_memcpy(&text[length], letter, letter_length);
+        length += (int)letter_length;
     }
+
+    text[length] = '\0';
+
+    return length;
+}
+
+static size_t read_save(SDL_bool daily, void* buffer, size_t size, void* user_data)
+{
+    return storage_read_save(daily, buffer, size, (game_t*)user_data);
+}
+
+// The save states are encoded by the core, see save.c, so the files
+// can be moved between platforms.  Writing them is deferred, see
+// storage.c.
+static void write_save(SDL_bool daily, const void* buffer, size_t size, void* user_data)
+{
+    storage_write_save(daily, buffer, size, (game_t*)user_data);
 }
 
-static void show_results(game_t* core)
+static size_t read_stats(lang_t language, Uint32 offset, void* buffer, size_t size, void* user_data)
 {
-    unsigned char valid_answer[6] = { 0 };
+    return storage_read_stats(language, offset, buffer, size, (game_t*)user_data);
+}
 
-    get_valid_answer(valid_answer, core);
-    clear_tiles(SDL_FALSE, core);
+static void append_stats(lang_t language, const void* buffer, size_t size, void* user_data)
+{
+    storage_append_stats(language, buffer, size, (game_t*)user_data);
+}
 
-    if (SDL_TRUE == core->nyt_mode)
+static void write_stats_header(lang_t language, const void* buffer, size_t size, void* user_data)
+{
+    storage_write_stats_header(language, buffer, size, (game_t*)user_data);
+}
+
+static void set_text_input(SDL_bool enabled, void* user_data)
+{
+    (void)user_data;
+
+    if (SDL_TRUE == enabled)
     {
-        core->show_stats = SDL_TRUE;
+        SDL_StartTextInput();
     }
     else
     {
-        unsigned int start_index = core->attempt * 5;
-
-        core->tile[start_index].letter     = valid_answer[0];
-        core->tile[start_index + 1].letter = valid_answer[1];
-        core->tile[start_index + 2].letter = valid_answer[2];
-        core->tile[start_index + 3].letter = valid_answer[3];
-        core->tile[start_index + 4].letter = valid_answer[4];
+        SDL_StopTextInput();
     }
-
-    core->attempt       = 6;
-    core->current_index = -1;
 }
 
 static void set_zoom_factor(game_t* core)
@@ -1809,7 +1694,8 @@ static void set_zoom_factor(game_t* core)
 
     core->zoom_factor = 1u;
 
-#if __SYMBIAN32__
+#if defined __SYMBIAN32__ || defined USE_FRAMEBUFFER
+    // The N-Gage and the framebuffer backend draw at native size.
     return;
 #endif
 
@@ -1829,20 +1715,6 @@ static void set_zoom_factor(game_t* core)
     }
 }
 
-static void set_render_offset(game_t* core)
-{
-    SDL_DisplayMode display_mode;
-
-    if (0 == SDL_GetCurrentDisplayMode(0, &display_mode))
-    {
-        core->render_offset_x = (display_mode.w / 2) - ((WINDOW_WIDTH  * core->zoom_factor) / 2);
-        core->render_offset_y = (display_mode.h / 2) - ((WINDOW_HEIGHT * core->zoom_factor) / 2);
-        #if __ANDROID__
-        core->render_offset_y /= 2;
-        #endif
-    }
-}
-
 static void toggle_fullscreen(game_t* core)
 {
     if(core->is_fullscreen)
@@ -1853,9 +1725,7 @@ static void toggle_fullscreen(game_t* core)
         }
         else
         {
-            core->render_offset_x = 0;
-            core->render_offset_y = 0;
-            core->is_fullscreen   = !core->is_fullscreen;
+            core->is_fullscreen = !core->is_fullscreen;
         }
     }
     else
@@ -1866,9 +1736,7 @@ static void toggle_fullscreen(game_t* core)
         }
         else
         {
-            set_render_offset(core);
             core->is_fullscreen = !core->is_fullscreen;
-            set_zoom_factor(core);
         }
     }
 }
@@ -11,158 +11,171 @@
 #define GAME_H
 
 #include "SDL.h"
-
-#ifndef SAVE_VERSION
-#define SAVE_VERSION 3
-#endif
+#include "game_core.h"
 
 #define WINDOW_WIDTH  176u
 #define WINDOW_HEIGHT 208u
 
-typedef enum
-{
-    LETTER_SELECT = 0,
-    CORRECT_LETTER,
-    WRONG_LETTER,
-    WRONG_POSITION,
+#ifndef FB_MAX_DIRTY_RECTS
+#define FB_MAX_DIRTY_RECTS 32
+#endif
 
-} state_t;
+#ifndef FB_MAX_OSD_RECTS
+#define FB_MAX_OSD_RECTS   24
+#endif
 
-typedef enum
-{
-    LANG_ENGLISH = 0,
-    LANG_RUSSIAN,
-    LANG_GERMAN,
-    LANG_FINNISH
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE 32
+#endif
 
-} lang_t;
+// Statistics records waiting to be appended, see storage.c.
+#ifndef STORAGE_STATS_SIZE
+#define STORAGE_STATS_SIZE 32
+#endif
 
-typedef enum
-{
-    MODE_NYT = 0,
-    MODE_ENDLESS
+// See arena.c.  Enough to decode tiles.png, 1088x256: stb_image holds
+// the compressed data, the filtered rows and the RGB24 image at once.
+// Textures are then converted a band of rows at a time.
+#ifdef __SYMBIAN32__
+#define ARENA_BAND_ROWS 8
+#ifndef ARENA_SIZE
+#define ARENA_SIZE      0x1C0000
+#endif
+#else
+#define ARENA_BAND_ROWS 16
+#ifndef ARENA_SIZE
+#define ARENA_SIZE      0x1D0000
+#endif
+#endif
 
-} game_mode_t;
+#ifndef PFS_PATH_LENGTH
+#define PFS_PATH_LENGTH 256
+#endif
 
-typedef enum
+typedef struct pfs
 {
-    EVENT_NONE = 0,
-    EVENT_KEY_0,
-    EVENT_KEY_2,
-    EVENT_KEY_3,
-    EVENT_KEY_4,
-    EVENT_KEY_5,
-    EVENT_KEY_6,
-    EVENT_KEY_7,
-    EVENT_KEY_8,
-    EVENT_KEY_9,
-    EVENT_CONFIRM,
-    EVENT_CONFIRM_LETTER,
-    EVENT_DELETE_LETTER,
-    EVENT_NEXT_LETTER,
-    EVENT_PREV_LETTER,
-    EVENT_TEXTINPUT,
-    EVENT_CONFIRM_ENDLESS_MODE,
-    EVENT_CONFIRM_LOAD_GAME,
-    EVENT_CONFIRM_NEW_GAME,
-    EVENT_CONFIRM_NYT_MODE,
-    EVENT_CONFIRM_SET_LANG,
-    EVENT_MENU_NEXT,
-    EVENT_MENU_PREV,
-    EVENT_MENU_SELECT_ENDLESS_MODE,
-    EVENT_MENU_SELECT_NYT_MODE,
-    EVENT_MENU_SELECT_NEW_GAME,
-    EVENT_MENU_SELECT_QUIT,
-    EVENT_BACK,
-    EVENT_QUIT,
-    EVENT_TOGGLE_FS
-
-} event_t;
-
-typedef struct tile
+    char dataPath[PFS_PATH_LENGTH];
+
+} pfs_t;
+
+// Startup memory, see arena.c.
+typedef struct arena
 {
-    unsigned char letter;
-    unsigned int  letter_index;
-    state_t       state;
+    Uint8*         base;
+    size_t         capacity;
+    size_t         top;
+    size_t         last;            // Offset of the last block
 
-} tile_t;
+} arena_t;
 
-typedef struct wordlist
+// Save states waiting to be written, see storage.c.
+typedef struct save_slot
 {
-    lang_t                language;
-    unsigned int          letter_count;
-    unsigned int          word_count;
-    unsigned int          allowed_count;
-    unsigned char         first_letter;
-    unsigned char         last_letter;
-    SDL_bool              is_cyrillic;
-    const unsigned char*  special_chars;
-    const Uint32*         hash;
-    const unsigned char (*list)[5];
-    const Uint32*         allowed_hash;
-    const unsigned char (*allowed_list)[5];
-
-} wordlist_t;
-
-typedef struct save_state
+    Uint8          buffer[SAVE_BUFFER_SIZE];
+    size_t         size;            // 0 until saved in this session
+    SDL_bool       is_pending;
+    Uint32         request_ticks;
+
+} save_slot_t;
+
+// Statistics waiting to be written, see storage.c.  The log is double
+// buffered: new records go to log while the writer owns the others.
+typedef struct stats_slot
 {
-    unsigned int  version;
-    tile_t        tile[30];
-    int           current_index;
-    unsigned char previous_letter;
-    unsigned int  valid_answer_index;
-    Uint8         attempt;
-    unsigned int  seed;
-    lang_t        language;
-
-} save_state_t;
-
-typedef struct nyt_save_state
+    Uint8*         log;             // Records to append
+    size_t         log_size;
+    size_t         log_capacity;
+    Uint8*         writing;         // Records being written
+    size_t         writing_size;
+    size_t         writing_capacity;
+    Uint8          header[STATS_HEADER_SIZE];
+    SDL_bool       is_header_pending;
+    SDL_bool       is_log_lost;     // The header would count a dropped record
+
+} stats_slot_t;
+
+typedef struct storage
 {
-    tile_t        tile[30];
-    int           current_index;
-    unsigned char previous_letter;
-    unsigned int  valid_answer_index;
-    Uint8         attempt;
-    SDL_bool      has_ended;
-    Uint8         final_attempt;
-
-} nyt_save_state_t;
+    save_slot_t    slot[2];         // Game and daily save
+    Uint8          journal_count[2];
+    stats_slot_t   stats[LANGUAGE_COUNT];
+    SDL_Thread*    thread;
+    SDL_mutex*     lock;
+    SDL_cond*      wake;
+    SDL_bool       quit;
+
+} storage_t;
+
+#ifdef USE_FRAMEBUFFER
+typedef SDL_Surface image_t;
+#else
+typedef SDL_Texture image_t;
+#endif
 
 typedef struct game
 {
+#ifdef USE_FRAMEBUFFER
+    SDL_Surface*   screen;
+    SDL_Rect       dirty_rect[FB_MAX_DIRTY_RECTS];
+    int            dirty_count;
+    Uint32         tile_cache[30];
+    SDL_bool       invalidate_tiles;
+    // Text drawn by osd_print() this frame and the text on screen, so
+    // that only what it covered is restored once it changes.
+    SDL_Rect       osd_rect[FB_MAX_OSD_RECTS];
+    int            osd_count;
+    Uint32         osd_hash;
+    SDL_Rect       shown_osd_rect[FB_MAX_OSD_RECTS];
+    int            shown_osd_count;
+    Uint32         shown_osd_hash;
+#else
     SDL_Renderer*  renderer;
     SDL_Texture*   render_target;
-    SDL_Texture*   tile_texture;
-    SDL_Texture*   font_texture;
+    Uint32         texture_format;
+#ifndef NDEBUG
+    SDL_bool       conversion_reported;
+#endif
+#endif
+    image_t*       tile_texture;
+    image_t*       font_texture;
     SDL_Window*    window;
+    pfs_t          pfs;
+    arena_t        arena;           // Only while loading the textures
     SDL_Event      event;
-    Uint16         render_offset_x;
-    Uint16         render_offset_y;
+    input_t        event_queue[EVENT_QUEUE_SIZE];
+    Uint8          event_head;
+    Uint8          event_tail;
     Uint8          zoom_factor;
     Uint32         time_since_last_frame;
     Uint32         time_a;
     Uint32         time_b;
     SDL_bool       is_running;
-    SDL_bool       show_menu;
-    SDL_bool       endless_mode;
-    SDL_bool       nyt_mode;
-    SDL_bool       show_stats;
-    SDL_bool       language_set_once;
-    SDL_bool       nyt_has_ended;
     SDL_bool       is_fullscreen;
-    tile_t         tile[30];
-    int            current_index;
-    unsigned char  previous_letter;
-    unsigned int   valid_answer_index;
-    unsigned char  current_guess[6];
-    Uint8          attempt;
-    Uint8          nyt_final_attempt;
-    unsigned int   seed;
-    wordlist_t     wordlist;
-    game_mode_t    selected_mode;
+    game_state_t   state;
+    // Input recording and replay, see replay.c.  The front end's
+    // hooks are kept here while the state's hooks are redirected.
+    SDL_RWops*     record;
+    Uint32         record_ticks;
+    SDL_RWops*     replay;
+    unsigned int   replay_daily_index;
+    game_hooks_t   hooks;
+    storage_t      storage;
+#ifndef NDEBUG
+    // See check_heap_allocations().
+    Uint32         heap_allocations;
+    Uint8          heap_frame_count;
+    SDL_bool       allocation_reported;
+#endif
+    // Solver for the daily word from data.pfs, see decision_tree.c.
+    Uint8*         decision_tree;
+    Uint32         decision_tree_nodes;
+    // Multi-board mode: boards are only redrawn when their rows have
+    // changed, see draw_boards().
+    Uint16         board_cache[MULTI_BOARD_MAX];
+    SDL_bool       show_boards;
+    SDL_bool       invalidate_boards;
 #ifdef __ANDROID__
-    SDL_Texture*   disclaimer_texture;
+    image_t*       disclaimer_texture;
     SDL_bool       show_disclaimer;
     float          swipe_h;
     float          swipe_v;
@@ -171,11 +184,27 @@ typedef struct game
 #endif
 } game_t;
 
+#if !defined NDEBUG && !defined USE_FRAMEBUFFER
+#define CHECK_BLIT_FORMAT(texture, core) check_blit_format((texture), (core))
+void check_blit_format(SDL_Texture* texture, game_t* core);
+#else
+#define CHECK_BLIT_FORMAT(texture, core)
+#endif
+
+#ifndef NDEBUG
+#define HEAP_CHECK_WARMUP            8 // Frames
+#define CHECK_HEAP_ALLOCATIONS(core) check_heap_allocations((core))
+void check_heap_allocations(game_t* core);
+#else
+#define CHECK_HEAP_ALLOCATIONS(core)
+#endif
+
 int      game_init(const char* resource_file, const char* title, game_t** core);
 SDL_bool game_is_running(game_t* core);
 int      game_update(game_t* core);
 void     game_quit(game_t* core);
 void     game_save(game_t* core);
 void     game_load(SDL_bool load_daily, game_t* core);
+SDL_bool game_push_input(const input_t* input, game_t* core);
 
 #endif /* GAME_H */
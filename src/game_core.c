@@ -0,0 +1,1008 @@
+/** @file game_core.c
+ *
+ *  Game rules and tile state.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL_stdinc.h"
+#include "SDL_version.h"
+#include "game_core.h"
+
+#if ! SDL_VERSION_ATLEAST(2, 0, 20)
+#include <ctype.h>
+int SDL_isalpha(int x) { return isalpha(x); }
+#define SDL_clamp(x, a, b) (((x) < (a)) ? (a) : (((x) > (b)) ? (b) : (x)))
+#endif
+
+static void     clear_tiles(SDL_bool clear_state, game_state_t* state);
+static void     confirm_multi_guess(game_state_t* state);
+static Uint32   decode_utf8(const unsigned char* text, size_t size);
+static void     delete_letter(game_state_t* state);
+static void     get_index_limits(int* lower_limit, int* upper_limit, game_state_t* state);
+static void     go_back_to_menu(game_state_t* state);
+static void     goto_next_letter(game_state_t* state);
+static SDL_bool has_game_ended(SDL_bool* is_won, game_state_t* state);
+static void     load_shuffle(game_state_t* state);
+static void     move_rows_up(game_state_t* state);
+static void     record_game(SDL_bool is_won, game_state_t* state);
+static void     reset_game(SDL_bool nyt_mode, SDL_bool draw_answer, game_state_t* state);
+static void     select_key_letter(const unsigned char start_char, const unsigned char end_char, game_state_t* state);
+static void     select_next_letter(const unsigned char start_char, const unsigned char end_char, game_state_t* state);
+static void     select_previous_letter(const unsigned char start_char, const unsigned char end_char, game_state_t* state);
+static void     select_utf8_letter(const Uint16 *text, game_state_t* state);
+static void     set_text_input(SDL_bool enabled, game_state_t* state);
+static void     show_results(game_state_t* state);
+
+void game_state_init(unsigned int seed, const game_hooks_t* hooks, game_state_t* state)
+{
+    if (NULL == state)
+    {
+        return;
+    }
+
+    SDL_memset(state, 0, sizeof(game_state_t));
+
+    if (NULL != hooks)
+    {
+        state->hooks = *hooks;
+    }
+
+    set_language(LANG_ENGLISH, SDL_TRUE, state);
+
+    // xorshift never leaves a zero state.
+    state->seed          = (0 == seed) ? 1 : seed;
+    state->current_index = 27;
+    state->show_menu     = SDL_TRUE;
+
+    load_shuffle(state);
+}
+
+void game_state_apply(const input_t* input, game_state_t* state)
+{
+    unsigned char start_char;
+    unsigned char end_char;
+    unsigned int  repeat;
+
+    if (NULL == state)
+    {
+        return;
+    }
+
+    // Suggestions are only shown until the next input.
+    state->suggestion_count = 0;
+
+    switch (input->type)
+    {
+        default:
+        case EVENT_NONE:
+            break;
+        case EVENT_KEY_0:
+            if (0 != state->wordlist.special_chars[0])
+            {
+                unsigned char* current_letter = &state->tile[state->current_index].letter;
+
+                start_char = state->wordlist.first_letter;
+                end_char   = state->wordlist.last_letter;
+
+                if (*current_letter >= start_char && *current_letter < end_char)
+                {
+                    *current_letter = state->wordlist.special_chars[0];
+                }
+                else
+                {
+                    state->special_char_index += 1;
+                    if (0x00 == state->wordlist.special_chars[state->special_char_index])
+                    {
+                        state->special_char_index = 0;
+                    }
+                    *current_letter = state->wordlist.special_chars[state->special_char_index];
+                }
+            }
+            break;
+        case EVENT_KEY_2:
+        case EVENT_KEY_3:
+        case EVENT_KEY_4:
+        case EVENT_KEY_5:
+        case EVENT_KEY_6:
+        case EVENT_KEY_7:
+        case EVENT_KEY_8:
+        case EVENT_KEY_9:
+            start_char = state->wordlist.keypad[input->type - EVENT_KEY_2][0];
+            end_char   = state->wordlist.keypad[input->type - EVENT_KEY_2][1];
+            select_key_letter(start_char, end_char, state);
+            break;
+        case EVENT_CONFIRM:
+            if (state->attempt < 6)
+            {
+                if (0 != state->multi.board_count)
+                {
+                    confirm_multi_guess(state);
+                }
+                else if (0 == ((state->current_index + 1) % 5))
+                {
+                    SDL_bool is_won = SDL_FALSE;
+                    int      index;
+                    int      letter_index;
+                    int      end_index;
+
+                    get_index_limits(&index, &end_index, state);
+
+                    for (letter_index = 0; letter_index < 5; letter_index += 1)
+                    {
+                        state->current_guess[letter_index]  = state->tile[index].letter;
+                        index                             += 1;
+                    }
+
+                    if (SDL_TRUE == is_guess_allowed(state->current_guess, state))
+                    {
+                        if (state->guess_count < 0xff)
+                        {
+                            state->guess_count += 1;
+                        }
+
+                        if (SDL_TRUE == state->adversarial.is_active)
+                        {
+                            state->valid_answer_index = adversarial_guess(state->current_guess, &state->wordlist, &state->adversarial);
+                        }
+
+                        if (SDL_TRUE == state->nyt_mode)
+                        {
+                            game_state_save(state);
+                        }
+
+                        if (SDL_TRUE == has_game_ended(&is_won, state))
+                        {
+                            record_game(is_won, state);
+
+                            if (SDL_TRUE == state->nyt_mode)
+                            {
+                                state->nyt_final_attempt = state->attempt + 1;
+                                state->nyt_has_ended     = SDL_TRUE;
+                                game_state_save(state);
+                            }
+                            show_results(state);
+                        }
+                        else
+                        {
+                            if ((SDL_TRUE == state->endless_mode) && (4 == state->attempt))
+                            {
+                                move_rows_up(state);
+                                state->current_index -= 5;
+                            }
+                            else
+                            {
+                                state->attempt += 1;
+                            }
+                            goto_next_letter(state);
+                        }
+                    }
+                    else
+                    {
+                        state->suggestion_count = suggest_words(&state->suggest, state->current_guess, state->suggestion);
+                    }
+                }
+            }
+            else
+            {
+                game_state_save(state);
+                clear_tiles(SDL_TRUE, state);
+                state->multi.board_count     = 0;
+                state->adversarial.is_active = SDL_FALSE;
+                state->current_index         = 27;
+                set_language(state->wordlist.language, SDL_TRUE, state);
+            }
+            break;
+        case EVENT_CONFIRM_LETTER:
+            goto_next_letter(state);
+            break;
+        case EVENT_DELETE_LETTER:
+            delete_letter(state);
+            switch((state->current_index))
+            {
+                case 0:
+                case 5:
+                case 10:
+                case 15:
+                case 20:
+                case 25:
+                    if (0 == state->tile[state->current_index].letter)
+                    {
+                        go_back_to_menu(state);
+                    }
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case EVENT_NEXT_LETTER:
+            start_char = state->wordlist.first_letter;
+            end_char   = state->wordlist.last_letter;
+            for (repeat = 0; repeat < input->count; repeat += 1)
+            {
+                select_next_letter(start_char, end_char, state);
+            }
+            break;
+        case EVENT_PREV_LETTER:
+            start_char = state->wordlist.first_letter;
+            end_char   = state->wordlist.last_letter;
+            for (repeat = 0; repeat < input->count; repeat += 1)
+            {
+                select_previous_letter(start_char, end_char, state);
+            }
+            break;
+        case EVENT_TOGGLE_PREDICTIVE_INPUT:
+            state->predictive_input = (SDL_TRUE == state->predictive_input) ? SDL_FALSE : SDL_TRUE;
+            break;
+        case EVENT_TEXTINPUT:
+            if (SDL_TRUE != state->show_menu)
+            {
+                select_utf8_letter(&input->text, state);
+            }
+            break;
+        case EVENT_CONFIRM_ENDLESS_MODE:
+            state->endless_mode = SDL_TRUE;
+            state->nyt_mode     = SDL_FALSE;
+            reset_game(SDL_FALSE, SDL_TRUE, state);
+            break;
+        case EVENT_CONFIRM_LOAD_GAME:
+            state->endless_mode = SDL_FALSE;
+            state->nyt_mode     = SDL_FALSE;
+            game_state_load(SDL_FALSE, state);
+            break;
+        case EVENT_CONFIRM_NEW_GAME:
+            state->endless_mode = SDL_FALSE;
+            state->nyt_mode     = SDL_FALSE;
+            game_state_save(state);
+            reset_game(SDL_FALSE, SDL_TRUE, state);
+            break;
+        case EVENT_CONFIRM_NYT_MODE:
+            state->endless_mode = SDL_FALSE;
+            state->nyt_mode     = SDL_TRUE;
+            game_state_load(SDL_TRUE, state);
+
+            if (SDL_TRUE == state->nyt_has_ended)
+            {
+                show_results(state);
+            }
+            break;
+        case EVENT_CONFIRM_MULTI_MODE:
+            state->endless_mode = SDL_FALSE;
+            state->nyt_mode     = SDL_FALSE;
+            reset_game(SDL_FALSE, SDL_FALSE, state);
+            multi_board_reset(state->selected_boards, &state->wordlist, &state->seed, &state->multi);
+
+            // The guess is entered in the last row, the boards are
+            // drawn above it.
+            state->attempt       = 5;
+            state->current_index = 25;
+            break;
+        case EVENT_CONFIRM_ADVERSARIAL_MODE:
+            state->endless_mode = SDL_TRUE;
+            state->nyt_mode     = SDL_FALSE;
+            reset_game(SDL_FALSE, SDL_FALSE, state);
+            adversarial_reset(&state->wordlist, &state->adversarial);
+            break;
+        case EVENT_CONFIRM_SET_LANG:
+            state->language_set_once = SDL_TRUE;
+            set_next_language(state);
+            break;
+        case EVENT_MENU_NEXT:
+            state->current_index += 1;
+            if (state->current_index > 29)
+            {
+                state->current_index = 25;
+            }
+            break;
+        case EVENT_MENU_PREV:
+            state->current_index -= 1;
+            if (state->current_index < 25)
+            {
+                state->current_index = 29;
+            }
+            break;
+        case EVENT_MENU_SELECT_ENDLESS_MODE:
+            state->selected_mode = MODE_ENDLESS;
+            break;
+        case EVENT_MENU_SELECT_NYT_MODE:
+            state->selected_mode = MODE_NYT;
+            break;
+        case EVENT_MENU_SELECT_MULTI_MODE:
+            // Cycles through 2, 4 and 8 boards.
+            if ((MODE_MULTI != state->selected_mode) || (state->selected_boards >= MULTI_BOARD_MAX))
+            {
+                state->selected_boards = 2;
+            }
+            else
+            {
+                state->selected_boards *= 2;
+            }
+            state->selected_mode = MODE_MULTI;
+            break;
+        case EVENT_MENU_SELECT_ADVERSARIAL_MODE:
+            state->selected_mode = MODE_ADVERSARIAL;
+            break;
+        case EVENT_MENU_SELECT_NEW_GAME:
+            state->current_index = 25;
+            break;
+        case EVENT_MENU_SELECT_QUIT:
+            state->current_index = 29;
+            break;
+        case EVENT_BACK:
+            go_back_to_menu(state);
+            break;
+    }
+}
+
+void game_state_save(game_state_t* state)
+{
+    int index;
+
+    if (NULL == state)
+    {
+        return;
+    }
+
+    if (NULL == state->hooks.write_save)
+    {
+        return;
+    }
+
+    // Multi-board and adversarial games are not saved.
+    if ((0 != state->multi.board_count) || (SDL_TRUE == state->adversarial.is_active))
+    {
+        return;
+    }
+
+    if (SDL_FALSE == state->nyt_mode)
+    {
+        save_state_t save;
+        Uint8        buffer[SAVE_BUFFER_SIZE];
+        size_t       size;
+
+        SDL_memset(&save, 0, sizeof(save));
+
+        for (index = 0; index < 30; index += 1)
+        {
+            save.tile[index].letter       = state->tile[index].letter;
+            save.tile[index].letter_index = state->tile[index].letter_index;
+            save.tile[index].state        = state->tile[index].state;
+        }
+
+        save.current_index      = state->current_index;
+        save.previous_letter    = state->previous_letter;
+        save.valid_answer_index = state->valid_answer_index;
+        save.attempt            = state->attempt;
+        save.seed               = state->seed;
+        save.language           = state->wordlist.language;
+
+        SDL_memcpy(save.shuffle_seed, state->shuffle.seed, sizeof(save.shuffle_seed));
+        SDL_memcpy(save.shuffle_cursor, state->shuffle.cursor, sizeof(save.shuffle_cursor));
+
+        size = save_state_encode(&save, buffer);
+        state->hooks.write_save(SDL_FALSE, buffer, size, state->hooks.user_data);
+    }
+    else
+    {
+        nyt_save_state_t save;
+        Uint8            buffer[SAVE_BUFFER_SIZE];
+        size_t           size;
+
+        SDL_memset(&save, 0, sizeof(save));
+
+        for (index = 0; index < 30; index += 1)
+        {
+            save.tile[index].letter       = state->tile[index].letter;
+            save.tile[index].letter_index = state->tile[index].letter_index;
+            save.tile[index].state        = state->tile[index].state;
+        }
+
+        save.current_index      = state->current_index;
+        save.previous_letter    = state->previous_letter;
+        save.valid_answer_index = state->valid_answer_index;
+        save.has_ended          = state->nyt_has_ended;
+        save.attempt            = state->attempt;
+        save.final_attempt      = state->nyt_final_attempt;
+
+        size = nyt_save_state_encode(&save, buffer);
+        state->hooks.write_save(SDL_TRUE, buffer, size, state->hooks.user_data);
+    }
+}
+
+void game_state_load(SDL_bool load_daily, game_state_t* state)
+{
+    int index;
+
+    if (NULL == state)
+    {
+        return;
+    }
+
+    // Without persistent storage, always start a new game.
+    if (NULL == state->hooks.read_save)
+    {
+        reset_game(load_daily, SDL_TRUE, state);
+        return;
+    }
+
+    if (SDL_FALSE == load_daily)
+    {
+        save_state_t save;
+        Uint8        buffer[SAVE_BUFFER_SIZE];
+        size_t       size;
+
+        size = state->hooks.read_save(SDL_FALSE, buffer, sizeof(buffer), state->hooks.user_data);
+
+        if (SDL_FALSE == save_state_decode(buffer, size, &save))
+        {
+            // Do not load outdated or invalid save states.
+            return;
+        }
+
+        state->show_menu = SDL_FALSE;
+        clear_tiles(SDL_TRUE, state);
+
+        for (index = 0; index < 30; index += 1)
+        {
+            state->tile[index].letter       = save.tile[index].letter;
+            state->tile[index].letter_index = save.tile[index].letter_index;
+            state->tile[index].state        = save.tile[index].state;
+        }
+
+        state->current_index      = save.current_index;
+        state->previous_letter    = save.previous_letter;
+        state->valid_answer_index = save.valid_answer_index;
+        state->attempt            = save.attempt;
+        state->guess_count        = save.attempt; // Rows scrolled away are not saved
+        state->seed               = save.seed;
+
+        set_language(save.language, SDL_FALSE, state);
+    }
+    else
+    {
+        nyt_save_state_t save;
+        Uint8            buffer[SAVE_BUFFER_SIZE];
+        size_t           size;
+
+        size = state->hooks.read_save(SDL_TRUE, buffer, sizeof(buffer), state->hooks.user_data);
+
+        // An invalid save state leaves everything at 0, which starts
+        // a new game below.
+        nyt_save_state_decode(buffer, size, &save);
+
+        if (save.valid_answer_index != game_state_daily_index(state))
+        {
+            /* New daily world available. */
+            reset_game(SDL_TRUE, SDL_FALSE, state);
+        }
+        else
+        {
+            state->show_menu = SDL_FALSE;
+            clear_tiles(SDL_TRUE, state);
+
+            for (index = 0; index < 30; index += 1)
+            {
+                state->tile[index].letter       = save.tile[index].letter;
+                state->tile[index].letter_index = save.tile[index].letter_index;
+                state->tile[index].state        = save.tile[index].state;
+            }
+
+            state->current_index      = save.current_index;
+            state->previous_letter    = save.previous_letter;
+            state->valid_answer_index = save.valid_answer_index;
+            state->attempt            = save.attempt;
+            state->guess_count        = save.attempt;
+            state->nyt_has_ended      = save.has_ended;
+            state->nyt_final_attempt  = save.final_attempt;
+
+            set_language(LANG_ENGLISH, SDL_FALSE, state);
+        }
+    }
+    set_text_input(SDL_TRUE, state);
+}
+
+unsigned int game_state_daily_index(game_state_t* state)
+{
+    if (NULL != state && NULL != state->hooks.get_daily_index)
+    {
+        return state->hooks.get_daily_index(state->hooks.user_data);
+    }
+
+    return get_nyt_daily_index();
+}
+
+unsigned int game_state_day(game_state_t* state)
+{
+    if (NULL != state && NULL != state->hooks.get_day)
+    {
+        return state->hooks.get_day(state->hooks.user_data);
+    }
+
+    return get_days_since_epoch();
+}
+
+static void clear_tiles(SDL_bool clear_state, game_state_t* state)
+{
+    int index;
+
+    if (NULL == state)
+    {
+        return;
+    }
+
+    for (index = 0; index < 30; index += 1)
+    {
+        state->tile[index].letter = 0;
+        if (SDL_TRUE == clear_state)
+        {
+            state->tile[index].state = LETTER_SELECT;
+        }
+    }
+}
+
+static void confirm_multi_guess(game_state_t* state)
+{
+    int letter_index;
+
+    if (29 != state->current_index)
+    {
+        return;
+    }
+
+    for (letter_index = 0; letter_index < 5; letter_index += 1)
+    {
+        state->current_guess[letter_index] = state->tile[25 + letter_index].letter;
+    }
+
+    if (SDL_FALSE == is_guess_allowed(state->current_guess, state))
+    {
+        state->suggestion_count = suggest_words(&state->suggest, state->current_guess, state->suggestion);
+        return;
+    }
+
+    for (letter_index = 0; letter_index < 5; letter_index += 1)
+    {
+        state->tile[25 + letter_index].letter = 0;
+    }
+
+    if (SDL_TRUE == multi_board_guess(state->current_guess, &state->multi))
+    {
+        state->attempt       = 6;
+        state->current_index = -1;
+    }
+    else
+    {
+        state->current_index = 25;
+    }
+}
+
+// Returns the codepoint of the first UTF-8 sequence, or 0xffffffff if
+// it is invalid or incomplete.
+static Uint32 decode_utf8(const unsigned char* text, size_t size)
+{
+    // By the upper four bits of the first byte; 0 for continuation
+    // bytes.
+    static const Uint8  sequence_length[16] = { 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 2, 2, 3, 4 };
+    static const Uint8  first_mask[5]       = { 0x00, 0x7f, 0x1f, 0x0f, 0x07 };
+    static const Uint32 lowest[5]           = { 0, 0, 0x80, 0x800, 0x10000 };
+    Uint32              codepoint;
+    Uint8               length;
+    Uint8               index;
+
+    if (NULL == text || 0 == size)
+    {
+        return 0xffffffff;
+    }
+
+    length = sequence_length[text[0] >> 4];
+    if (0 == length || length > size || text[0] > 0xf4)
+    {
+        return 0xffffffff;
+    }
+
+    codepoint = text[0] & first_mask[length];
+
+    for (index = 1; index < length; index += 1)
+    {
+        if (0x80 != (text[index] & 0xc0))
+        {
+            return 0xffffffff;
+        }
+        codepoint = (codepoint << 6) | (text[index] & 0x3f);
+    }
+
+    // Overlong sequences and surrogates are not valid.
+    if (codepoint < lowest[length] || (codepoint >= 0xd800 && codepoint <= 0xdfff))
+    {
+        return 0xffffffff;
+    }
+
+    return codepoint;
+}
+
+static void delete_letter(game_state_t* state)
+{
+    int lower_index_limit = 0;
+    int upper_index_limit = 0;
+
+    if (NULL == state)
+    {
+        return;
+    }
+
+    if (state->attempt >= 6)
+    {
+        return;
+    }
+
+    get_index_limits(&lower_index_limit, &upper_index_limit, state);
+
+    state->tile[state->current_index].letter  = 0;
+    state->current_index                    -= 1;
+    state->current_index                     = SDL_clamp(state->current_index, lower_index_limit, upper_index_limit);
+}
+
+static void get_index_limits(int* lower_limit, int* upper_limit, game_state_t* state)
+{
+    if (NULL == state)
+    {
+        return;
+    }
+
+    switch (state->attempt)
+    {
+        default:
+        case 0:
+            *lower_limit = 0;
+            *upper_limit = 4;
+            break;
+        case 1:
+            *lower_limit = 5;
+            *upper_limit = 9;
+            break;
+        case 2:
+            *lower_limit = 10;
+            *upper_limit = 14;
+            break;
+        case 3:
+            *lower_limit = 15;
+            *upper_limit = 19;
+            break;
+        case 4:
+            *lower_limit = 20;
+            *upper_limit = 24;
+            break;
+        case 5:
+            *lower_limit = 25;
+            *upper_limit = 29;
+            break;
+    }
+}
+
+static void go_back_to_menu(game_state_t* state)
+{
+    set_text_input(SDL_FALSE, state);
+    game_state_save(state);
+    clear_tiles(SDL_TRUE, state);
+    state->multi.board_count     = 0;
+    state->adversarial.is_active = SDL_FALSE;
+    state->current_index         = 27;
+    set_language(state->wordlist.language, SDL_TRUE, state);
+}
+
+static void goto_next_letter(game_state_t* state)
+{
+    int lower_index_limit = 0;
+    int upper_index_limit = 0;
+
+    if (NULL == state)
+    {
+        return;
+    }
+
+    if (state->attempt >= 6)
+    {
+        return;
+    }
+
+    get_index_limits(&lower_index_limit, &upper_index_limit, state);
+
+    if (state->tile[state->current_index].letter != 0)
+    {
+        state->current_index                    += 1;
+        state->current_index                     = SDL_clamp(state->current_index, lower_index_limit, upper_index_limit);
+        state->tile[state->current_index].letter  = 0;
+    }
+}
+
+static SDL_bool has_game_ended(SDL_bool* is_won, game_state_t* state)
+{
+    validate_current_guess(is_won, state);
+
+    if ((SDL_TRUE == state->nyt_mode) && (state->nyt_has_ended))
+    {
+        return SDL_TRUE;
+    }
+
+    if ((SDL_TRUE == *is_won) || (SDL_FALSE == *is_won && 5 == state->attempt))
+    {
+        return SDL_TRUE;
+    }
+
+    return SDL_FALSE;
+}
+
+// The answer order carries over from the last session, even if the
+// saved game itself is not loaded.
+static void load_shuffle(game_state_t* state)
+{
+    save_state_t save;
+    Uint8        buffer[SAVE_BUFFER_SIZE];
+    size_t       size;
+
+    if (NULL == state->hooks.read_save)
+    {
+        return;
+    }
+
+    size = state->hooks.read_save(SDL_FALSE, buffer, sizeof(buffer), state->hooks.user_data);
+
+    if (SDL_FALSE == save_state_decode(buffer, size, &save))
+    {
+        return;
+    }
+
+    SDL_memcpy(state->shuffle.seed, save.shuffle_seed, sizeof(state->shuffle.seed));
+    SDL_memcpy(state->shuffle.cursor, save.shuffle_cursor, sizeof(state->shuffle.cursor));
+    state->shuffle.is_valid = SDL_FALSE;
+}
+
+static void move_rows_up(game_state_t* state)
+{
+    int counter;
+    int tile_index;
+    for (counter = 0; counter < 5; counter += 1)
+    {
+        for (tile_index = 1; tile_index < 30; tile_index += 1)
+        {
+            state->tile[tile_index - 1].letter       = state->tile[tile_index].letter;
+            state->tile[tile_index - 1].letter_index = state->tile[tile_index].letter_index;
+            state->tile[tile_index - 1].state        = state->tile[tile_index].state;
+        }
+    }
+}
+
+// Multi-board games are not recorded, they allow more than six
+// guesses by design.
+static void record_game(SDL_bool is_won, game_state_t* state)
+{
+    game_mode_t mode = MODE_ENDLESS;
+
+    if (SDL_TRUE == state->nyt_mode)
+    {
+        mode = MODE_NYT;
+    }
+    else if (SDL_TRUE == state->adversarial.is_active)
+    {
+        mode = MODE_ADVERSARIAL;
+    }
+
+    stats_record(mode, game_state_day(state), (SDL_TRUE == is_won) ? state->guess_count : 0, &state->hooks, &state->stats);
+}
+
+// Multi-board and adversarial games pick their own answers, so they
+// do not draw one from the shuffled order, see shuffle.c.
+static void reset_game(SDL_bool nyt_mode, SDL_bool draw_answer, game_state_t* state)
+{
+    if (NULL == state)
+    {
+        return;
+    }
+
+    clear_tiles(SDL_TRUE, state);
+
+    state->attempt               = 0;
+    state->guess_count           = 0;
+    state->current_index         = 0;
+    state->show_menu             = SDL_FALSE;
+    state->multi.board_count     = 0;
+    state->adversarial.is_active = SDL_FALSE;
+
+    state->show_stats    = SDL_FALSE;
+
+    if (SDL_FALSE == nyt_mode)
+    {
+        state->valid_answer_index = 0;
+        if (SDL_TRUE == draw_answer)
+        {
+            state->valid_answer_index = shuffle_next_answer(&state->wordlist, &state->seed, &state->shuffle);
+        }
+        state->nyt_mode = SDL_FALSE;
+    }
+    else
+    {
+        set_language(LANG_ENGLISH, SDL_FALSE, state);
+        state->valid_answer_index = game_state_daily_index(state);
+        state->nyt_mode           = SDL_TRUE;
+    }
+    set_text_input(SDL_TRUE, state);
+}
+
+// With predictive input, a key only cycles through the letters that
+// can still form a word, most frequent first.  If none of them can,
+// the key behaves as usual and the guess gets rejected on confirm.
+static void select_key_letter(const unsigned char start_char, const unsigned char end_char, game_state_t* state)
+{
+    unsigned char  letter[PREDICT_MAX_LETTERS];
+    unsigned char  prefix[5];
+    unsigned char* current_letter;
+    int            lower_index_limit = 0;
+    int            upper_index_limit = 0;
+    int            length;
+    Uint8          count;
+    Uint8          index;
+
+    if (SDL_FALSE == state->predictive_input || state->attempt >= 6)
+    {
+        select_next_letter(start_char, end_char, state);
+        return;
+    }
+
+    get_index_limits(&lower_index_limit, &upper_index_limit, state);
+
+    length = state->current_index - lower_index_limit;
+    for (index = 0; index < length; index += 1)
+    {
+        prefix[index] = state->tile[lower_index_limit + index].letter;
+    }
+
+    count = predict_letters(&state->predict, prefix, length, start_char, end_char, letter);
+    if (0 == count)
+    {
+        select_next_letter(start_char, end_char, state);
+        return;
+    }
+
+    current_letter = &state->tile[state->current_index].letter;
+
+    for (index = 0; index < count; index += 1)
+    {
+        if (letter[index] == *current_letter)
+        {
+            break;
+        }
+    }
+
+    *current_letter = letter[(index + 1 < count) ? index + 1 : 0];
+}
+
+static void select_next_letter(const unsigned char start_char, const unsigned char end_char, game_state_t* state)
+{
+    unsigned char* current_letter = &state->tile[state->current_index].letter;
+
+    if (state->attempt >= 6)
+    {
+        return;
+    }
+
+    if (*current_letter >= start_char && *current_letter < end_char)
+    {
+        *current_letter += 1;
+    }
+    else
+    {
+        *current_letter = start_char;
+    }
+}
+
+static void select_previous_letter(const unsigned char start_char, const unsigned char end_char, game_state_t* state)
+{
+    unsigned char* current_letter = &state->tile[state->current_index].letter;
+
+    if (state->attempt >= 6)
+    {
+        return;
+    }
+
+    if (0 == *current_letter)
+    {
+        *current_letter = start_char;
+    }
+
+    *current_letter -= 1;
+
+    if (*current_letter < start_char)
+    {
+        *current_letter = end_char;
+    }
+}
+
+static void select_utf8_letter(const Uint16 *text, game_state_t* state)
+{
+    unsigned char  sequence[2];
+    Uint32         codepoint;
+    unsigned char  letter;
+
+    // The first byte is in the lower half, see poll_events().
+    sequence[0] = (unsigned char)(*text & 0xff);
+    sequence[1] = (unsigned char)(*text >> 8);
+
+    codepoint = decode_utf8(sequence, sizeof(sequence));
+    if (codepoint >= INPUT_CODEPOINTS)
+    {
+        return;
+    }
+
+    letter = state->input_letter[codepoint];
+    if (0 == letter)
+    {
+        return;
+    }
+
+    state->tile[state->current_index].letter = letter;
+
+    if (0 != ((state->current_index + 1) % 5))
+    {
+        state->current_index++;
+    }
+}
+
+static void set_text_input(SDL_bool enabled, game_state_t* state)
+{
+    if (NULL != state->hooks.set_text_input)
+    {
+        state->hooks.set_text_input(enabled, state->hooks.user_data);
+    }
+}
+
+static void show_results(game_state_t* state)
+{
+    unsigned char valid_answer[6] = { 0 };
+
+    get_valid_answer(valid_answer, state);
+    clear_tiles(SDL_FALSE, state);
+
+    if (SDL_TRUE == state->nyt_mode)
+    {
+        state->show_stats = SDL_TRUE;
+    }
+    else
+    {
+        unsigned int start_index = state->attempt * 5;
+
+        state->tile[start_index].letter     = valid_answer[0];
+        state->tile[start_index + 1].letter = valid_answer[1];
+        state->tile[start_index + 2].letter = valid_answer[2];
+        state->tile[start_index + 3].letter = valid_answer[3];
+        state->tile[start_index + 4].letter = valid_answer[4];
+    }
+
+    state->attempt       = 6;
+    state->current_index = -1;
+}
+
+/* djb2 by Dan Bernstein
+ * http://www.cse.yorku.ca/~oz/hash.html
+ */
+Uint32 generate_hash(const unsigned char* name)
+{
+    Uint64 hash = 5381;
+    Uint32 c;
+
+    while ((c = *name++))
+    {
+        hash = ((hash << 5) + hash) + c;
+    }
+
+    return (Uint32)(hash & 0xffffffff);
+}
+
+unsigned int xorshift(unsigned int* xs)
+{
+    *xs ^= *xs << 7;
+    *xs ^= *xs >> 9;
+    *xs ^= *xs << 8;
+    return *xs;
+}
@@ -0,0 +1,417 @@
+/** @file game_core.h
+ *
+ *  Game rules, tile state and wordlist logic.  Only depends on
+ *  SDL_stdinc, so it can be used without initialising SDL or video.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#ifndef GAME_CORE_H
+#define GAME_CORE_H
+
+#include "SDL_stdinc.h"
+
+#ifndef SAVE_VERSION
+#define SAVE_VERSION 5
+#endif
+
+// See save.c.  Also fits the older formats.
+#define SAVE_BUFFER_SIZE 512
+
+#define LANGUAGE_COUNT            4
+
+// See opening_book.c.
+#define OPENING_BOOK_PATTERNS     243
+#define OPENING_BOOK_NONE         0xffff
+
+// See multi_board.c.
+#define MULTI_BOARD_MAX           8
+#define MULTI_BOARD_ROWS          (MULTI_BOARD_MAX + 5)
+
+// See adversarial.c.  Enough for the largest word list.
+#define ADVERSARIAL_MAX_WORDS     0x1900
+
+// See suggest.c.  Enough for the largest word list.
+#define SUGGEST_MAX_WORDS         0x3300
+#define SUGGEST_COUNT             3
+
+// See predict.c.  Enough for the largest word list.
+#define PREDICT_MAX_NODES         0x3000
+#define PREDICT_MAX_LEAVES        0x3300
+#define PREDICT_MAX_LETTERS       8
+
+// See shuffle.c.  Enough for the largest word list.
+#define SHUFFLE_MAX_ANSWERS       0x1900
+
+// See stats.c.  Indexed by game_mode_t.
+#define STATS_MODES               4
+#define STATS_GUESSES             7 // The last one for more than six
+#define STATS_HEADER_SIZE         208
+
+// Text input is limited to two-byte UTF-8 sequences, see input_t.
+#define INPUT_CODEPOINTS          0x800
+
+// See decision_tree.c.
+#define DECISION_TREE_VERSION     1
+#define DECISION_TREE_HEADER_SIZE 16
+#define DECISION_TREE_NODE_SIZE   6
+
+typedef enum
+{
+    LETTER_SELECT = 0,
+    CORRECT_LETTER,
+    WRONG_LETTER,
+    WRONG_POSITION,
+
+} state_t;
+
+typedef enum
+{
+    LANG_ENGLISH = 0,
+    LANG_RUSSIAN,
+    LANG_GERMAN,
+    LANG_FINNISH
+
+} lang_t;
+
+typedef enum
+{
+    MODE_NYT = 0,
+    MODE_ENDLESS,
+    MODE_MULTI,
+    MODE_ADVERSARIAL
+
+} game_mode_t;
+
+typedef enum
+{
+    EVENT_NONE = 0,
+    EVENT_KEY_0,
+    EVENT_KEY_2,
+    EVENT_KEY_3,
+    EVENT_KEY_4,
+    EVENT_KEY_5,
+    EVENT_KEY_6,
+    EVENT_KEY_7,
+    EVENT_KEY_8,
+    EVENT_KEY_9,
+    EVENT_CONFIRM,
+    EVENT_CONFIRM_LETTER,
+    EVENT_DELETE_LETTER,
+    EVENT_NEXT_LETTER,
+    EVENT_PREV_LETTER,
+    EVENT_TEXTINPUT,
+    EVENT_CONFIRM_ENDLESS_MODE,
+    EVENT_CONFIRM_LOAD_GAME,
+    EVENT_CONFIRM_NEW_GAME,
+    EVENT_CONFIRM_NYT_MODE,
+    EVENT_CONFIRM_SET_LANG,
+    EVENT_MENU_NEXT,
+    EVENT_MENU_PREV,
+    EVENT_MENU_SELECT_ENDLESS_MODE,
+    EVENT_MENU_SELECT_NYT_MODE,
+    EVENT_MENU_SELECT_NEW_GAME,
+    EVENT_MENU_SELECT_QUIT,
+    EVENT_BACK,
+    EVENT_QUIT,
+    EVENT_TOGGLE_FS,
+    EVENT_CONFIRM_MULTI_MODE,
+    EVENT_MENU_SELECT_MULTI_MODE,
+    EVENT_CONFIRM_ADVERSARIAL_MODE,
+    EVENT_MENU_SELECT_ADVERSARIAL_MODE,
+    EVENT_TOGGLE_PREDICTIVE_INPUT,
+    // Raw touch input, resolved by the front end once it is applied.
+    EVENT_SWIPE,
+    EVENT_TOUCH
+
+} event_t;
+
+typedef struct input
+{
+    event_t type;
+    Uint16  text;
+    Uint8   count;
+    float   dx; // Swipe distance, summed up while queued.
+    float   dy;
+
+} input_t;
+
+typedef struct tile
+{
+    unsigned char letter;
+    unsigned int  letter_index;
+    state_t       state;
+
+} tile_t;
+
+typedef struct wordlist
+{
+    lang_t                language;
+    unsigned int          letter_count;
+    unsigned int          word_count;
+    unsigned int          allowed_count;
+    unsigned char         first_letter;
+    unsigned char         last_letter;
+    SDL_bool              is_cyrillic;
+    const unsigned char*  special_chars;
+    const Uint16        (*input)[3];       // First and last codepoint, letter
+    unsigned int          input_count;
+    const unsigned char (*keypad)[2];      // First and last letter of keys 2 to 9
+    const Uint32*         hash;
+    const unsigned char (*list)[5];
+    const Uint32*         allowed_hash;
+    const unsigned char (*allowed_list)[5];
+
+} wordlist_t;
+
+typedef struct save_state
+{
+    tile_t        tile[30];
+    int           current_index;
+    unsigned char previous_letter;
+    unsigned int  valid_answer_index;
+    Uint8         attempt;
+    unsigned int  seed;
+    lang_t        language;
+    unsigned int  shuffle_seed[LANGUAGE_COUNT];
+    Uint16        shuffle_cursor[LANGUAGE_COUNT];
+
+} save_state_t;
+
+typedef struct nyt_save_state
+{
+    tile_t        tile[30];
+    int           current_index;
+    unsigned char previous_letter;
+    unsigned int  valid_answer_index;
+    Uint8         attempt;
+    SDL_bool      has_ended;
+    Uint8         final_attempt;
+
+} nyt_save_state_t;
+
+typedef struct board
+{
+    unsigned int  answer_index;
+    Uint8         pattern[MULTI_BOARD_ROWS]; // See get_pattern_code()
+    Uint8         solved_rows;               // 0 while unsolved
+
+} board_t;
+
+typedef struct multi_board
+{
+    Uint8         board_count;               // 0 outside of this mode
+    Uint8         row_count;
+    Uint8         attempt;
+    unsigned char guess[MULTI_BOARD_ROWS][5];
+    Uint64        answer_letter[5];          // Board n's letter in byte n
+    board_t       board[MULTI_BOARD_MAX];
+
+} multi_board_t;
+
+typedef struct adversarial
+{
+    SDL_bool      is_active;
+    Uint16        candidate_count;
+    Uint16        candidate[ADVERSARIAL_MAX_WORDS];
+    Uint8         pattern[ADVERSARIAL_MAX_WORDS];     // Of each candidate
+    Uint16        group_size[OPENING_BOOK_PATTERNS];  // By pattern
+
+} adversarial_t;
+
+typedef struct suggest
+{
+    SDL_bool      is_valid;
+    lang_t        language;
+    Uint32        word_count;
+    Uint8         letter_code[256];
+    Uint32        packed[SUGGEST_MAX_WORDS];          // Six bits per letter
+
+} suggest_t;
+
+typedef struct predict
+{
+    SDL_bool      is_valid;
+    lang_t        language;
+    Uint16        node_count;
+    Uint16        leaf_count;
+    Uint8         letter_code[256];                   // 0 if unused
+    Uint64        child_mask[PREDICT_MAX_NODES];      // By letter code
+    Uint16        first_child[PREDICT_MAX_NODES];
+    Uint16        weight[PREDICT_MAX_NODES];
+    Uint8         leaf_weight[PREDICT_MAX_LEAVES];
+
+} predict_t;
+
+typedef struct shuffle
+{
+    unsigned int  seed[LANGUAGE_COUNT];               // 0 until first used
+    Uint16        cursor[LANGUAGE_COUNT];             // Answers used so far
+    SDL_bool      is_valid;
+    lang_t        language;                           // Of the cached order
+    unsigned int  random;                             // Generator at the cursor
+    Uint16        answer[SHUFFLE_MAX_ANSWERS];
+
+} shuffle_t;
+
+typedef struct stats_summary
+{
+    Uint32         played;
+    Uint32         won;
+    Uint32         streak;
+    Uint32         max_streak;
+    Uint32         last_day;                    // Of the last game
+    Uint32         distribution[STATS_GUESSES]; // Games won by guesses
+
+} stats_summary_t;
+
+typedef struct stats
+{
+    SDL_bool        is_valid;
+    lang_t          language;
+    Uint32          last_day;                   // Of the last record
+    Uint32          log_size;                   // Bytes of records summed up
+    stats_summary_t summary[STATS_MODES];
+
+} stats_t;
+
+typedef struct opening_book
+{
+    SDL_bool       is_valid;
+    lang_t         language;
+    Uint32         checksum;
+    Uint16         first;
+    Uint16         second[OPENING_BOOK_PATTERNS]; // By pattern of the first guess
+
+} opening_book_t;
+
+typedef struct game_hooks
+{
+    // Read or write a save state.  Without persistent storage, both
+    // may be NULL; loading then always starts a new game.
+    size_t (*read_save)(SDL_bool daily, void* buffer, size_t size, void* user_data);
+    void   (*write_save)(SDL_bool daily, const void* buffer, size_t size, void* user_data);
+    // Enable or disable text input, e.g. the on-screen keyboard.
+    void   (*set_text_input)(SDL_bool enabled, void* user_data);
+    // Index of the daily word.  If NULL, it is derived from the
+    // current date, see get_nyt_daily_index().
+    unsigned int (*get_daily_index)(void* user_data);
+    // Days since 1970-01-01, which unlike the index of the daily word
+    // never wraps.  If NULL, it is derived from the current date, see
+    // get_days_since_epoch().
+    unsigned int (*get_day)(void* user_data);
+    // Read or write the cached opening book of a language.  If either
+    // is NULL, no book is used.
+    size_t (*read_book)(lang_t language, void* buffer, size_t size, void* user_data);
+    void   (*write_book)(lang_t language, const void* buffer, size_t size, void* user_data);
+    // Run task(0) to task(count - 1), possibly in parallel, and return
+    // once all of them are done.  If NULL, tasks run one by one.
+    void   (*run_tasks)(void (*task)(Uint32 index, void* data), Uint32 count, void* data, void* user_data);
+    // Read the statistics file of a language from the given offset,
+    // append a record to its log or replace its header, which comes
+    // first.  If any is NULL, nothing is kept between sessions.
+    size_t (*read_stats)(lang_t language, Uint32 offset, void* buffer, size_t size, void* user_data);
+    void   (*append_stats)(lang_t language, const void* buffer, size_t size, void* user_data);
+    void   (*write_stats_header)(lang_t language, const void* buffer, size_t size, void* user_data);
+    void*    user_data;
+
+} game_hooks_t;
+
+typedef struct game_state
+{
+    SDL_bool       show_menu;
+    SDL_bool       endless_mode;
+    SDL_bool       nyt_mode;
+    SDL_bool       show_stats;
+    SDL_bool       language_set_once;
+    SDL_bool       nyt_has_ended;
+    tile_t         tile[30];
+    int            current_index;
+    unsigned char  previous_letter;
+    unsigned int   valid_answer_index;
+    unsigned char  current_guess[6];
+    Uint8          attempt;
+    Uint8          guess_count;         // Rows scroll in endless mode
+    Uint8          nyt_final_attempt;
+    unsigned int   seed;
+    wordlist_t     wordlist;
+    game_mode_t    selected_mode;
+    unsigned int   special_char_index;
+    unsigned char  input_letter[INPUT_CODEPOINTS]; // By codepoint, 0 if not accepted
+    Uint8          selected_boards;
+    multi_board_t  multi;
+    adversarial_t  adversarial;
+    suggest_t      suggest;
+    Uint32         suggestion[SUGGEST_COUNT]; // For a rejected guess
+    Uint8          suggestion_count;
+    SDL_bool       predictive_input;
+    predict_t      predict;
+    shuffle_t      shuffle;
+    stats_t        stats;
+    game_hooks_t   hooks;
+
+} game_state_t;
+
+void         game_state_init(unsigned int seed, const game_hooks_t* hooks, game_state_t* state);
+void         game_state_apply(const input_t* input, game_state_t* state);
+void         game_state_save(game_state_t* state);
+void         game_state_load(SDL_bool load_daily, game_state_t* state);
+unsigned int game_state_daily_index(game_state_t* state);
+unsigned int game_state_day(game_state_t* state);
+
+void         set_language(const lang_t language, const SDL_bool set_title_screen, game_state_t* state);
+void         set_next_language(game_state_t* state);
+void         load_wordlist(const lang_t language, wordlist_t* wordlist);
+Uint32       get_word_count(const lang_t language);
+unsigned int get_nyt_daily_index(void);
+unsigned int get_days_since_epoch(void);
+void         get_valid_answer(unsigned char valid_answer[6], game_state_t* state);
+SDL_bool     is_guess_allowed(const unsigned char* guess, game_state_t* state);
+void         validate_current_guess(SDL_bool* is_won, game_state_t* state);
+SDL_bool     score_guess(const unsigned char* guess, const unsigned char* answer, state_t result[5]);
+Uint32       get_wordlist_checksum(const wordlist_t* wordlist);
+const unsigned char* get_guess_word(const wordlist_t* wordlist, Uint32 index);
+
+void         opening_book_load(const wordlist_t* wordlist, const game_hooks_t* hooks, opening_book_t* book);
+void         opening_book_build(const wordlist_t* wordlist, const game_hooks_t* hooks, opening_book_t* book);
+const unsigned char* opening_book_guess(const opening_book_t* book, const wordlist_t* wordlist, Uint8 attempt, Uint8 first_pattern);
+
+void         multi_board_reset(Uint8 board_count, const wordlist_t* wordlist, unsigned int* seed, multi_board_t* multi);
+SDL_bool     multi_board_guess(const unsigned char* guess, multi_board_t* multi);
+SDL_bool     multi_board_has_ended(const multi_board_t* multi);
+Uint8        score_guess_boards(const unsigned char* guess, const Uint64 answer_letter[5], Uint8 pattern[MULTI_BOARD_MAX]);
+void         get_pattern_states(Uint8 pattern, state_t result[5]);
+
+void         adversarial_reset(const wordlist_t* wordlist, adversarial_t* adversarial);
+unsigned int adversarial_guess(const unsigned char* guess, const wordlist_t* wordlist, adversarial_t* adversarial);
+
+void         suggest_build(const wordlist_t* wordlist, suggest_t* index);
+Uint8        suggest_words(const suggest_t* index, const unsigned char* guess, Uint32 suggestion[SUGGEST_COUNT]);
+
+size_t       save_state_encode(const save_state_t* save, Uint8 buffer[SAVE_BUFFER_SIZE]);
+SDL_bool     save_state_decode(const Uint8* buffer, size_t size, save_state_t* save);
+size_t       nyt_save_state_encode(const nyt_save_state_t* save, Uint8 buffer[SAVE_BUFFER_SIZE]);
+SDL_bool     nyt_save_state_decode(const Uint8* buffer, size_t size, nyt_save_state_t* save);
+Uint32       get_crc(const Uint8* buffer, size_t size);
+
+unsigned int shuffle_next_answer(const wordlist_t* wordlist, unsigned int* seed, shuffle_t* shuffle);
+Uint32       get_random_below(Uint32 limit, unsigned int* random);
+
+void         stats_load(lang_t language, const game_hooks_t* hooks, stats_t* stats);
+void         stats_record(game_mode_t mode, Uint32 day, Uint8 guesses, const game_hooks_t* hooks, stats_t* stats);
+Uint32       stats_get_streak(const stats_t* stats, game_mode_t mode, Uint32 day);
+Uint8        stats_get_win_rate(const stats_t* stats, game_mode_t mode);
+
+void         predict_build(const wordlist_t* wordlist, predict_t* predict);
+Uint8        predict_letters(const predict_t* predict, const unsigned char* prefix, int length, unsigned char start_char, unsigned char end_char, unsigned char letter[PREDICT_MAX_LETTERS]);
+
+Uint32       decision_tree_check(const Uint8 header[DECISION_TREE_HEADER_SIZE], const wordlist_t* wordlist);
+Uint8        decision_tree_walk(const Uint8* node, Uint32 node_count, const unsigned char* answer, const wordlist_t* wordlist, unsigned char guess[6][6]);
+Uint8        get_pattern_code(const state_t result[5]);
+
+Uint32       generate_hash(const unsigned char* name);
+unsigned int xorshift(unsigned int* xs);
+
+#endif /* GAME_CORE_H */
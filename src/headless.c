@@ -0,0 +1,328 @@
+/** @file headless.c
+ *
+ *  Headless mode: plays back a scripted input sequence without a
+ *  display, reports a checksum for every rendered frame and optionally
+ *  dumps the frames as PPM images.
+ *
+ *  Script format, one command per line:
+ *
+ *    key <name>    Press and release the key (SDL key name, e.g. Return)
+ *    text <utf-8>  Send text input
+ *    seed <n>      Start a new order of endless mode answers from seed n
+ *    frame [n]     Render n frames (default: 1)
+ *    # ...         Comment
+ *
+ *  Save and statistics files are neither read nor written, and the
+ *  date is fixed to the first daily word, so the checksums depend on
+ *  the script only.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include <stdio.h>
+#include "SDL.h"
+#include "game.h"
+
+#define HEADLESS_LINE_LENGTH 128
+#define HEADLESS_DAY         18797 // 2021-06-19, the first daily word
+
+void headless_prepare(void);
+int  headless_run(const char* script_file, const char* dump_path, game_t* core);
+void headless_push_key(SDL_Keycode key);
+void headless_push_text(const char* text);
+
+static int          capture_frame(Uint32 frame, const char* dump_path, game_t* core);
+static Uint32       checksum(const Uint8* data, size_t length);
+static unsigned int get_daily_index(void* user_data);
+static unsigned int get_day(void* user_data);
+static SDL_bool     run_frames(Uint32 count, Uint32* frame, Uint64* render_ticks, const char* dump_path, game_t* core);
+static char*        trim(char* line);
+
+void headless_prepare(void)
+{
+    SDL_SetHint(SDL_HINT_VIDEODRIVER,  "dummy");
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+}
+
+int headless_run(const char* script_file, const char* dump_path, game_t* core)
+{
+    FILE*  script;
+    char   line[HEADLESS_LINE_LENGTH];
+    Uint32 frame        = 0;
+    Uint64 render_ticks = 0;
+    double seconds;
+
+    if (NULL == core)
+    {
+        return 1;
+    }
+
+    script = fopen(script_file, "r");
+    if (NULL == script)
+    {
+        fprintf(stderr, "Could not open script %s\n", script_file);
+        return 1;
+    }
+
+    // The game was set up from the files before; start over without.
+    core->state.hooks.read_save          = NULL;
+    core->state.hooks.write_save         = NULL;
+    core->state.hooks.read_stats         = NULL;
+    core->state.hooks.append_stats       = NULL;
+    core->state.hooks.write_stats_header = NULL;
+    core->state.hooks.get_daily_index    = get_daily_index;
+    core->state.hooks.get_day            = get_day;
+
+    SDL_memset(&core->state.shuffle, 0, sizeof(core->state.shuffle));
+    SDL_memset(&core->state.stats, 0, sizeof(core->state.stats));
+    stats_load(core->state.wordlist.language, &core->state.hooks, &core->state.stats);
+
+    while (NULL != fgets(line, sizeof(line), script))
+    {
+        char* command = trim(line);
+        char* arg     = command;
+
+        if ('\0' == *command || '#' == *command)
+        {
+            continue;
+        }
+
+        while ('\0' != *arg && ' ' != *arg)
+        {
+            arg += 1;
+        }
+
+        if (' ' == *arg)
+        {
+            *arg++ = '\0';
+            arg    = trim(arg);
+        }
+
+        if (0 == SDL_strcmp(command, "key"))
+        {
+            SDL_Keycode key = SDL_GetKeyFromName(arg);
+
+            if (SDLK_UNKNOWN == key)
+            {
+                fprintf(stderr, "Unknown key: %s\n", arg);
+                continue;
+            }
+            headless_push_key(key);
+        }
+        else if (0 == SDL_strcmp(command, "text"))
+        {
+            headless_push_text(arg);
+        }
+        else if (0 == SDL_strcmp(command, "seed"))
+        {
+            core->state.seed = (unsigned int)SDL_strtoul(arg, NULL, 0);
+            SDL_memset(&core->state.shuffle, 0, sizeof(core->state.shuffle));
+        }
+        else if (0 == SDL_strcmp(command, "frame"))
+        {
+            Uint32 count = 1;
+
+            if ('\0' != *arg)
+            {
+                count = (Uint32)SDL_strtoul(arg, NULL, 0);
+            }
+
+            if (SDL_FALSE == run_frames(count, &frame, &render_ticks, dump_path, core))
+            {
+                break;
+            }
+        }
+        else
+        {
+            fprintf(stderr, "Unknown command: %s\n", command);
+        }
+    }
+    fclose(script);
+
+    seconds = (double)render_ticks / (double)SDL_GetPerformanceFrequency();
+    if (seconds > 0.0)
+    {
+        printf("%u frames in %.3f s (%.1f fps)\n", frame, seconds, (double)frame / seconds);
+    }
+
+    return 0;
+}
+
+static SDL_bool run_frames(Uint32 count, Uint32* frame, Uint64* render_ticks, const char* dump_path, game_t* core)
+{
+    Uint32 index;
+
+    for (index = 0; index < count; index += 1)
+    {
+        Uint64 start = SDL_GetPerformanceCounter();
+
+        if (0 != game_update(core))
+        {
+            return SDL_FALSE;
+        }
+        *render_ticks += SDL_GetPerformanceCounter() - start;
+
+        if (SDL_FALSE == game_is_running(core))
+        {
+            return SDL_FALSE;
+        }
+
+        if (0 != capture_frame(*frame, dump_path, core))
+        {
+            return SDL_FALSE;
+        }
+        *frame += 1;
+    }
+
+    return SDL_TRUE;
+}
+
+static int capture_frame(Uint32 frame, const char* dump_path, game_t* core)
+{
+    Uint8* pixels;
+    int    pitch  = WINDOW_WIDTH * 3;
+    size_t length = pitch * WINDOW_HEIGHT;
+    int    status = 0;
+
+    pixels = (Uint8*)SDL_malloc(length);
+    if (NULL == pixels)
+    {
+        return 1;
+    }
+
+#ifdef USE_FRAMEBUFFER
+    {
+        SDL_Surface* frame_copy = SDL_ConvertSurfaceFormat(core->screen, SDL_PIXELFORMAT_RGB24, 0);
+        int          row;
+
+        if (NULL == frame_copy)
+        {
+            SDL_free(pixels);
+            return 1;
+        }
+
+        for (row = 0; row < (int)WINDOW_HEIGHT; row += 1)
+        {
+            SDL_memcpy(pixels + (row * pitch), (Uint8*)frame_copy->pixels + (row * frame_copy->pitch), pitch);
+        }
+        SDL_FreeSurface(frame_copy);
+    }
+#else
+    // Read back the scene at native resolution, independent of the
+    // zoom factor of the window.
+    if (0 > SDL_SetRenderTarget(core->renderer, core->render_target))
+    {
+        SDL_free(pixels);
+        return 1;
+    }
+
+    status = SDL_RenderReadPixels(core->renderer, NULL, SDL_PIXELFORMAT_RGB24, pixels, pitch);
+    SDL_SetRenderTarget(core->renderer, NULL);
+
+    if (0 != status)
+    {
+        SDL_free(pixels);
+        return 1;
+    }
+#endif
+
+    printf("frame %05u %08x\n", frame, checksum(pixels, length));
+
+    if (NULL != dump_path)
+    {
+        char  file_name[256] = { 0 };
+        FILE* dump;
+
+        SDL_snprintf(file_name, sizeof(file_name), "%s/frame%05u.ppm", dump_path, frame);
+        dump = fopen(file_name, "wb");
+        if (NULL == dump)
+        {
+            status = 1;
+        }
+        else
+        {
+            fprintf(dump, "P6\n%u %u\n255\n", WINDOW_WIDTH, WINDOW_HEIGHT);
+            if (1 != fwrite(pixels, length, 1, dump))
+            {
+                status = 1;
+            }
+            fclose(dump);
+        }
+    }
+
+    SDL_free(pixels);
+    return status;
+}
+
+/* FNV-1a */
+static Uint32 checksum(const Uint8* data, size_t length)
+{
+    Uint32 hash = 0x811c9dc5;
+    size_t index;
+
+    for (index = 0; index < length; index += 1)
+    {
+        hash ^= data[index];
+        hash *= 0x01000193;
+    }
+
+    return hash;
+}
+
+static unsigned int get_daily_index(void* user_data)
+{
+    (void)user_data;
+    return 0;
+}
+
+static unsigned int get_day(void* user_data)
+{
+    (void)user_data;
+    return HEADLESS_DAY;
+}
+
+void headless_push_key(SDL_Keycode key)
+{
+    SDL_Event event;
+
+    SDL_memset(&event, 0, sizeof(event));
+    event.type           = SDL_KEYDOWN;
+    event.key.state      = SDL_PRESSED;
+    event.key.keysym.sym = key;
+    SDL_PushEvent(&event);
+
+    event.type           = SDL_KEYUP;
+    event.key.state      = SDL_RELEASED;
+    SDL_PushEvent(&event);
+}
+
+void headless_push_text(const char* text)
+{
+    SDL_Event event;
+
+    SDL_memset(&event, 0, sizeof(event));
+    event.type = SDL_TEXTINPUT;
+    SDL_strlcpy(event.text.text, text, sizeof(event.text.text));
+    SDL_PushEvent(&event);
+}
+
+static char* trim(char* line)
+{
+    size_t length;
+
+    while (' ' == *line || '\t' == *line)
+    {
+        line += 1;
+    }
+
+    length = SDL_strlen(line);
+    while (length > 0 && SDL_isspace((unsigned char)line[length - 1]))
+    {
+        line[length - 1] = '\0';
+        length -= 1;
+    }
+
+    return line;
+}
@@ -30,13 +30,72 @@ void main_loop_iter(void *core)
 #define RES_FILE "data.pfs"
 #endif
 
+extern void headless_prepare(void);
+extern int  headless_run(const char* script_file, const char* dump_path, game_t* core);
+extern int  replay_record_begin(const char* file_name, game_t* core);
+extern void replay_record_end(game_t* core);
+extern int  replay_run(const char* file_name, SDL_bool real_time, game_t* core);
+extern int  bench_run(Uint32 event_count, Uint32 rate, game_t* core);
+
 int main(int argc, char *argv[])
 {
-    int     status = 0;
-    game_t* core   = NULL;
+    int         status      = 0;
+    game_t*     core        = NULL;
+    const char* script_file = NULL;
+    const char* dump_path   = NULL;
+    const char* record_file = NULL;
+    const char* replay_file = NULL;
+    SDL_bool    real_time   = SDL_TRUE;
+    Uint32      bench_count = 0;
+    Uint32      bench_rate  = 30;
+    int         index;
+
+    // --headless <script> [--dump <directory>]
+    // --record <file>
+    // --replay <file> [--fast]
+    // --bench <events> [--rate <events per second>]
+    for (index = 1; index < argc; index += 1)
+    {
+        if ((0 == SDL_strcmp(argv[index], "--headless")) && ((index + 1) < argc))
+        {
+            index       += 1;
+            script_file  = argv[index];
+        }
+        else if ((0 == SDL_strcmp(argv[index], "--dump")) && ((index + 1) < argc))
+        {
+            index     += 1;
+            dump_path  = argv[index];
+        }
+        else if ((0 == SDL_strcmp(argv[index], "--record")) && ((index + 1) < argc))
+        {
+            index       += 1;
+            record_file  = argv[index];
+        }
+        else if ((0 == SDL_strcmp(argv[index], "--replay")) && ((index + 1) < argc))
+        {
+            index       += 1;
+            replay_file  = argv[index];
+        }
+        else if (0 == SDL_strcmp(argv[index], "--fast"))
+        {
+            real_time = SDL_FALSE;
+        }
+        else if ((0 == SDL_strcmp(argv[index], "--bench")) && ((index + 1) < argc))
+        {
+            index       += 1;
+            bench_count  = (Uint32)SDL_strtoul(argv[index], NULL, 0);
+        }
+        else if ((0 == SDL_strcmp(argv[index], "--rate")) && ((index + 1) < argc))
+        {
+            index      += 1;
+            bench_rate  = (Uint32)SDL_strtoul(argv[index], NULL, 0);
+        }
+    }
 
-    (void)argc;
-    (void)argv;
+    if (NULL != script_file || bench_count > 0)
+    {
+        headless_prepare();
+    }
 
     status = game_init(RES_FILE, "Wordle", &core);
     if (0 != status)
@@ -44,6 +103,33 @@ int main(int argc, char *argv[])
         goto quit;
     }
 
+    if (NULL != script_file)
+    {
+        status = headless_run(script_file, dump_path, core);
+        goto quit;
+    }
+
+    if (bench_count > 0)
+    {
+        status = bench_run(bench_count, bench_rate, core);
+        goto quit;
+    }
+
+    if (NULL != replay_file)
+    {
+        status = replay_run(replay_file, real_time, core);
+        goto quit;
+    }
+
+    if (NULL != record_file)
+    {
+        status = replay_record_begin(record_file, core);
+        if (0 != status)
+        {
+            goto quit;
+        }
+    }
+
 #ifdef __EMSCRIPTEN__
     emscripten_set_main_loop_arg(main_loop_iter, core, -1, 1);
 #else
@@ -58,6 +144,7 @@ int main(int argc, char *argv[])
 #endif
 
 quit:
+    replay_record_end(core);
     game_quit(core);
     return status;
 }
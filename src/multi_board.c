@@ -0,0 +1,218 @@
+/** @file multi_board.c
+ *
+ *  Multi-board mode: every guess is played on two, four or eight
+ *  boards at once, each with its own answer.
+ *
+ *  The answers are kept transposed, one Uint64 per letter position
+ *  with board n's letter in byte n, so a guess is scored against all
+ *  boards with a handful of 64-bit operations instead of one
+ *  score_guess() call per board.  Letters are never 0, so unused
+ *  boards never match.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL_stdinc.h"
+#include "game_core.h"
+
+#define LANES_01 (((Uint64)0x01010101 << 32) | 0x01010101)
+#define LANES_7F (((Uint64)0x7f7f7f7f << 32) | 0x7f7f7f7f)
+
+static Uint64 get_zero_lanes(Uint64 lanes);
+
+void multi_board_reset(Uint8 board_count, const wordlist_t* wordlist, unsigned int* seed, multi_board_t* multi)
+{
+    Uint8 board_index;
+    Uint8 other_index;
+    int   letter_index;
+
+    if (NULL == wordlist || NULL == seed || NULL == multi)
+    {
+        return;
+    }
+
+    SDL_memset(multi, 0, sizeof(multi_board_t));
+
+    if (0 == board_count || board_count > MULTI_BOARD_MAX)
+    {
+        return;
+    }
+
+    multi->board_count = board_count;
+    multi->row_count   = board_count + 5;
+
+    // All answers have to be different.
+    for (board_index = 0; board_index < board_count; board_index += 1)
+    {
+        board_t* board = &multi->board[board_index];
+
+        do
+        {
+            board->answer_index = get_random_below(wordlist->word_count, seed);
+
+            for (other_index = 0; other_index < board_index; other_index += 1)
+            {
+                if (multi->board[other_index].answer_index == board->answer_index)
+                {
+                    break;
+                }
+            }
+        }
+        while ((other_index < board_index) && (wordlist->word_count > board_count));
+
+        for (letter_index = 0; letter_index < 5; letter_index += 1)
+        {
+            multi->answer_letter[letter_index] |= (Uint64)wordlist->list[board->answer_index][letter_index] << (board_index * 8);
+        }
+    }
+}
+
+// Plays a guess on all unsolved boards.  Returns SDL_TRUE once the
+// game has ended.
+SDL_bool multi_board_guess(const unsigned char* guess, multi_board_t* multi)
+{
+    Uint8 pattern[MULTI_BOARD_MAX];
+    Uint8 solved;
+    Uint8 board_index;
+
+    if (NULL == guess || NULL == multi || 0 == multi->board_count)
+    {
+        return SDL_TRUE;
+    }
+
+    if (SDL_TRUE == multi_board_has_ended(multi))
+    {
+        return SDL_TRUE;
+    }
+
+    solved = score_guess_boards(guess, multi->answer_letter, pattern);
+
+    SDL_memcpy(multi->guess[multi->attempt], guess, 5);
+
+    for (board_index = 0; board_index < multi->board_count; board_index += 1)
+    {
+        board_t* board = &multi->board[board_index];
+
+        if (0 != board->solved_rows)
+        {
+            continue;
+        }
+
+        board->pattern[multi->attempt] = pattern[board_index];
+        if (0 != (solved & (1 << board_index)))
+        {
+            board->solved_rows = multi->attempt + 1;
+        }
+    }
+
+    multi->attempt += 1;
+
+    return multi_board_has_ended(multi);
+}
+
+SDL_bool multi_board_has_ended(const multi_board_t* multi)
+{
+    Uint8 board_index;
+
+    if (NULL == multi || multi->attempt >= multi->row_count)
+    {
+        return SDL_TRUE;
+    }
+
+    for (board_index = 0; board_index < multi->board_count; board_index += 1)
+    {
+        if (0 == multi->board[board_index].solved_rows)
+        {
+            return SDL_FALSE;
+        }
+    }
+
+    return SDL_TRUE;
+}
+
+// Scores a guess against up to MULTI_BOARD_MAX answers, see
+// multi_board_reset() for the layout.  Fills in one pattern per board,
+// see get_pattern_code(), and returns a mask of the solved boards.
+// Gives the same result as score_guess() for each board.
+Uint8 score_guess_boards(const unsigned char* guess, const Uint64 answer_letter[5], Uint8 pattern[MULTI_BOARD_MAX])
+{
+    const Uint64 weight[5] = { 1, 3, 9, 27, 81 };
+    Uint64       correct[5];
+    Uint64       remaining[5];
+    Uint64       code = 0;
+    Uint8        solved = 0;
+    int          letter_index;
+    int          temp_index;
+
+    // First check for exact matches.  Matched letters are removed from
+    // the remaining ones.
+    for (letter_index = 0; letter_index < 5; letter_index += 1)
+    {
+        correct[letter_index]   = get_zero_lanes(answer_letter[letter_index] ^ (guess[letter_index] * LANES_01)) >> 7;
+        remaining[letter_index] = answer_letter[letter_index] & ~(correct[letter_index] * 0xff);
+        code                   += correct[letter_index] * (weight[letter_index] * 2);
+    }
+
+    // Then check for matches in the wrong location.
+    for (letter_index = 0; letter_index < 5; letter_index += 1)
+    {
+        Uint64 broadcast = guess[letter_index] * LANES_01;
+        Uint64 misplaced = 0;
+
+        for (temp_index = 0; temp_index < 5; temp_index += 1)
+        {
+            misplaced |= get_zero_lanes(remaining[temp_index] ^ broadcast);
+        }
+
+        misplaced  = (misplaced >> 7) & ~correct[letter_index];
+        code      += misplaced * weight[letter_index];
+    }
+
+    // No lane exceeds 242, so the sums never carry into the next one.
+    for (letter_index = 0; letter_index < MULTI_BOARD_MAX; letter_index += 1)
+    {
+        pattern[letter_index] = (Uint8)(code >> (letter_index * 8));
+
+        if (242 == pattern[letter_index])
+        {
+            solved |= (Uint8)(1 << letter_index);
+        }
+    }
+
+    return solved;
+}
+
+// Inverse of get_pattern_code().
+void get_pattern_states(Uint8 pattern, state_t result[5])
+{
+    int letter_index;
+
+    for (letter_index = 0; letter_index < 5; letter_index += 1)
+    {
+        switch (pattern % 3)
+        {
+            default:
+            case 0:
+                result[letter_index] = WRONG_LETTER;
+                break;
+            case 1:
+                result[letter_index] = WRONG_POSITION;
+                break;
+            case 2:
+                result[letter_index] = CORRECT_LETTER;
+                break;
+        }
+
+        pattern /= 3;
+    }
+}
+
+// Sets the top bit of every byte that is 0, and clears everything
+// else.  Unlike the usual (x - 0x01..) & ~x trick, there are no false
+// positives next to a zero byte.
+static Uint64 get_zero_lanes(Uint64 lanes)
+{
+    return ~(((lanes & LANES_7F) + LANES_7F) | lanes | LANES_7F);
+}
@@ -0,0 +1,304 @@
+/** @file opening_book.c
+ *
+ *  Best first guess of a word list and the best second guess for
+ *  every pattern the first one can produce.  Ranking every allowed word
+ *  against every answer is the most expensive solver step, so the book
+ *  is computed once per word list and cached through the front end's
+ *  hooks.
+ *
+ *  Cache format, all values little-endian:
+ *
+ *    "WBOK" version:u8 language:u8 reserved:u16 checksum:u32
+ *    first:u16 second[OPENING_BOOK_PATTERNS]:u16
+ *
+ *  Guesses are indices into the answers, followed by the allowed
+ *  guesses, see get_guess_word().
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL_stdinc.h"
+#include "game_core.h"
+
+#define OPENING_BOOK_VERSION 1
+#define OPENING_BOOK_CHUNKS  64
+#define OPENING_BOOK_SIZE    (12 + 2 + (OPENING_BOOK_PATTERNS * 2))
+#define OPENING_BOOK_SOLVED  242
+
+typedef struct ranking
+{
+    Uint32 guess;
+    Uint32 score;
+
+} ranking_t;
+
+typedef struct book_job
+{
+    const wordlist_t* wordlist;
+    Uint32            guess_count;
+    Uint16*           answer;
+    Uint32            answer_count;
+    ranking_t         chunk[OPENING_BOOK_CHUNKS];
+    opening_book_t*   book;
+
+} book_job_t;
+
+static void      rank_chunk(Uint32 index, void* data);
+static void      rank_second(Uint32 index, void* data);
+static ranking_t rank_guesses(const wordlist_t* wordlist, Uint32 first_guess, Uint32 last_guess, const Uint16* answer, Uint32 answer_count);
+static void      run_tasks(void (*task)(Uint32 index, void* data), Uint32 count, void* data, const game_hooks_t* hooks);
+
+// Uses the cached book if it matches the word list, otherwise builds
+// and caches a new one.  Without cache hooks, no book is used.
+void opening_book_load(const wordlist_t* wordlist, const game_hooks_t* hooks, opening_book_t* book)
+{
+    Uint8  buffer[OPENING_BOOK_SIZE];
+    Uint32 checksum;
+    int    index;
+
+    if (NULL == wordlist || NULL == hooks || NULL == book)
+    {
+        return;
+    }
+
+    if ((SDL_TRUE == book->is_valid) && (wordlist->language == book->language))
+    {
+        return;
+    }
+
+    book->is_valid = SDL_FALSE;
+
+    if (NULL == hooks->read_book || NULL == hooks->write_book)
+    {
+        return;
+    }
+
+    checksum = get_wordlist_checksum(wordlist);
+
+    if ((OPENING_BOOK_SIZE == hooks->read_book(wordlist->language, buffer, sizeof(buffer), hooks->user_data)) &&
+        (0 == SDL_memcmp(buffer, "WBOK", 4)) &&
+        (OPENING_BOOK_VERSION == buffer[4]) &&
+        ((Uint8)wordlist->language == buffer[5]) &&
+        (checksum == ((Uint32)buffer[8] | ((Uint32)buffer[9] << 8) | ((Uint32)buffer[10] << 16) | ((Uint32)buffer[11] << 24))))
+    {
+        book->language = wordlist->language;
+        book->checksum = checksum;
+        book->first    = (Uint16)(buffer[12] | (buffer[13] << 8));
+
+        for (index = 0; index < OPENING_BOOK_PATTERNS; index += 1)
+        {
+            book->second[index] = (Uint16)(buffer[14 + (index * 2)] | (buffer[15 + (index * 2)] << 8));
+        }
+
+        book->is_valid = SDL_TRUE;
+        return;
+    }
+
+    opening_book_build(wordlist, hooks, book);
+    if (SDL_FALSE == book->is_valid)
+    {
+        return;
+    }
+
+    SDL_memcpy(buffer, "WBOK", 4);
+    buffer[4]  = OPENING_BOOK_VERSION;
+    buffer[5]  = (Uint8)wordlist->language;
+    buffer[6]  = 0;
+    buffer[7]  = 0;
+    buffer[8]  = (Uint8)checksum;
+    buffer[9]  = (Uint8)(checksum >> 8);
+    buffer[10] = (Uint8)(checksum >> 16);
+    buffer[11] = (Uint8)(checksum >> 24);
+    buffer[12] = (Uint8)book->first;
+    buffer[13] = (Uint8)(book->first >> 8);
+
+    for (index = 0; index < OPENING_BOOK_PATTERNS; index += 1)
+    {
+        buffer[14 + (index * 2)] = (Uint8)book->second[index];
+        buffer[15 + (index * 2)] = (Uint8)(book->second[index] >> 8);
+    }
+
+    hooks->write_book(wordlist->language, buffer, sizeof(buffer), hooks->user_data);
+}
+
+// Guesses are ranked by the expected number of answers left, so the
+// result does not depend on how the work is split up.
+void opening_book_build(const wordlist_t* wordlist, const game_hooks_t* hooks, opening_book_t* book)
+{
+    book_job_t job;
+    ranking_t  best;
+    Uint32     index;
+
+    if (NULL == wordlist || NULL == book)
+    {
+        return;
+    }
+
+    book->is_valid = SDL_FALSE;
+
+    SDL_memset(&job, 0, sizeof(job));
+    job.wordlist     = wordlist;
+    job.guess_count  = wordlist->word_count + ((NULL != wordlist->allowed_list) ? wordlist->allowed_count : 0);
+    job.answer_count = wordlist->word_count;
+    job.answer       = (Uint16*)SDL_malloc(job.answer_count * sizeof(Uint16));
+    job.book         = book;
+
+    if (NULL == job.answer || job.guess_count > OPENING_BOOK_NONE)
+    {
+        SDL_free(job.answer);
+        return;
+    }
+
+    for (index = 0; index < job.answer_count; index += 1)
+    {
+        job.answer[index] = (Uint16)index;
+    }
+
+    run_tasks(rank_chunk, OPENING_BOOK_CHUNKS, &job, hooks);
+
+    best = job.chunk[0];
+    for (index = 1; index < OPENING_BOOK_CHUNKS; index += 1)
+    {
+        if (job.chunk[index].score < best.score)
+        {
+            best = job.chunk[index];
+        }
+    }
+    book->first = (Uint16)best.guess;
+
+    run_tasks(rank_second, OPENING_BOOK_PATTERNS, &job, hooks);
+
+    book->language = wordlist->language;
+    book->checksum = get_wordlist_checksum(wordlist);
+    book->is_valid = SDL_TRUE;
+
+    SDL_free(job.answer);
+}
+
+// Returns the book's guess for the first or second attempt, or NULL.
+// The second guess assumes that the first one was played.
+const unsigned char* opening_book_guess(const opening_book_t* book, const wordlist_t* wordlist, Uint8 attempt, Uint8 first_pattern)
+{
+    if (NULL == book || SDL_FALSE == book->is_valid || wordlist->language != book->language)
+    {
+        return NULL;
+    }
+
+    if (0 == attempt)
+    {
+        return get_guess_word(wordlist, book->first);
+    }
+
+    if (1 == attempt && first_pattern < OPENING_BOOK_PATTERNS && OPENING_BOOK_NONE != book->second[first_pattern])
+    {
+        return get_guess_word(wordlist, book->second[first_pattern]);
+    }
+
+    return NULL;
+}
+
+static void rank_chunk(Uint32 index, void* data)
+{
+    book_job_t* job         = (book_job_t*)data;
+    Uint32      first_guess = (Uint32)(((Uint64)job->guess_count * index) / OPENING_BOOK_CHUNKS);
+    Uint32      last_guess  = (Uint32)(((Uint64)job->guess_count * (index + 1)) / OPENING_BOOK_CHUNKS);
+
+    job->chunk[index] = rank_guesses(job->wordlist, first_guess, last_guess, job->answer, job->answer_count);
+}
+
+static void rank_second(Uint32 index, void* data)
+{
+    book_job_t*          job   = (book_job_t*)data;
+    const unsigned char* first = get_guess_word(job->wordlist, job->book->first);
+    Uint16*              answer;
+    Uint32               answer_count = 0;
+    Uint32               answer_index;
+    state_t              result[5];
+
+    job->book->second[index] = OPENING_BOOK_NONE;
+
+    if (OPENING_BOOK_SOLVED == index)
+    {
+        return;
+    }
+
+    answer = (Uint16*)SDL_malloc(job->answer_count * sizeof(Uint16));
+    if (NULL == answer)
+    {
+        return;
+    }
+
+    for (answer_index = 0; answer_index < job->answer_count; answer_index += 1)
+    {
+        score_guess(first, job->wordlist->list[answer_index], result);
+        if (index == get_pattern_code(result))
+        {
+            answer[answer_count++] = (Uint16)answer_index;
+        }
+    }
+
+    if (answer_count > 0)
+    {
+        job->book->second[index] = (Uint16)rank_guesses(job->wordlist, 0, job->guess_count, answer, answer_count).guess;
+    }
+
+    SDL_free(answer);
+}
+
+// The score is twice the sum of the squared partition sizes, plus one
+// if the guess cannot be the answer.  Lower is better; ties go to the
+// lower index.
+static ranking_t rank_guesses(const wordlist_t* wordlist, Uint32 first_guess, Uint32 last_guess, const Uint16* answer, Uint32 answer_count)
+{
+    ranking_t best = { 0, 0xffffffff };
+    Uint16    partition_count[OPENING_BOOK_PATTERNS];
+    Uint32    guess_index;
+
+    for (guess_index = first_guess; guess_index < last_guess; guess_index += 1)
+    {
+        const unsigned char* guess = get_guess_word(wordlist, guess_index);
+        Uint32               score = 0;
+        Uint32               index;
+        state_t              result[5];
+
+        SDL_memset(partition_count, 0, sizeof(partition_count));
+        for (index = 0; index < answer_count; index += 1)
+        {
+            score_guess(guess, wordlist->list[answer[index]], result);
+            partition_count[get_pattern_code(result)] += 1;
+        }
+
+        for (index = 0; index < OPENING_BOOK_PATTERNS; index += 1)
+        {
+            score += (Uint32)partition_count[index] * partition_count[index];
+        }
+
+        score = (score * 2) + ((0 == partition_count[OPENING_BOOK_SOLVED]) ? 1 : 0);
+
+        if (score < best.score)
+        {
+            best.guess = guess_index;
+            best.score = score;
+        }
+    }
+
+    return best;
+}
+
+static void run_tasks(void (*task)(Uint32 index, void* data), Uint32 count, void* data, const game_hooks_t* hooks)
+{
+    Uint32 index;
+
+    if (NULL != hooks && NULL != hooks->run_tasks)
+    {
+        hooks->run_tasks(task, count, data, hooks->user_data);
+        return;
+    }
+
+    for (index = 0; index < count; index += 1)
+    {
+        task(index, data);
+    }
+}
@@ -15,7 +15,12 @@ void osd_print(const char* display_text, const int pos_x, const int pos_y, game_
 
 static void get_character_position(const unsigned char character, int* pos_x, int* pos_y);
 
-extern int load_texture_from_file(const char* file_name, SDL_Texture** texture, game_t* core);
+extern int  load_texture_from_file(const char* file_name, image_t** texture, game_t* core);
+#ifdef USE_FRAMEBUFFER
+extern void fb_blit(SDL_Surface* image, const SDL_Rect* src, const SDL_Rect* dst, game_t* core);
+extern void fb_fill_rect(const SDL_Rect* rect, Uint8 r, Uint8 g, Uint8 b, game_t* core);
+extern void fb_draw_rect(const SDL_Rect* rect, Uint8 r, Uint8 g, Uint8 b, game_t* core);
+#endif
 
 int osd_init(game_t* core)
 {
@@ -31,26 +36,12 @@ void osd_print(const char* display_text, const int pos_x, const int pos_y, game_
     size_t   text_length = SDL_strlen(display_text);
     SDL_Rect src         = { 0, 0, 7, 9 };
 
-    SDL_Rect dst         = {
-        (pos_x * core->zoom_factor) + (1 * core->zoom_factor),
-        (pos_y * core->zoom_factor) + (1 * core->zoom_factor),
-        7 * core->zoom_factor,
-        9 * core->zoom_factor
-    };
-
-    SDL_Rect frame = {
-        pos_x * core->zoom_factor,
-        pos_y * core->zoom_factor,
-        (text_length * (7 * core->zoom_factor)) + (2 * core->zoom_factor),
-        11 * core->zoom_factor
-    };
-
-    SDL_Rect background = {
-        pos_x * core->zoom_factor,
-        pos_y * core->zoom_factor,
-        (text_length * (7 * core->zoom_factor)) + (2 * core->zoom_factor),
-        11 * core->zoom_factor
-    };
+    SDL_Rect dst         = { pos_x + 1, pos_y + 1, 7, 9 };
+    SDL_Rect frame       = { pos_x, pos_y, (text_length * 7) + 2, 11 };
+    SDL_Rect background  = { pos_x, pos_y, (text_length * 7) + 2, 11 };
+#ifdef USE_FRAMEBUFFER
+    const unsigned char* character = (const unsigned char*)display_text;
+#endif
 
     if (NULL == core)
     {
@@ -62,20 +53,45 @@ void osd_print(const char* display_text, const int pos_x, const int pos_y, game_
         return;
     }
 
+#ifdef USE_FRAMEBUFFER
+    fb_fill_rect(&background, 0xff, 0xff, 0xff, core);
+    fb_draw_rect(&frame, 0x84, 0x8a, 0x8c, core);
+
+    // Tiles below the text need to be restored once it changes or is
+    // gone, see restore_osd().
+    if (core->osd_count < FB_MAX_OSD_RECTS)
+    {
+        core->osd_rect[core->osd_count] = background;
+    }
+    core->osd_count += 1;
+
+    core->osd_hash = (core->osd_hash ^ (Uint32)pos_x) * 0x01000193;
+    core->osd_hash = (core->osd_hash ^ (Uint32)pos_y) * 0x01000193;
+    for (; '\0' != *character; character += 1)
+    {
+        core->osd_hash = (core->osd_hash ^ *character) * 0x01000193;
+    }
+#else
     SDL_SetRenderDrawColor(core->renderer, 0xff, 0xff, 0xff, 0x00);
     SDL_RenderFillRect(core->renderer, &background);
     SDL_RenderDrawRect(core->renderer, &background);
     SDL_SetRenderDrawColor(core->renderer, 0x84, 0x8a, 0x8c, 0x00);
     SDL_RenderDrawRect(core->renderer, &frame);
     SDL_RenderDrawRect(core->renderer, &frame);
+#endif
 
     while ('\0' != display_text[char_index])
     {
         get_character_position(display_text[char_index], &src.x, &src.y);
         char_index += 1;
 
+#ifdef USE_FRAMEBUFFER
+        fb_blit(core->font_texture, &src, &dst, core);
+#else
+        CHECK_BLIT_FORMAT(core->font_texture, core);
         SDL_RenderCopy(core->renderer, core->font_texture, &src, &dst);
-        dst.x += (7 * core->zoom_factor);
+#endif
+        dst.x += 7;
     }
 }
 
@@ -13,24 +13,23 @@
 #include <string.h>
 #include <errno.h>
 #include "SDL.h"
+#include "game.h"
 
-#define kDataPath_MaxLength 256
+void       init_file_reader(pfs_t * pfs, const char * dataFilePath);
+size_t     size_of_file(const pfs_t * pfs, const char * path);
+Uint8     *load_binary_file_from_path(const pfs_t * pfs, const char * path, arena_t * arena);
+SDL_RWops *open_binary_file_from_path(const pfs_t * pfs, const char * path);
 
-char mDataPath[kDataPath_MaxLength];
+extern void *arena_alloc(size_t size, arena_t *arena);
 
-void       init_file_reader(const char * dataFilePath);
-size_t     size_of_file(const char * path);
-Uint8     *load_binary_file_from_path(const char * path);
-SDL_RWops *open_binary_file_from_path(const char * path);
-
-void init_file_reader(const char * dataFilePath)
+void init_file_reader(pfs_t * pfs, const char * dataFilePath)
 {
-    sprintf(mDataPath, "%s", dataFilePath);
+    SDL_strlcpy(pfs->dataPath, dataFilePath, sizeof(pfs->dataPath));
 }
 
-size_t size_of_file(const char * path)
+size_t size_of_file(const pfs_t * pfs, const char * path)
 {
-    SDL_RWops *mDataPack = SDL_RWFromFile(mDataPath, "rb");
+    SDL_RWops *mDataPack = SDL_RWFromFile(pfs->dataPath, "rb");
     char       buffer[85];
     int        c;
     Uint32     size      = 0;
@@ -86,9 +85,9 @@ found:
     return size;
 }
 
-Uint8 *load_binary_file_from_path(const char * path)
+Uint8 *load_binary_file_from_path(const pfs_t * pfs, const char * path, arena_t * arena)
 {
-    SDL_RWops *mDataPack = SDL_RWFromFile(mDataPath, "rb");
+    SDL_RWops *mDataPack = SDL_RWFromFile(pfs->dataPath, "rb");
     Uint32     offset    = 0;
     Uint16     entries   = 0;
     char       buffer[85];
@@ -140,7 +139,8 @@ found:
         /* Nothing to do here. */
     }
 
-    toReturn = (Uint8 *) malloc(size);
+    /* Released with arena_free(), see arena.c. */
+    toReturn = (Uint8 *) arena_alloc(size, arena);
 
     if (size != SDL_RWread(mDataPack, toReturn, sizeof(Uint8), size))
     {
@@ -152,9 +152,9 @@ found:
     return toReturn;
 }
 
-SDL_RWops *open_binary_file_from_path(const char * path)
+SDL_RWops *open_binary_file_from_path(const pfs_t * pfs, const char * path)
 {
-    SDL_RWops *mDataPack = SDL_RWFromFile(mDataPath, "rb");
+    SDL_RWops *mDataPack = SDL_RWFromFile(pfs->dataPath, "rb");
     Uint32     offset    = 0;
     Uint16     entries   = 0;
     char       buffer[85];
@@ -191,6 +191,7 @@ SDL_RWops *open_binary_file_from_path(const char * path)
         }
     }
 
+    SDL_RWclose(mDataPack);
     return NULL;
 
 found:
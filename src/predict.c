@@ -0,0 +1,253 @@
+/** @file predict.c
+ *
+ *  Predictive keypad input: a prefix trie over all allowed words of a
+ *  language, so that the number keys only offer letters which can
+ *  still form a word, most frequent first.
+ *
+ *  Each node stores a mask of the letters that may follow and the
+ *  index of its first child; siblings are stored next to each other,
+ *  so a child is found by counting the bits below its letter.  Full
+ *  words are not stored as nodes, only their weight.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL_stdinc.h"
+#include "game_core.h"
+
+#define PREDICT_NONE 0xffff
+
+static Uint16 get_child(const predict_t* predict, Uint16 node, Uint8 code);
+static Uint16 get_node(const predict_t* predict, const unsigned char* prefix, int length);
+static Uint8  count_bits(Uint64 mask);
+
+// Builds the trie one level at a time: the letters following each
+// node are collected first, then the next level is laid out, so no
+// sorting or temporary memory is needed.  Answers weigh twice as much
+// as other allowed words.
+void predict_build(const wordlist_t* wordlist, predict_t* predict)
+{
+    Uint32 word_count;
+    Uint32 word_index;
+    Uint32 next_node;
+    Uint16 level_start = 0;
+    Uint16 node;
+    Uint8  next_code   = 1;
+    int    depth;
+
+    if (NULL == wordlist || NULL == predict)
+    {
+        return;
+    }
+
+    if ((SDL_TRUE == predict->is_valid) && (wordlist->language == predict->language))
+    {
+        return;
+    }
+
+    predict->is_valid      = SDL_FALSE;
+    predict->node_count    = 1;
+    predict->leaf_count    = 0;
+    predict->child_mask[0] = 0;
+    predict->weight[0]     = 0;
+
+    SDL_memset(predict->letter_code, 0, sizeof(predict->letter_code));
+
+    word_count = wordlist->word_count + ((NULL != wordlist->allowed_list) ? wordlist->allowed_count : 0);
+
+    for (word_index = 0; word_index < word_count; word_index += 1)
+    {
+        const unsigned char* word = get_guess_word(wordlist, word_index);
+        int                  letter_index;
+
+        for (letter_index = 0; letter_index < 5; letter_index += 1)
+        {
+            if (0 == predict->letter_code[word[letter_index]])
+            {
+                if (next_code > 64)
+                {
+                    return;
+                }
+                predict->letter_code[word[letter_index]] = next_code;
+                next_code                               += 1;
+            }
+        }
+    }
+
+    for (depth = 0; depth < 5; depth += 1)
+    {
+        Uint16 level_end = predict->node_count;
+
+        for (word_index = 0; word_index < word_count; word_index += 1)
+        {
+            const unsigned char* word = get_guess_word(wordlist, word_index);
+            Uint8                code = predict->letter_code[word[depth]];
+
+            node = get_node(predict, word, depth);
+
+            predict->child_mask[node] |= (Uint64)1 << (code - 1);
+            predict->weight[node]     += (word_index < wordlist->word_count) ? 2 : 1;
+        }
+
+        next_node = level_end;
+        if (4 == depth)
+        {
+            next_node = 0;
+        }
+
+        for (node = level_start; node < level_end; node += 1)
+        {
+            predict->first_child[node]  = (Uint16)next_node;
+            next_node                  += count_bits(predict->child_mask[node]);
+        }
+
+        if (4 == depth)
+        {
+            if (next_node > PREDICT_MAX_LEAVES)
+            {
+                return;
+            }
+            predict->leaf_count = (Uint16)next_node;
+            SDL_memset(predict->leaf_weight, 0, next_node);
+        }
+        else
+        {
+            if (next_node > PREDICT_MAX_NODES)
+            {
+                return;
+            }
+
+            for (node = level_end; node < next_node; node += 1)
+            {
+                predict->child_mask[node] = 0;
+                predict->weight[node]     = 0;
+            }
+            predict->node_count = (Uint16)next_node;
+        }
+
+        level_start = level_end;
+    }
+
+    for (word_index = 0; word_index < word_count; word_index += 1)
+    {
+        const unsigned char* word = get_guess_word(wordlist, word_index);
+        Uint16               leaf = get_child(predict, get_node(predict, word, 4), predict->letter_code[word[4]]);
+
+        if (predict->leaf_weight[leaf] < 0xff - 1)
+        {
+            predict->leaf_weight[leaf] += (word_index < wordlist->word_count) ? 2 : 1;
+        }
+    }
+
+    predict->language = wordlist->language;
+    predict->is_valid = SDL_TRUE;
+}
+
+// Fills in the letters from start_char to end_char which can follow
+// the prefix, most frequent first.  Returns the number of letters, 0
+// if the prefix does not start any word.
+Uint8 predict_letters(const predict_t* predict, const unsigned char* prefix, int length, unsigned char start_char, unsigned char end_char, unsigned char letter[PREDICT_MAX_LETTERS])
+{
+    Uint16 weight[PREDICT_MAX_LETTERS];
+    Uint16 node;
+    Uint8  count = 0;
+    int    current_char;
+
+    if (NULL == predict || NULL == prefix || SDL_FALSE == predict->is_valid || length < 0 || length > 4)
+    {
+        return 0;
+    }
+
+    node = get_node(predict, prefix, length);
+    if (PREDICT_NONE == node)
+    {
+        return 0;
+    }
+
+    for (current_char = start_char; current_char <= end_char && count < PREDICT_MAX_LETTERS; current_char += 1)
+    {
+        Uint16 child = get_child(predict, node, predict->letter_code[current_char]);
+        Uint16 child_weight;
+        int    slot;
+
+        if (PREDICT_NONE == child)
+        {
+            continue;
+        }
+
+        child_weight = (4 == length) ? predict->leaf_weight[child] : predict->weight[child];
+
+        // Insert, keeping the list sorted by weight.  Ties stay in
+        // alphabetical order.
+        slot = count;
+        while (slot > 0 && weight[slot - 1] < child_weight)
+        {
+            weight[slot] = weight[slot - 1];
+            letter[slot] = letter[slot - 1];
+            slot        -= 1;
+        }
+
+        weight[slot]  = child_weight;
+        letter[slot]  = (unsigned char)current_char;
+        count        += 1;
+    }
+
+    return count;
+}
+
+// Returns the index of the child, which is a leaf below the fourth
+// level, or PREDICT_NONE.
+static Uint16 get_child(const predict_t* predict, Uint16 node, Uint8 code)
+{
+    Uint64 bit;
+
+    if (PREDICT_NONE == node || 0 == code)
+    {
+        return PREDICT_NONE;
+    }
+
+    bit = (Uint64)1 << (code - 1);
+    if (0 == (predict->child_mask[node] & bit))
+    {
+        return PREDICT_NONE;
+    }
+
+    return predict->first_child[node] + count_bits(predict->child_mask[node] & (bit - 1));
+}
+
+static Uint16 get_node(const predict_t* predict, const unsigned char* prefix, int length)
+{
+    Uint16 node = 0;
+    int    index;
+
+    for (index = 0; index < length; index += 1)
+    {
+        node = get_child(predict, node, predict->letter_code[prefix[index]]);
+    }
+
+    return node;
+}
+
+static Uint8 count_bits(Uint64 mask)
+{
+    Uint32 half[2];
+    Uint8  count = 0;
+    int    index;
+
+    half[0] = (Uint32)mask;
+    half[1] = (Uint32)(mask >> 32);
+
+    for (index = 0; index < 2; index += 1)
+    {
+        Uint32 bits = half[index];
+
+        bits   = bits - ((bits >> 1) & 0x55555555);
+        bits   = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+        bits   = (bits + (bits >> 4)) & 0x0f0f0f0f;
+        count += (Uint8)((bits * 0x01010101) >> 24);
+    }
+
+    return count;
+}
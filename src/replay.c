@@ -0,0 +1,389 @@
+/** @file replay.c
+ *
+ *  Records the input applied to the game into a compact binary log and
+ *  plays it back, either in real time or as fast as possible.
+ *
+ *  Log format, all values little-endian:
+ *
+ *    "WRPL" version:u8 seed:u32 daily_index:u32
+ *    record*
+ *
+ *  Each record starts with its type (u8) and the milliseconds since the
+ *  previous record (varint):
+ *
+ *    REPLAY_INPUT  event:u8, followed by count:u8 for letter cycling
+ *                  or text:u16 for text input
+ *    REPLAY_SAVE   daily:u8 size:varint data[size], the data returned
+ *                  by the front end when the game loaded a save state
+ *    REPLAY_END
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include <stdio.h>
+#include "SDL.h"
+#include "game.h"
+
+#define REPLAY_VERSION   1
+#define REPLAY_FIRST_DAY 18797 // 2021-06-19, the first daily word
+
+typedef enum
+{
+    REPLAY_END = 0,
+    REPLAY_INPUT,
+    REPLAY_SAVE
+
+} replay_record_t;
+
+int  replay_record_begin(const char* file_name, game_t* core);
+void replay_record_input(const input_t* input, game_t* core);
+void replay_record_end(game_t* core);
+int  replay_run(const char* file_name, SDL_bool real_time, game_t* core);
+
+static size_t       record_read_save(SDL_bool daily, void* buffer, size_t size, void* user_data);
+static void         record_write_save(SDL_bool daily, const void* buffer, size_t size, void* user_data);
+static void         record_header(replay_record_t type, game_t* core);
+static unsigned int replay_get_daily_index(void* user_data);
+static unsigned int replay_get_day(void* user_data);
+static size_t       replay_read_save(SDL_bool daily, void* buffer, size_t size, void* user_data);
+static void         forward_text_input(SDL_bool enabled, void* user_data);
+static SDL_bool     read_u8(SDL_RWops* rw, Uint8* value);
+static SDL_bool     read_varint(SDL_RWops* rw, Uint32* value);
+static void         write_varint(SDL_RWops* rw, Uint32 value);
+
+int replay_record_begin(const char* file_name, game_t* core)
+{
+    if (NULL == core)
+    {
+        return 1;
+    }
+
+    core->record = SDL_RWFromFile(file_name, "wb");
+    if (NULL == core->record)
+    {
+        SDL_Log("Could not create %s: %s", file_name, SDL_GetError());
+        return 1;
+    }
+
+    SDL_RWwrite(core->record, "WRPL", 4, 1);
+    SDL_WriteU8(core->record, REPLAY_VERSION);
+    SDL_WriteLE32(core->record, core->state.seed);
+    SDL_WriteLE32(core->record, game_state_daily_index(&core->state));
+
+    // The answer order is derived from the seed alone, see shuffle.c.
+    SDL_memset(&core->state.shuffle, 0, sizeof(core->state.shuffle));
+
+    // Save states read while recording become part of the log, so a
+    // replay does not depend on the save files on the machine.
+    core->hooks                       = core->state.hooks;
+    core->state.hooks.user_data       = core;
+    core->state.hooks.set_text_input  = forward_text_input;
+    if (NULL != core->hooks.read_save)
+    {
+        core->state.hooks.read_save   = record_read_save;
+    }
+    if (NULL != core->hooks.write_save)
+    {
+        core->state.hooks.write_save  = record_write_save;
+    }
+
+    core->record_ticks = SDL_GetTicks();
+
+    return 0;
+}
+
+void replay_record_input(const input_t* input, game_t* core)
+{
+    record_header(REPLAY_INPUT, core);
+    SDL_WriteU8(core->record, (Uint8)input->type);
+
+    switch (input->type)
+    {
+        case EVENT_NEXT_LETTER:
+        case EVENT_PREV_LETTER:
+            SDL_WriteU8(core->record, input->count);
+            break;
+        case EVENT_TEXTINPUT:
+            SDL_WriteLE16(core->record, input->text);
+            break;
+        default:
+            break;
+    }
+}
+
+void replay_record_end(game_t* core)
+{
+    if (NULL == core || NULL == core->record)
+    {
+        return;
+    }
+
+    record_header(REPLAY_END, core);
+    SDL_RWclose(core->record);
+    core->record      = NULL;
+    core->state.hooks = core->hooks;
+}
+
+int replay_run(const char* file_name, SDL_bool real_time, game_t* core)
+{
+    char   magic[4];
+    Uint8  version;
+    Uint32 input_count = 0;
+    Uint32 target_ticks;
+    Uint64 start;
+    int    status      = 0;
+
+    if (NULL == core)
+    {
+        return 1;
+    }
+
+    core->replay = SDL_RWFromFile(file_name, "rb");
+    if (NULL == core->replay)
+    {
+        SDL_Log("Could not open %s: %s", file_name, SDL_GetError());
+        return 1;
+    }
+
+    if ((1 != SDL_RWread(core->replay, magic, 4, 1)) ||
+        (0 != SDL_memcmp(magic, "WRPL", 4)) ||
+        (SDL_FALSE == read_u8(core->replay, &version)) ||
+        (REPLAY_VERSION != version))
+    {
+        SDL_Log("%s is not a supported replay", file_name);
+        SDL_RWclose(core->replay);
+        core->replay = NULL;
+        return 1;
+    }
+
+    core->state.seed         = SDL_ReadLE32(core->replay);
+    core->replay_daily_index = SDL_ReadLE32(core->replay);
+    SDL_memset(&core->state.shuffle, 0, sizeof(core->state.shuffle));
+
+    // Never touch the save files while replaying.  The statistics
+    // start out empty, so that the results look the same everywhere.
+    core->hooks                          = core->state.hooks;
+    core->state.hooks.user_data          = core;
+    core->state.hooks.read_save          = replay_read_save;
+    core->state.hooks.write_save         = NULL;
+    core->state.hooks.read_stats         = NULL;
+    core->state.hooks.append_stats       = NULL;
+    core->state.hooks.write_stats_header = NULL;
+    core->state.hooks.set_text_input     = forward_text_input;
+    core->state.hooks.get_daily_index    = replay_get_daily_index;
+    core->state.hooks.get_day            = replay_get_day;
+
+    SDL_memset(&core->state.stats, 0, sizeof(core->state.stats));
+    stats_load(core->state.wordlist.language, &core->state.hooks, &core->state.stats);
+
+    start        = SDL_GetPerformanceCounter();
+    target_ticks = SDL_GetTicks();
+
+    while (SDL_TRUE == game_is_running(core))
+    {
+        input_t input = { EVENT_NONE, 0, 1, 0.f, 0.f };
+        Uint8   type;
+        Uint8   event;
+        Uint32  delay;
+
+        if ((SDL_FALSE == read_u8(core->replay, &type)) ||
+            (REPLAY_END == type) ||
+            (SDL_FALSE == read_varint(core->replay, &delay)))
+        {
+            break;
+        }
+
+        if (REPLAY_SAVE == type)
+        {
+            // Not requested by the game this time, skip it.
+            Uint32 length;
+
+            if ((SDL_FALSE == read_u8(core->replay, &event)) ||
+                (SDL_FALSE == read_varint(core->replay, &length)) ||
+                (0 > SDL_RWseek(core->replay, length, RW_SEEK_CUR)))
+            {
+                break;
+            }
+            target_ticks += delay;
+            continue;
+        }
+
+        if ((REPLAY_INPUT != type) || (SDL_FALSE == read_u8(core->replay, &event)))
+        {
+            break;
+        }
+
+        input.type = (event_t)event;
+        switch (input.type)
+        {
+            case EVENT_NEXT_LETTER:
+            case EVENT_PREV_LETTER:
+                read_u8(core->replay, &input.count);
+                break;
+            case EVENT_TEXTINPUT:
+                input.text = SDL_ReadLE16(core->replay);
+                break;
+            default:
+                break;
+        }
+
+        // Keep rendering while waiting for the recorded time.
+        if (SDL_TRUE == real_time)
+        {
+            target_ticks += delay;
+            while (!SDL_TICKS_PASSED(SDL_GetTicks(), target_ticks))
+            {
+                status = game_update(core);
+                if (0 != status || SDL_FALSE == game_is_running(core))
+                {
+                    goto quit;
+                }
+                SDL_Delay(1);
+            }
+        }
+
+        // One input per frame, so that save states recorded while
+        // handling it are read in order.
+        game_push_input(&input, core);
+        status = game_update(core);
+        if (0 != status)
+        {
+            break;
+        }
+        input_count += 1;
+    }
+
+quit:
+    printf("%u inputs replayed in %.3f s\n",
+           input_count,
+           (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency());
+
+    SDL_RWclose(core->replay);
+    core->replay      = NULL;
+    core->state.hooks = core->hooks;
+
+    return status;
+}
+
+static void record_header(replay_record_t type, game_t* core)
+{
+    Uint32 ticks = SDL_GetTicks();
+
+    SDL_WriteU8(core->record, (Uint8)type);
+    write_varint(core->record, ticks - core->record_ticks);
+    core->record_ticks = ticks;
+}
+
+static size_t record_read_save(SDL_bool daily, void* buffer, size_t size, void* user_data)
+{
+    game_t* core   = (game_t*)user_data;
+    size_t  length = core->hooks.read_save(daily, buffer, size, core->hooks.user_data);
+
+    if (length > size)
+    {
+        length = size;
+    }
+
+    record_header(REPLAY_SAVE, core);
+    SDL_WriteU8(core->record, (Uint8)daily);
+    write_varint(core->record, (Uint32)length);
+    SDL_RWwrite(core->record, buffer, 1, length);
+
+    return length;
+}
+
+static void record_write_save(SDL_bool daily, const void* buffer, size_t size, void* user_data)
+{
+    game_t* core = (game_t*)user_data;
+
+    core->hooks.write_save(daily, buffer, size, core->hooks.user_data);
+}
+
+static unsigned int replay_get_daily_index(void* user_data)
+{
+    return ((game_t*)user_data)->replay_daily_index;
+}
+
+// The day of the recorded daily word, not today.
+static unsigned int replay_get_day(void* user_data)
+{
+    return REPLAY_FIRST_DAY + ((game_t*)user_data)->replay_daily_index;
+}
+
+static size_t replay_read_save(SDL_bool daily, void* buffer, size_t size, void* user_data)
+{
+    game_t* core     = (game_t*)user_data;
+    Sint64  position = SDL_RWtell(core->replay);
+    Uint8   type;
+    Uint8   recorded_daily;
+    Uint32  delay;
+    Uint32  length;
+
+    if ((SDL_FALSE == read_u8(core->replay, &type)) ||
+        (REPLAY_SAVE != type) ||
+        (SDL_FALSE == read_varint(core->replay, &delay)) ||
+        (SDL_FALSE == read_u8(core->replay, &recorded_daily)) ||
+        (SDL_FALSE == read_varint(core->replay, &length)) ||
+        ((SDL_bool)recorded_daily != daily))
+    {
+        // Out of sync: behave as if there was no save state.
+        SDL_RWseek(core->replay, position, RW_SEEK_SET);
+        return 0;
+    }
+
+    if (length > size)
+    {
+        SDL_RWread(core->replay, buffer, 1, size);
+        SDL_RWseek(core->replay, length - size, RW_SEEK_CUR);
+        return size;
+    }
+
+    return SDL_RWread(core->replay, buffer, 1, length);
+}
+
+static void forward_text_input(SDL_bool enabled, void* user_data)
+{
+    game_t* core = (game_t*)user_data;
+
+    if (NULL != core->hooks.set_text_input)
+    {
+        core->hooks.set_text_input(enabled, core->hooks.user_data);
+    }
+}
+
+static SDL_bool read_u8(SDL_RWops* rw, Uint8* value)
+{
+    return (1 == SDL_RWread(rw, value, 1, 1)) ? SDL_TRUE : SDL_FALSE;
+}
+
+static SDL_bool read_varint(SDL_RWops* rw, Uint32* value)
+{
+    Uint8 byte;
+    int   shift = 0;
+
+    *value = 0;
+    do
+    {
+        if (SDL_FALSE == read_u8(rw, &byte) || shift > 28)
+        {
+            return SDL_FALSE;
+        }
+        *value |= (Uint32)(byte & 0x7f) << shift;
+        shift  += 7;
+    }
+    while (0 != (byte & 0x80));
+
+    return SDL_TRUE;
+}
+
+static void write_varint(SDL_RWops* rw, Uint32 value)
+{
+    while (value >= 0x80)
+    {
+        SDL_WriteU8(rw, (Uint8)(value | 0x80));
+        value >>= 7;
+    }
+    SDL_WriteU8(rw, (Uint8)value);
+}
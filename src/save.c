@@ -0,0 +1,472 @@
+/** @file save.c
+ *
+ *  Save state format.  All values are little-endian and packed, so a
+ *  save file can be moved between platforms:
+ *
+ *    "WS" version:u8 daily:u8
+ *    letter:u8[30] state:u8[8]     two bits per tile, tile 0 lowest
+ *    current_index:varint          zigzag encoded, may be -1
+ *    previous_letter:u8 valid_answer_index:varint attempt:u8
+ *
+ *  followed by
+ *
+ *    seed:varint language:u8 shuffle_seed:varint[4]
+ *    shuffle_cursor:varint[4]      for the game save, or
+ *    has_ended:u8 final_attempt:u8 for the daily save
+ *
+ *  and the CRC-32 of everything before it as u32.
+ *
+ *  Up to version 4, the structures were written as they are in memory;
+ *  such files are still read on the platform that wrote them.
+ *
+ *  A save state may come from another machine, so every value used as
+ *  an index is checked; the CRC only catches damaged files.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL_stdinc.h"
+#include "game_core.h"
+
+#define SAVE_HEADER_SIZE 4
+#define SAVE_CRC_SIZE    4
+
+typedef struct legacy_save_state
+{
+    unsigned int  version;
+    tile_t        tile[30];
+    int           current_index;
+    unsigned char previous_letter;
+    unsigned int  valid_answer_index;
+    Uint8         attempt;
+    unsigned int  seed;
+    lang_t        language;
+    unsigned int  shuffle_seed[LANGUAGE_COUNT];   // Since version 4
+    Uint16        shuffle_cursor[LANGUAGE_COUNT];
+
+} legacy_save_state_t;
+
+typedef struct legacy_nyt_save_state
+{
+    tile_t        tile[30];
+    int           current_index;
+    unsigned char previous_letter;
+    unsigned int  valid_answer_index;
+    Uint8         attempt;
+    SDL_bool      has_ended;
+    Uint8         final_attempt;
+
+} legacy_nyt_save_state_t;
+
+typedef struct writer
+{
+    Uint8* buffer;
+    size_t size;
+
+} writer_t;
+
+typedef struct reader
+{
+    const Uint8* buffer;
+    size_t       size;
+    size_t       position;
+    SDL_bool     is_valid;
+
+} reader_t;
+
+static void     write_header(SDL_bool daily, const tile_t tile[30], int current_index, unsigned char previous_letter, unsigned int valid_answer_index, Uint8 attempt, writer_t* writer);
+static SDL_bool read_header(SDL_bool daily, tile_t tile[30], int* current_index, unsigned char* previous_letter, unsigned int* valid_answer_index, Uint8* attempt, reader_t* reader);
+static SDL_bool is_in_range(int current_index, unsigned int valid_answer_index, Uint8 attempt, lang_t language);
+static size_t   write_crc(writer_t* writer);
+static SDL_bool check_crc(const Uint8* buffer, size_t size);
+static void     write_u8(Uint8 value, writer_t* writer);
+static void     write_varint(Uint32 value, writer_t* writer);
+static Uint8    read_u8(reader_t* reader);
+static Uint32   read_varint(reader_t* reader);
+
+size_t save_state_encode(const save_state_t* save, Uint8 buffer[SAVE_BUFFER_SIZE])
+{
+    writer_t writer;
+    int      index;
+
+    writer.buffer = buffer;
+    writer.size   = 0;
+
+    write_header(SDL_FALSE, save->tile, save->current_index, save->previous_letter, save->valid_answer_index, save->attempt, &writer);
+    write_varint(save->seed, &writer);
+    write_u8((Uint8)save->language, &writer);
+
+    for (index = 0; index < LANGUAGE_COUNT; index += 1)
+    {
+        write_varint(save->shuffle_seed[index], &writer);
+    }
+    for (index = 0; index < LANGUAGE_COUNT; index += 1)
+    {
+        write_varint(save->shuffle_cursor[index], &writer);
+    }
+
+    return write_crc(&writer);
+}
+
+SDL_bool save_state_decode(const Uint8* buffer, size_t size, save_state_t* save)
+{
+    reader_t reader;
+    int      index;
+
+    SDL_memset(save, 0, sizeof(save_state_t));
+
+    // Saved as it was in memory.
+    if (NULL != buffer && size >= sizeof(unsigned int))
+    {
+        legacy_save_state_t legacy;
+        size_t              legacy_size = 0;
+
+        SDL_memset(&legacy, 0, sizeof(legacy));
+        SDL_memcpy(&legacy.version, buffer, sizeof(unsigned int));
+
+        switch (legacy.version)
+        {
+            case 3:
+                legacy_size = (size_t)((Uint8*)&legacy.shuffle_seed - (Uint8*)&legacy);
+                break;
+            case 4:
+                legacy_size = sizeof(legacy);
+                break;
+            default:
+                break;
+        }
+
+        if (0 != legacy_size && size == legacy_size)
+        {
+            SDL_memcpy(&legacy, buffer, legacy_size);
+
+            for (index = 0; index < 30; index += 1)
+            {
+                save->tile[index].letter = legacy.tile[index].letter;
+                save->tile[index].state  = legacy.tile[index].state;
+            }
+
+            save->current_index      = legacy.current_index;
+            save->previous_letter    = legacy.previous_letter;
+            save->valid_answer_index = legacy.valid_answer_index;
+            save->attempt            = legacy.attempt;
+            save->seed               = legacy.seed;
+            save->language           = legacy.language;
+
+            SDL_memcpy(save->shuffle_seed, legacy.shuffle_seed, sizeof(save->shuffle_seed));
+            SDL_memcpy(save->shuffle_cursor, legacy.shuffle_cursor, sizeof(save->shuffle_cursor));
+
+            goto check;
+        }
+    }
+
+    if (SDL_FALSE == check_crc(buffer, size))
+    {
+        return SDL_FALSE;
+    }
+
+    reader.buffer   = buffer;
+    reader.size     = size - SAVE_CRC_SIZE;
+    reader.position = 0;
+    reader.is_valid = SDL_TRUE;
+
+    if (SDL_FALSE == read_header(SDL_FALSE, save->tile, &save->current_index, &save->previous_letter, &save->valid_answer_index, &save->attempt, &reader))
+    {
+        return SDL_FALSE;
+    }
+
+    save->seed     = read_varint(&reader);
+    save->language = (lang_t)read_u8(&reader);
+
+    for (index = 0; index < LANGUAGE_COUNT; index += 1)
+    {
+        save->shuffle_seed[index] = read_varint(&reader);
+    }
+    for (index = 0; index < LANGUAGE_COUNT; index += 1)
+    {
+        save->shuffle_cursor[index] = (Uint16)read_varint(&reader);
+    }
+
+    if (SDL_FALSE == reader.is_valid)
+    {
+        SDL_memset(save, 0, sizeof(save_state_t));
+        return SDL_FALSE;
+    }
+
+check:
+    if (SDL_FALSE == is_in_range(save->current_index, save->valid_answer_index, save->attempt, save->language))
+    {
+        SDL_memset(save, 0, sizeof(save_state_t));
+        return SDL_FALSE;
+    }
+
+    // A cursor at the end starts a new order, see shuffle.c.
+    for (index = 0; index < LANGUAGE_COUNT; index += 1)
+    {
+        if ((save->shuffle_cursor[index] > get_word_count((lang_t)index)) || (save->shuffle_cursor[index] > SHUFFLE_MAX_ANSWERS))
+        {
+            SDL_memset(save, 0, sizeof(save_state_t));
+            return SDL_FALSE;
+        }
+    }
+
+    return SDL_TRUE;
+}
+
+size_t nyt_save_state_encode(const nyt_save_state_t* save, Uint8 buffer[SAVE_BUFFER_SIZE])
+{
+    writer_t writer;
+
+    writer.buffer = buffer;
+    writer.size   = 0;
+
+    write_header(SDL_TRUE, save->tile, save->current_index, save->previous_letter, save->valid_answer_index, save->attempt, &writer);
+    write_u8((Uint8)save->has_ended, &writer);
+    write_u8(save->final_attempt, &writer);
+
+    return write_crc(&writer);
+}
+
+SDL_bool nyt_save_state_decode(const Uint8* buffer, size_t size, nyt_save_state_t* save)
+{
+    reader_t reader;
+
+    SDL_memset(save, 0, sizeof(nyt_save_state_t));
+
+    // Saved as it was in memory, without a version.
+    if (NULL != buffer && size == sizeof(legacy_nyt_save_state_t))
+    {
+        legacy_nyt_save_state_t legacy;
+        int                     index;
+
+        SDL_memcpy(&legacy, buffer, sizeof(legacy));
+
+        for (index = 0; index < 30; index += 1)
+        {
+            save->tile[index].letter = legacy.tile[index].letter;
+            save->tile[index].state  = legacy.tile[index].state;
+        }
+
+        save->current_index      = legacy.current_index;
+        save->previous_letter    = legacy.previous_letter;
+        save->valid_answer_index = legacy.valid_answer_index;
+        save->attempt            = legacy.attempt;
+        save->has_ended          = legacy.has_ended;
+        save->final_attempt      = legacy.final_attempt;
+
+        goto check;
+    }
+
+    if (SDL_FALSE == check_crc(buffer, size))
+    {
+        return SDL_FALSE;
+    }
+
+    reader.buffer   = buffer;
+    reader.size     = size - SAVE_CRC_SIZE;
+    reader.position = 0;
+    reader.is_valid = SDL_TRUE;
+
+    if (SDL_FALSE == read_header(SDL_TRUE, save->tile, &save->current_index, &save->previous_letter, &save->valid_answer_index, &save->attempt, &reader))
+    {
+        return SDL_FALSE;
+    }
+
+    save->has_ended     = (0 != read_u8(&reader)) ? SDL_TRUE : SDL_FALSE;
+    save->final_attempt = read_u8(&reader);
+
+    if (SDL_FALSE == reader.is_valid)
+    {
+        SDL_memset(save, 0, sizeof(nyt_save_state_t));
+        return SDL_FALSE;
+    }
+
+    // The daily word is always English.
+check:
+    if ((SDL_FALSE == is_in_range(save->current_index, save->valid_answer_index, save->attempt, LANG_ENGLISH)) || (save->final_attempt > 6))
+    {
+        SDL_memset(save, 0, sizeof(nyt_save_state_t));
+        return SDL_FALSE;
+    }
+
+    return SDL_TRUE;
+}
+
+// CRC-32 as used by zlib.  Save states and statistics headers are
+// small, so it is computed bit by bit instead of with a table.
+Uint32 get_crc(const Uint8* buffer, size_t size)
+{
+    Uint32 crc = 0xffffffff;
+    size_t index;
+    int    bit;
+
+    for (index = 0; index < size; index += 1)
+    {
+        crc ^= buffer[index];
+
+        for (bit = 0; bit < 8; bit += 1)
+        {
+            crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+        }
+    }
+
+    return ~crc;
+}
+
+static void write_header(SDL_bool daily, const tile_t tile[30], int current_index, unsigned char previous_letter, unsigned int valid_answer_index, Uint8 attempt, writer_t* writer)
+{
+    Uint8 state[8] = { 0 };
+    int   index;
+
+    write_u8('W', writer);
+    write_u8('S', writer);
+    write_u8(SAVE_VERSION, writer);
+    write_u8((Uint8)daily, writer);
+
+    for (index = 0; index < 30; index += 1)
+    {
+        write_u8(tile[index].letter, writer);
+        state[index / 4] |= (Uint8)((tile[index].state & 0x03) << ((index % 4) * 2));
+    }
+
+    for (index = 0; index < 8; index += 1)
+    {
+        write_u8(state[index], writer);
+    }
+
+    // Zigzag encoding keeps small negative numbers short.
+    write_varint(((Uint32)current_index << 1) ^ (Uint32)(0 - (current_index < 0)), writer);
+    write_u8(previous_letter, writer);
+    write_varint(valid_answer_index, writer);
+    write_u8(attempt, writer);
+}
+
+static SDL_bool read_header(SDL_bool daily, tile_t tile[30], int* current_index, unsigned char* previous_letter, unsigned int* valid_answer_index, Uint8* attempt, reader_t* reader)
+{
+    Uint8  state[8];
+    Uint32 zigzag;
+    int    index;
+
+    if (('W' != read_u8(reader)) ||
+        ('S' != read_u8(reader)) ||
+        (SAVE_VERSION != read_u8(reader)) ||
+        ((Uint8)daily != read_u8(reader)))
+    {
+        return SDL_FALSE;
+    }
+
+    for (index = 0; index < 30; index += 1)
+    {
+        tile[index].letter       = read_u8(reader);
+        tile[index].letter_index = 0;
+    }
+
+    for (index = 0; index < 8; index += 1)
+    {
+        state[index] = read_u8(reader);
+    }
+
+    for (index = 0; index < 30; index += 1)
+    {
+        tile[index].state = (state_t)((state[index / 4] >> ((index % 4) * 2)) & 0x03);
+    }
+
+    zigzag              = read_varint(reader);
+    *current_index      = (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+    *previous_letter    = read_u8(reader);
+    *valid_answer_index = read_varint(reader);
+    *attempt            = read_u8(reader);
+
+    return reader->is_valid;
+}
+
+static SDL_bool is_in_range(int current_index, unsigned int valid_answer_index, Uint8 attempt, lang_t language)
+{
+    if ((current_index < -1) || (current_index > 29) || (attempt > 6) || ((unsigned int)language >= LANGUAGE_COUNT))
+    {
+        return SDL_FALSE;
+    }
+
+    return (valid_answer_index < get_word_count(language)) ? SDL_TRUE : SDL_FALSE;
+}
+
+static size_t write_crc(writer_t* writer)
+{
+    Uint32 crc = get_crc(writer->buffer, writer->size);
+
+    write_u8((Uint8)crc, writer);
+    write_u8((Uint8)(crc >> 8), writer);
+    write_u8((Uint8)(crc >> 16), writer);
+    write_u8((Uint8)(crc >> 24), writer);
+
+    return writer->size;
+}
+
+static SDL_bool check_crc(const Uint8* buffer, size_t size)
+{
+    const Uint8* stored;
+
+    if (NULL == buffer || size < SAVE_HEADER_SIZE + SAVE_CRC_SIZE)
+    {
+        return SDL_FALSE;
+    }
+
+    stored = &buffer[size - SAVE_CRC_SIZE];
+
+    return (get_crc(buffer, size - SAVE_CRC_SIZE) == ((Uint32)stored[0] | ((Uint32)stored[1] << 8) | ((Uint32)stored[2] << 16) | ((Uint32)stored[3] << 24))) ? SDL_TRUE : SDL_FALSE;
+}
+
+static void write_u8(Uint8 value, writer_t* writer)
+{
+    if (writer->size < SAVE_BUFFER_SIZE)
+    {
+        writer->buffer[writer->size] = value;
+        writer->size                += 1;
+    }
+}
+
+static void write_varint(Uint32 value, writer_t* writer)
+{
+    while (value >= 0x80)
+    {
+        write_u8((Uint8)(value | 0x80), writer);
+        value >>= 7;
+    }
+    write_u8((Uint8)value, writer);
+}
+
+static Uint8 read_u8(reader_t* reader)
+{
+    if (reader->position >= reader->size)
+    {
+        reader->is_valid = SDL_FALSE;
+        return 0;
+    }
+
+    reader->position += 1;
+
+    return reader->buffer[reader->position - 1];
+}
+
+static Uint32 read_varint(reader_t* reader)
+{
+    Uint32 value = 0;
+    int    shift;
+
+    for (shift = 0; shift < 35; shift += 7)
+    {
+        Uint8 byte = read_u8(reader);
+
+        value |= (Uint32)(byte & 0x7f) << shift;
+        if (0 == (byte & 0x80))
+        {
+            return value;
+        }
+    }
+
+    reader->is_valid = SDL_FALSE;
+
+    return 0;
+}
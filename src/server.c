@@ -0,0 +1,756 @@
+/** @file server.c
+ *
+ *  Game server: hosts many concurrent sessions and speaks a line based
+ *  protocol over stdin/stdout or a Unix domain socket.
+ *
+ *    new [en|ru|de|fi] [seed]  ->  ok <id>
+ *    guess <id> <word>         ->  ok|won <pattern>
+ *                                  lost <pattern> <answer>
+ *    end <id>                  ->  ok
+ *    stats                     ->  ok <sessions> <capacity>
+ *
+ *  Errors are reported as "err <reason>".  Patterns use '+' for the
+ *  correct letter, '?' for a letter in the wrong position and '-' for
+ *  a wrong letter.  Words are upper-cased ASCII or the 8-bit encoding
+ *  used by the wordlists.
+ *
+ *  Requests are processed in batches: every read drains as much input
+ *  as is available and all responses are written back at once.  In
+ *  socket mode, each worker thread runs its own event loop and picks
+ *  up connections from the shared listening socket.  Sessions live in
+ *  a sharded table shared by all workers, see session.c.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "SDL.h"
+#include "game_core.h"
+#include "session.h"
+
+#ifndef SERVER_BUFFER_SIZE
+#define SERVER_BUFFER_SIZE 65536
+#endif
+
+#ifndef SERVER_MAX_CONNECTIONS
+#define SERVER_MAX_CONNECTIONS 64
+#endif
+
+#ifndef SERVER_DEFAULT_SESSIONS
+#define SERVER_DEFAULT_SESSIONS 65536
+#endif
+
+#ifndef SERVER_MAX_WORKERS
+#define SERVER_MAX_WORKERS 64
+#endif
+
+#define SERVER_SHARDS_PER_WORKER 4
+
+#define SERVER_MAX_RESPONSE 64
+#define SERVER_LANGUAGES    4
+
+typedef struct connection
+{
+    int    fd_in;
+    int    fd_out;
+    char   in[SERVER_BUFFER_SIZE];
+    size_t in_length;
+    char   out[SERVER_BUFFER_SIZE];
+    size_t out_length;
+    size_t out_offset;
+
+} connection_t;
+
+typedef struct server
+{
+    lexicon_t       lexicon[SERVER_LANGUAGES];
+    session_table_t table;
+    int             listen_fd;
+    Uint32          worker_count;
+
+} server_t;
+
+typedef struct worker
+{
+    server_t*     server;
+    SDL_Thread*   thread;
+    unsigned int  seed;
+    Uint32        shard_hint;
+    connection_t* connection[SERVER_MAX_CONNECTIONS];
+
+} worker_t;
+
+static int      flush_output(connection_t* connection);
+static void     handle_request(char* line, connection_t* connection, worker_t* worker);
+static SDL_bool parse_language(const char* name, lang_t* language);
+static size_t   process_input(connection_t* connection, worker_t* worker);
+static void     respond(connection_t* connection, const char* format, ...);
+static int      run_socket(const char* socket_path, server_t* server);
+static int      run_stdio(server_t* server);
+static int      run_worker(void* data);
+static char*    next_token(char** line);
+
+int main(int argc, char *argv[])
+{
+    server_t*   server;
+    const char* socket_path = NULL;
+    Uint32      capacity    = SERVER_DEFAULT_SESSIONS;
+    Uint32      workers     = 0;
+    int         status      = 0;
+    int         index;
+
+    // [--socket <path>] [--sessions <n>] [--workers <n>]
+    for (index = 1; index < argc; index += 1)
+    {
+        if ((0 == SDL_strcmp(argv[index], "--socket")) && ((index + 1) < argc))
+        {
+            index       += 1;
+            socket_path  = argv[index];
+        }
+        else if ((0 == SDL_strcmp(argv[index], "--sessions")) && ((index + 1) < argc))
+        {
+            index    += 1;
+            capacity  = (Uint32)SDL_strtoul(argv[index], NULL, 0);
+        }
+        else if ((0 == SDL_strcmp(argv[index], "--workers")) && ((index + 1) < argc))
+        {
+            index   += 1;
+            workers  = (Uint32)SDL_strtoul(argv[index], NULL, 0);
+        }
+    }
+
+    // stdin/stdout is served by a single worker.
+    if (NULL == socket_path)
+    {
+        workers = 1;
+    }
+    else if (0 == workers)
+    {
+        workers = (Uint32)SDL_GetCPUCount();
+    }
+    workers = SDL_clamp(workers, 1, SERVER_MAX_WORKERS);
+
+    server = (server_t*)SDL_calloc(1, sizeof(server_t));
+    if (NULL == server)
+    {
+        return 1;
+    }
+
+    for (index = 0; index < SERVER_LANGUAGES; index += 1)
+    {
+        if (0 != lexicon_init((lang_t)index, &server->lexicon[index]))
+        {
+            status = 1;
+            goto quit;
+        }
+    }
+
+    server->worker_count = workers;
+    if (0 != session_table_init(workers * SERVER_SHARDS_PER_WORKER, capacity, &server->table))
+    {
+        fprintf(stderr, "Could not allocate %u sessions\n", capacity);
+        status = 1;
+        goto quit;
+    }
+
+    if (NULL != socket_path)
+    {
+        status = run_socket(socket_path, server);
+    }
+    else
+    {
+        status = run_stdio(server);
+    }
+
+quit:
+    session_table_free(&server->table);
+    for (index = 0; index < SERVER_LANGUAGES; index += 1)
+    {
+        lexicon_free(&server->lexicon[index]);
+    }
+    SDL_free(server);
+
+    return status;
+}
+
+static int run_stdio(server_t* server)
+{
+    worker_t      worker;
+    connection_t* connection;
+    int           status = 0;
+
+    connection = (connection_t*)SDL_calloc(1, sizeof(connection_t));
+    if (NULL == connection)
+    {
+        return 1;
+    }
+
+    SDL_memset(&worker, 0, sizeof(worker));
+    worker.server = server;
+    worker.seed   = (unsigned int)time(NULL) | 1u;
+
+    connection->fd_in  = STDIN_FILENO;
+    connection->fd_out = STDOUT_FILENO;
+
+    // Blocking I/O: each read returns whatever is available, which
+    // makes up one batch.
+    for (;;)
+    {
+        ssize_t length = read(connection->fd_in, connection->in + connection->in_length, sizeof(connection->in) - connection->in_length);
+
+        if (length < 0 && EINTR == errno)
+        {
+            continue;
+        }
+
+        if (length <= 0)
+        {
+            break;
+        }
+
+        connection->in_length += (size_t)length;
+        while (0 < process_input(connection, &worker))
+        {
+            if (0 != flush_output(connection))
+            {
+                status = 1;
+                goto quit;
+            }
+        }
+
+        if (0 != flush_output(connection))
+        {
+            status = 1;
+            goto quit;
+        }
+    }
+
+quit:
+    SDL_free(connection);
+    return status;
+}
+
+static int run_socket(const char* socket_path, server_t* server)
+{
+    struct sockaddr_un address;
+    worker_t*          worker;
+    Uint32             index;
+
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (server->listen_fd < 0)
+    {
+        return 1;
+    }
+
+    SDL_memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    SDL_strlcpy(address.sun_path, socket_path, sizeof(address.sun_path));
+    unlink(socket_path);
+
+    if (0 != bind(server->listen_fd, (struct sockaddr*)&address, sizeof(address)) || 0 != listen(server->listen_fd, SOMAXCONN))
+    {
+        fprintf(stderr, "Could not listen on %s\n", socket_path);
+        close(server->listen_fd);
+        return 1;
+    }
+
+    worker = (worker_t*)SDL_calloc(server->worker_count, sizeof(worker_t));
+    if (NULL == worker)
+    {
+        close(server->listen_fd);
+        return 1;
+    }
+
+    // Each worker starts creating sessions in a different shard.
+    for (index = 0; index < server->worker_count; index += 1)
+    {
+        worker[index].server     = server;
+        worker[index].seed       = ((unsigned int)time(NULL) ^ (index * 0x9e3779b9u)) | 1u;
+        worker[index].shard_hint = index;
+    }
+
+    for (index = 1; index < server->worker_count; index += 1)
+    {
+        worker[index].thread = SDL_CreateThread(run_worker, "worker", &worker[index]);
+    }
+    run_worker(&worker[0]);
+
+    for (index = 1; index < server->worker_count; index += 1)
+    {
+        SDL_WaitThread(worker[index].thread, NULL);
+    }
+
+    SDL_free(worker);
+    close(server->listen_fd);
+    unlink(socket_path);
+
+    return 1;
+}
+
+static int run_worker(void* data)
+{
+    worker_t*          worker = (worker_t*)data;
+    struct epoll_event event;
+    struct epoll_event events[SERVER_MAX_CONNECTIONS];
+    int                epoll_fd;
+    int                index;
+
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0)
+    {
+        return 1;
+    }
+
+    // Slot index + 1 identifies connections, 0 the listening socket,
+    // which only wakes up one of the workers.
+    event.events   = EPOLLIN | EPOLLEXCLUSIVE;
+    event.data.u32 = 0;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, worker->server->listen_fd, &event);
+
+    for (;;)
+    {
+        int count = epoll_wait(epoll_fd, events, SERVER_MAX_CONNECTIONS, -1);
+
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            break;
+        }
+
+        for (index = 0; index < count; index += 1)
+        {
+            connection_t* connection;
+            Uint32        slot = events[index].data.u32;
+            SDL_bool      drop = SDL_FALSE;
+
+            if (0 == slot)
+            {
+                int fd;
+
+                while ((fd = accept4(worker->server->listen_fd, NULL, NULL, SOCK_NONBLOCK)) >= 0)
+                {
+                    Uint32 free_slot;
+
+                    for (free_slot = 0; free_slot < SERVER_MAX_CONNECTIONS; free_slot += 1)
+                    {
+                        if (NULL == worker->connection[free_slot])
+                        {
+                            break;
+                        }
+                    }
+
+                    connection = NULL;
+                    if (free_slot < SERVER_MAX_CONNECTIONS)
+                    {
+                        connection = (connection_t*)SDL_calloc(1, sizeof(connection_t));
+                    }
+
+                    if (NULL == connection)
+                    {
+                        close(fd);
+                        continue;
+                    }
+
+                    connection->fd_in             = fd;
+                    connection->fd_out            = fd;
+                    worker->connection[free_slot] = connection;
+
+                    event.events   = EPOLLIN | EPOLLOUT | EPOLLET;
+                    event.data.u32 = free_slot + 1;
+                    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+                }
+                continue;
+            }
+
+            connection = worker->connection[slot - 1];
+            if (NULL == connection)
+            {
+                continue;
+            }
+
+            if (0 != (events[index].events & (EPOLLERR | EPOLLHUP)))
+            {
+                drop = SDL_TRUE;
+            }
+
+            // Edge triggered: drain the socket, answering each batch as
+            // it comes in.  Input is left unread while responses are
+            // still pending, which pushes back on the client.
+            while (SDL_FALSE == drop)
+            {
+                ssize_t length;
+
+                if (0 != flush_output(connection))
+                {
+                    drop = SDL_TRUE;
+                    break;
+                }
+
+                if (connection->out_offset < connection->out_length)
+                {
+                    // Retried on the next EPOLLOUT.
+                    break;
+                }
+
+                if (0 < process_input(connection, worker))
+                {
+                    continue;
+                }
+
+                length = read(connection->fd_in, connection->in + connection->in_length, sizeof(connection->in) - connection->in_length);
+                if (0 == length)
+                {
+                    drop = SDL_TRUE;
+                }
+                else if (length < 0)
+                {
+                    if (EINTR == errno)
+                    {
+                        continue;
+                    }
+
+                    if (EAGAIN != errno && EWOULDBLOCK != errno)
+                    {
+                        drop = SDL_TRUE;
+                    }
+                    break;
+                }
+                else
+                {
+                    connection->in_length += (size_t)length;
+                }
+            }
+
+            if (SDL_TRUE == drop)
+            {
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, connection->fd_in, NULL);
+                close(connection->fd_in);
+                SDL_free(connection);
+                worker->connection[slot - 1] = NULL;
+            }
+        }
+    }
+
+    for (index = 0; index < SERVER_MAX_CONNECTIONS; index += 1)
+    {
+        if (NULL != worker->connection[index])
+        {
+            close(worker->connection[index]->fd_in);
+            SDL_free(worker->connection[index]);
+        }
+    }
+    close(epoll_fd);
+
+    return 1;
+}
+
+// Handles all complete lines that fit into the output buffer and
+// returns the number of lines handled.
+static size_t process_input(connection_t* connection, worker_t* worker)
+{
+    size_t start = 0;
+    size_t count = 0;
+
+    for (;;)
+    {
+        char* line = connection->in + start;
+        char* end;
+
+        if (connection->out_length + SERVER_MAX_RESPONSE > sizeof(connection->out))
+        {
+            break;
+        }
+
+        end = (char*)memchr(line, '\n', connection->in_length - start);
+        if (NULL == end)
+        {
+            break;
+        }
+
+        *end   = '\0';
+        start  = (size_t)(end - connection->in) + 1;
+        count += 1;
+
+        handle_request(line, connection, worker);
+    }
+
+    if (start > 0)
+    {
+        SDL_memmove(connection->in, connection->in + start, connection->in_length - start);
+        connection->in_length -= start;
+    }
+    else if (connection->in_length == sizeof(connection->in))
+    {
+        // Line too long, discard it.
+        connection->in_length = 0;
+        respond(connection, "err line-too-long");
+    }
+
+    return count;
+}
+
+static void handle_request(char* line, connection_t* connection, worker_t* worker)
+{
+    server_t* server  = worker->server;
+    char*     command = next_token(&line);
+
+    if (0 == SDL_strcmp(command, "guess"))
+    {
+        session_t*     session;
+        state_t        result[5];
+        char           pattern[6];
+        unsigned char  guess[6]  = { 0 };
+        unsigned char  answer[6] = { 0 };
+        guess_result_t status;
+        Uint64         id;
+        char*          word;
+        int            index;
+
+        id   = (Uint64)SDL_strtoull(next_token(&line), NULL, 10);
+        word = next_token(&line);
+
+        if (5 != SDL_strlen(word))
+        {
+            respond(connection, "err not-allowed");
+            return;
+        }
+
+        for (index = 0; index < 5; index += 1)
+        {
+            guess[index] = (unsigned char)word[index];
+            if (guess[index] < 0x80)
+            {
+                guess[index] = (unsigned char)SDL_toupper(guess[index]);
+            }
+        }
+
+        session = session_acquire(id, &server->table);
+        if (NULL == session)
+        {
+            respond(connection, "err unknown-session");
+            return;
+        }
+
+        status = session_guess(guess, result, &server->lexicon[session->language], session);
+        if (GUESS_LOST == status)
+        {
+            SDL_memcpy(answer, server->lexicon[session->language].wordlist.list[session->answer_index], 5);
+        }
+        session_release(session);
+
+        switch (status)
+        {
+            case GUESS_NOT_ALLOWED:
+                respond(connection, "err not-allowed");
+                return;
+            case GUESS_GAME_OVER:
+                respond(connection, "err game-over");
+                return;
+            default:
+                break;
+        }
+
+        for (index = 0; index < 5; index += 1)
+        {
+            switch (result[index])
+            {
+                case CORRECT_LETTER:
+                    pattern[index] = '+';
+                    break;
+                case WRONG_POSITION:
+                    pattern[index] = '?';
+                    break;
+                default:
+                    pattern[index] = '-';
+                    break;
+            }
+        }
+        pattern[5] = '\0';
+
+        if (GUESS_WON == status)
+        {
+            respond(connection, "won %s", pattern);
+        }
+        else if (GUESS_LOST == status)
+        {
+            respond(connection, "lost %s %s", pattern, (const char*)answer);
+        }
+        else
+        {
+            respond(connection, "ok %s", pattern);
+        }
+    }
+    else if (0 == SDL_strcmp(command, "new"))
+    {
+        session_t* session;
+        Uint64     id;
+        char*      name     = next_token(&line);
+        char*      seed     = next_token(&line);
+        lang_t     language = LANG_ENGLISH;
+
+        if ('\0' != *name && SDL_FALSE == parse_language(name, &language))
+        {
+            respond(connection, "err unknown-language");
+            return;
+        }
+
+        if ('\0' != *seed)
+        {
+            session = session_create((unsigned int)SDL_strtoul(seed, NULL, 0), worker->shard_hint, &server->lexicon[language], &server->table);
+        }
+        else
+        {
+            session = session_create(xorshift(&worker->seed), worker->shard_hint, &server->lexicon[language], &server->table);
+        }
+
+        if (NULL == session)
+        {
+            respond(connection, "err no-sessions");
+            return;
+        }
+
+        id = session_id(session);
+        session_release(session);
+
+        // Spread the sessions over the shards of this worker.
+        worker->shard_hint += server->worker_count;
+
+        respond(connection, "ok %" SDL_PRIu64, id);
+    }
+    else if (0 == SDL_strcmp(command, "end"))
+    {
+        session_t* session = session_acquire((Uint64)SDL_strtoull(next_token(&line), NULL, 10), &server->table);
+
+        if (NULL == session)
+        {
+            respond(connection, "err unknown-session");
+            return;
+        }
+
+        session_destroy(session, &server->table);
+        respond(connection, "ok");
+    }
+    else if (0 == SDL_strcmp(command, "stats"))
+    {
+        respond(connection, "ok %u %u", session_table_count(&server->table), session_table_capacity(&server->table));
+    }
+    else if ('\0' != *command)
+    {
+        respond(connection, "err unknown-command");
+    }
+}
+
+static SDL_bool parse_language(const char* name, lang_t* language)
+{
+    if (0 == SDL_strcmp(name, "en"))
+    {
+        *language = LANG_ENGLISH;
+    }
+    else if (0 == SDL_strcmp(name, "ru"))
+    {
+        *language = LANG_RUSSIAN;
+    }
+    else if (0 == SDL_strcmp(name, "de"))
+    {
+        *language = LANG_GERMAN;
+    }
+    else if (0 == SDL_strcmp(name, "fi"))
+    {
+        *language = LANG_FINNISH;
+    }
+    else
+    {
+        return SDL_FALSE;
+    }
+
+    return SDL_TRUE;
+}
+
+static void respond(connection_t* connection, const char* format, ...)
+{
+    va_list args;
+    size_t  space = sizeof(connection->out) - connection->out_length;
+    int     length;
+
+    va_start(args, format);
+    length = SDL_vsnprintf(connection->out + connection->out_length, space, format, args);
+    va_end(args);
+
+    if (length < 0 || (size_t)length + 1 >= space)
+    {
+        return;
+    }
+
+    connection->out_length                     += (size_t)length;
+    connection->out[connection->out_length++]   = '\n';
+}
+
+static int flush_output(connection_t* connection)
+{
+    while (connection->out_offset < connection->out_length)
+    {
+        ssize_t length = write(connection->fd_out, connection->out + connection->out_offset, connection->out_length - connection->out_offset);
+
+        if (length < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            if (EAGAIN == errno || EWOULDBLOCK == errno)
+            {
+                return 0;
+            }
+
+            return 1;
+        }
+
+        connection->out_offset += (size_t)length;
+    }
+
+    connection->out_offset = 0;
+    connection->out_length = 0;
+
+    return 0;
+}
+
+static char* next_token(char** line)
+{
+    char* token;
+
+    while (' ' == **line || '\t' == **line || '\r' == **line)
+    {
+        *line += 1;
+    }
+
+    token = *line;
+
+    while ('\0' != **line && ' ' != **line && '\t' != **line && '\r' != **line)
+    {
+        *line += 1;
+    }
+
+    if ('\0' != **line)
+    {
+        **line  = '\0';
+        *line  += 1;
+    }
+
+    return token;
+}
@@ -0,0 +1,386 @@
+/** @file session.c
+ *
+ *  Compact game sessions for the game server.  Sessions only hold
+ *  what is needed to score guesses and live in preallocated shards.
+ *  Lookups are lock-free; each shard's free list has its own lock and
+ *  each session a spinlock that serialises guesses on the same game.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL.h"
+#include "game_core.h"
+#include "session.h"
+
+// Sessions must fill whole cache lines to stay aligned to them.
+SDL_COMPILE_TIME_ASSERT(session_size, sizeof(session_t) == SESSION_CACHE_LINE);
+
+static int compare_hash(const void* a, const void* b);
+
+int lexicon_init(const lang_t language, lexicon_t* lexicon)
+{
+    Uint32 index;
+    Uint32 count = 0;
+
+    if (NULL == lexicon)
+    {
+        return 1;
+    }
+
+    SDL_memset(lexicon, 0, sizeof(lexicon_t));
+    load_wordlist(language, &lexicon->wordlist);
+
+    // Answers, allowed guesses and the easter egg accepted by
+    // is_guess_allowed(), sorted for binary search.
+    lexicon->sorted_hash = (Uint32*)SDL_malloc((lexicon->wordlist.word_count + lexicon->wordlist.allowed_count + 1) * sizeof(Uint32));
+    if (NULL == lexicon->sorted_hash)
+    {
+        return 1;
+    }
+
+    for (index = 0; index < lexicon->wordlist.word_count; index += 1)
+    {
+        lexicon->sorted_hash[count++] = lexicon->wordlist.hash[index];
+    }
+
+    if (NULL != lexicon->wordlist.allowed_hash)
+    {
+        for (index = 0; index < lexicon->wordlist.allowed_count; index += 1)
+        {
+            lexicon->sorted_hash[count++] = lexicon->wordlist.allowed_hash[index];
+        }
+    }
+
+    lexicon->sorted_hash[count++] = generate_hash((const unsigned char*)"NGAGE");
+    lexicon->hash_count           = count;
+
+    SDL_qsort(lexicon->sorted_hash, count, sizeof(Uint32), compare_hash);
+
+    return 0;
+}
+
+void lexicon_free(lexicon_t* lexicon)
+{
+    if (NULL == lexicon)
+    {
+        return;
+    }
+
+    SDL_free(lexicon->sorted_hash);
+    lexicon->sorted_hash = NULL;
+    lexicon->hash_count  = 0;
+}
+
+SDL_bool lexicon_contains(const unsigned char* word, const lexicon_t* lexicon)
+{
+    Uint32 hash  = generate_hash(word);
+    Uint32 lower = 0;
+    Uint32 upper = lexicon->hash_count;
+
+    while (lower < upper)
+    {
+        Uint32 middle = lower + ((upper - lower) / 2);
+
+        if (lexicon->sorted_hash[middle] < hash)
+        {
+            lower = middle + 1;
+        }
+        else
+        {
+            upper = middle;
+        }
+    }
+
+    return (lower < lexicon->hash_count && hash == lexicon->sorted_hash[lower]) ? SDL_TRUE : SDL_FALSE;
+}
+
+int session_table_init(Uint32 shard_count, Uint32 capacity, session_table_t* table)
+{
+    Uint32 shard_capacity;
+    Uint32 shard_index;
+    Uint32 index;
+
+    if (NULL == table)
+    {
+        return 1;
+    }
+
+    SDL_memset(table, 0, sizeof(session_table_t));
+
+    if (0 == shard_count || shard_count > SESSION_MAX_SHARDS || 0 == capacity)
+    {
+        return 1;
+    }
+
+    shard_capacity = (capacity + shard_count - 1) / shard_count;
+    if (shard_capacity > SESSION_MAX_SESSIONS)
+    {
+        return 1;
+    }
+
+    table->shard = (session_shard_t*)SDL_calloc(shard_count, sizeof(session_shard_t));
+    if (NULL == table->shard)
+    {
+        return 1;
+    }
+    table->shard_count = shard_count;
+
+    for (shard_index = 0; shard_index < shard_count; shard_index += 1)
+    {
+        session_shard_t* shard = &table->shard[shard_index];
+
+        // One session more, so the array can start on a cache line
+        // and no two sessions share one.
+        shard->memory    = SDL_calloc(shard_capacity + 1, sizeof(session_t));
+        shard->free_slot = (Uint32*)SDL_malloc(shard_capacity * sizeof(Uint32));
+
+        if (NULL == shard->memory || NULL == shard->free_slot)
+        {
+            session_table_free(table);
+            return 1;
+        }
+
+        shard->session = (session_t*)(((size_t)shard->memory + (SESSION_CACHE_LINE - 1)) & ~(size_t)(SESSION_CACHE_LINE - 1));
+
+        // Hand out low slots first.
+        for (index = 0; index < shard_capacity; index += 1)
+        {
+            shard->session[index].slot    = (shard_index << SESSION_SLOT_BITS) | index;
+            shard->session[index].attempt = SESSION_FREE;
+            shard->free_slot[index]       = shard_capacity - 1 - index;
+        }
+
+        shard->capacity   = shard_capacity;
+        shard->free_count = shard_capacity;
+    }
+
+    return 0;
+}
+
+void session_table_free(session_table_t* table)
+{
+    Uint32 shard_index;
+
+    if (NULL == table)
+    {
+        return;
+    }
+
+    for (shard_index = 0; shard_index < table->shard_count; shard_index += 1)
+    {
+        SDL_free(table->shard[shard_index].memory);
+        SDL_free(table->shard[shard_index].free_slot);
+    }
+
+    SDL_free(table->shard);
+    SDL_memset(table, 0, sizeof(session_table_t));
+}
+
+// Only a snapshot while other threads create or end sessions.
+Uint32 session_table_count(const session_table_t* table)
+{
+    Uint32 shard_index;
+    Uint32 count = 0;
+
+    for (shard_index = 0; shard_index < table->shard_count; shard_index += 1)
+    {
+        count += table->shard[shard_index].capacity - table->shard[shard_index].free_count;
+    }
+
+    return count;
+}
+
+Uint32 session_table_capacity(const session_table_t* table)
+{
+    Uint32 shard_index;
+    Uint32 capacity = 0;
+
+    for (shard_index = 0; shard_index < table->shard_count; shard_index += 1)
+    {
+        capacity += table->shard[shard_index].capacity;
+    }
+
+    return capacity;
+}
+
+// Returns the new session acquired by the caller, see
+// session_release().  Threads should pass different shard hints, so
+// they do not compete for the same free list.
+session_t* session_create(unsigned int seed, Uint32 shard_hint, const lexicon_t* lexicon, session_table_t* table)
+{
+    session_t* session = NULL;
+    Uint32     generation;
+    Uint32     index;
+
+    if (NULL == table || NULL == lexicon)
+    {
+        return NULL;
+    }
+
+    for (index = 0; index < table->shard_count && NULL == session; index += 1)
+    {
+        session_shard_t* shard = &table->shard[(shard_hint + index) % table->shard_count];
+
+        SDL_AtomicLock(&shard->lock);
+        if (shard->free_count > 0)
+        {
+            shard->free_count -= 1;
+            session            = &shard->session[shard->free_slot[shard->free_count]];
+        }
+        SDL_AtomicUnlock(&shard->lock);
+    }
+
+    if (NULL == session)
+    {
+        return NULL;
+    }
+
+    // A reader holding an old ID of this slot may still hold the
+    // lock for a moment.
+    SDL_AtomicLock(&session->lock);
+
+    SDL_memset(session->letter,    0, sizeof(session->letter));
+    SDL_memset(session->row_state, 0, sizeof(session->row_state));
+
+    // Every session draws its own answer, uniformly like the
+    // endless mode's shuffle.
+    session->seed         = (0 == seed) ? 1 : seed;
+    session->answer_index = (Uint16)get_random_below(lexicon->wordlist.word_count, &session->seed);
+    session->language     = (Uint8)lexicon->wordlist.language;
+    session->attempt      = 0;
+
+    generation = (Uint32)SDL_AtomicGet(&session->generation) + 1;
+    if (0 == generation)
+    {
+        generation = 1;
+    }
+    SDL_AtomicSet(&session->generation, (int)generation);
+
+    return session;
+}
+
+// Looks up a session without taking any shared lock and acquires it.
+// Returns NULL for unknown or ended sessions.
+session_t* session_acquire(Uint64 id, session_table_t* table)
+{
+    session_shard_t* shard;
+    session_t*       session;
+    Uint32           generation  = (Uint32)(id >> 32);
+    Uint32           shard_index = (Uint32)(id & 0xffffffffu) >> SESSION_SLOT_BITS;
+    Uint32           slot        = (Uint32)id & SESSION_SLOT_MASK;
+
+    if (NULL == table || 0 == generation || shard_index >= table->shard_count)
+    {
+        return NULL;
+    }
+
+    shard = &table->shard[shard_index];
+    if (slot >= shard->capacity)
+    {
+        return NULL;
+    }
+
+    session = &shard->session[slot];
+    if (generation != (Uint32)SDL_AtomicGet(&session->generation))
+    {
+        return NULL;
+    }
+
+    SDL_AtomicLock(&session->lock);
+
+    // The session may have ended or been reused in the meantime.
+    if (generation != (Uint32)SDL_AtomicGet(&session->generation) || SESSION_FREE == session->attempt)
+    {
+        SDL_AtomicUnlock(&session->lock);
+        return NULL;
+    }
+
+    return session;
+}
+
+void session_release(session_t* session)
+{
+    if (NULL == session)
+    {
+        return;
+    }
+
+    SDL_AtomicUnlock(&session->lock);
+}
+
+// Ends and releases an acquired session.
+void session_destroy(session_t* session, session_table_t* table)
+{
+    session_shard_t* shard;
+
+    if (NULL == session || NULL == table)
+    {
+        return;
+    }
+
+    shard            = &table->shard[session->slot >> SESSION_SLOT_BITS];
+    session->attempt = SESSION_FREE;
+    SDL_AtomicUnlock(&session->lock);
+
+    SDL_AtomicLock(&shard->lock);
+    shard->free_slot[shard->free_count]  = session->slot & SESSION_SLOT_MASK;
+    shard->free_count                   += 1;
+    SDL_AtomicUnlock(&shard->lock);
+}
+
+Uint64 session_id(session_t* session)
+{
+    return ((Uint64)(Uint32)SDL_AtomicGet(&session->generation) << 32) | session->slot;
+}
+
+guess_result_t session_guess(const unsigned char* guess, state_t result[5], const lexicon_t* lexicon, session_t* session)
+{
+    const unsigned char* answer;
+    SDL_bool             is_won;
+    Uint16               row_state = 0;
+    int                  index;
+
+    if (session->attempt >= 6)
+    {
+        return GUESS_GAME_OVER;
+    }
+
+    if (SDL_FALSE == lexicon_contains(guess, lexicon))
+    {
+        return GUESS_NOT_ALLOWED;
+    }
+
+    answer = lexicon->wordlist.list[session->answer_index];
+    is_won = score_guess(guess, answer, result);
+
+    for (index = 0; index < 5; index += 1)
+    {
+        session->letter[(session->attempt * 5) + index]  = guess[index];
+        row_state                                       |= (Uint16)(result[index] << (index * 2));
+    }
+    session->row_state[session->attempt] = row_state;
+    session->attempt                    += 1;
+
+    if (SDL_TRUE == is_won)
+    {
+        session->attempt = 6;
+        return GUESS_WON;
+    }
+
+    if (session->attempt >= 6)
+    {
+        return GUESS_LOST;
+    }
+
+    return GUESS_ACCEPTED;
+}
+
+static int compare_hash(const void* a, const void* b)
+{
+    Uint32 hash_a = *(const Uint32*)a;
+    Uint32 hash_b = *(const Uint32*)b;
+
+    return (hash_a > hash_b) - (hash_a < hash_b);
+}
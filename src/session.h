@@ -0,0 +1,96 @@
+/** @file session.h
+ *
+ *  Compact game sessions for the game server.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "SDL.h"
+#include "game_core.h"
+
+// The lower 32 bits of a session ID select the shard and the slot
+// within it, the upper 32 bits hold a generation counter, so IDs of
+// ended sessions are not accidentally reused.
+#define SESSION_SLOT_BITS      24
+#define SESSION_SLOT_MASK      ((1u << SESSION_SLOT_BITS) - 1u)
+#define SESSION_MAX_SESSIONS   (1u << SESSION_SLOT_BITS)
+#define SESSION_MAX_SHARDS     256u
+#define SESSION_FREE           0xff
+#define SESSION_CACHE_LINE     64
+
+typedef enum
+{
+    GUESS_ACCEPTED = 0,
+    GUESS_WON,
+    GUESS_LOST,
+    GUESS_NOT_ALLOWED,
+    GUESS_GAME_OVER
+
+} guess_result_t;
+
+typedef struct lexicon
+{
+    wordlist_t wordlist;
+    Uint32*    sorted_hash;
+    Uint32     hash_count;
+
+} lexicon_t;
+
+// One cache line per session; the shards keep them aligned to one.
+typedef struct session
+{
+    SDL_atomic_t  generation;
+    SDL_SpinLock  lock;
+    Uint32        slot;
+    unsigned int  seed;
+    Uint16        answer_index;
+    Uint8         language;
+    Uint8         attempt;
+    unsigned char letter[30];
+    Uint16        row_state[6]; // 2 bits per tile, see state_t
+
+} session_t;
+
+typedef struct session_shard
+{
+    session_t*   session;   // Rounded up to a cache line from memory
+    void*        memory;
+    Uint32*      free_slot;
+    Uint32       capacity;
+    Uint32       free_count;
+    SDL_SpinLock lock;
+    // Keep shards written by different threads on separate cache
+    // lines.
+    Uint8        padding[SESSION_CACHE_LINE];
+
+} session_shard_t;
+
+typedef struct session_table
+{
+    session_shard_t* shard;
+    Uint32           shard_count;
+
+} session_table_t;
+
+int            lexicon_init(const lang_t language, lexicon_t* lexicon);
+void           lexicon_free(lexicon_t* lexicon);
+SDL_bool       lexicon_contains(const unsigned char* word, const lexicon_t* lexicon);
+
+int            session_table_init(Uint32 shard_count, Uint32 capacity, session_table_t* table);
+void           session_table_free(session_table_t* table);
+Uint32         session_table_count(const session_table_t* table);
+Uint32         session_table_capacity(const session_table_t* table);
+
+session_t*     session_create(unsigned int seed, Uint32 shard_hint, const lexicon_t* lexicon, session_table_t* table);
+session_t*     session_acquire(Uint64 id, session_table_t* table);
+void           session_release(session_t* session);
+void           session_destroy(session_t* session, session_table_t* table);
+Uint64         session_id(session_t* session);
+guess_result_t session_guess(const unsigned char* guess, state_t result[5], const lexicon_t* lexicon, session_t* session);
+
+#endif /* SESSION_H */
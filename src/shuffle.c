@@ -0,0 +1,114 @@
+/** @file shuffle.c
+ *
+ *  Answer order of the endless mode: every language walks through a
+ *  random permutation of its answers, so no answer repeats until all
+ *  of them have been played.
+ *
+ *  The permutation is a Fisher-Yates shuffle run one step per game,
+ *  which only needs its seed and the number of steps taken to be
+ *  restored.  Both are kept in the save state.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL_stdinc.h"
+#include "game_core.h"
+
+static Uint32 get_answer_count(const wordlist_t* wordlist);
+static void   restore_order(const wordlist_t* wordlist, shuffle_t* shuffle);
+
+// Returns the next answer of the current language.  A new permutation
+// is started with a seed taken from the game's seed once all answers
+// have been used.
+unsigned int shuffle_next_answer(const wordlist_t* wordlist, unsigned int* seed, shuffle_t* shuffle)
+{
+    Uint32  answer_count;
+    Uint32  other_index;
+    Uint16* cursor;
+    Uint16  answer;
+
+    if (NULL == wordlist || NULL == seed || NULL == shuffle || wordlist->language >= LANGUAGE_COUNT)
+    {
+        return 0;
+    }
+
+    answer_count = get_answer_count(wordlist);
+    cursor       = &shuffle->cursor[wordlist->language];
+
+    if ((0 == shuffle->seed[wordlist->language]) || (*cursor >= answer_count))
+    {
+        // xorshift never leaves a zero state.
+        shuffle->seed[wordlist->language] = xorshift(seed);
+        *cursor                           = 0;
+        shuffle->is_valid                 = SDL_FALSE;
+    }
+
+    restore_order(wordlist, shuffle);
+
+    // One step of the shuffle: pick any of the answers not used yet.
+    other_index                  = *cursor + get_random_below(answer_count - *cursor, &shuffle->random);
+    answer                       = shuffle->answer[other_index];
+    shuffle->answer[other_index] = shuffle->answer[*cursor];
+    shuffle->answer[*cursor]     = answer;
+    *cursor                     += 1;
+
+    return answer;
+}
+
+// Unbiased, unlike taking the remainder of any random number.
+Uint32 get_random_below(Uint32 limit, unsigned int* random)
+{
+    Uint32 bound = 0xffffffff - (0xffffffff % limit);
+    Uint32 value;
+
+    do
+    {
+        value = (Uint32)xorshift(random);
+    }
+    while (value >= bound);
+
+    return value % limit;
+}
+
+static Uint32 get_answer_count(const wordlist_t* wordlist)
+{
+    return (wordlist->word_count < SHUFFLE_MAX_ANSWERS) ? wordlist->word_count : SHUFFLE_MAX_ANSWERS;
+}
+
+// Replays the steps taken so far, which only happens once per
+// language and session.
+static void restore_order(const wordlist_t* wordlist, shuffle_t* shuffle)
+{
+    Uint32 answer_count;
+    Uint32 index;
+    Uint16 cursor;
+
+    if ((SDL_TRUE == shuffle->is_valid) && (wordlist->language == shuffle->language))
+    {
+        return;
+    }
+
+    answer_count = get_answer_count(wordlist);
+    cursor       = shuffle->cursor[wordlist->language];
+
+    for (index = 0; index < answer_count; index += 1)
+    {
+        shuffle->answer[index] = (Uint16)index;
+    }
+
+    shuffle->random = shuffle->seed[wordlist->language];
+
+    for (index = 0; index < cursor && index < answer_count; index += 1)
+    {
+        Uint32 other_index = index + get_random_below(answer_count - index, &shuffle->random);
+        Uint16 answer      = shuffle->answer[other_index];
+
+        shuffle->answer[other_index] = shuffle->answer[index];
+        shuffle->answer[index]       = answer;
+    }
+
+    shuffle->language = wordlist->language;
+    shuffle->is_valid = SDL_TRUE;
+}
@@ -0,0 +1,499 @@
+/** @file simulate.c
+ *
+ *  Plays every answer of a wordlist, or a number of random endless
+ *  games, against a guessing policy and reports the distribution of
+ *  guesses, the failure rate and the throughput.  Games are spread
+ *  across a work-stealing thread pool.
+ *
+ *    wordle_sim [--lang en|ru|de|fi] [--policy first|random|book]
+ *               [--games <n>] [--seed <n>] [--threads <n>]
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include <stdio.h>
+#include <time.h>
+#include "SDL.h"
+#include "game_core.h"
+
+#ifndef SIM_MAX_THREADS
+#define SIM_MAX_THREADS 64
+#endif
+
+#define SIM_CACHE_LINE 64
+
+typedef struct sim_game
+{
+    const wordlist_t*     wordlist;
+    const opening_book_t* book;
+    const unsigned char** candidate;
+    Uint32                candidate_count;
+    Uint8                 attempt;
+    Uint8                 first_pattern;
+    unsigned int          seed;
+
+} sim_game_t;
+
+// A policy picks the next guess, given the answers that are still
+// consistent with the feedback so far.  New policies only need an
+// entry in the policies table.
+typedef struct policy
+{
+    const char*          name;
+    const unsigned char* (*next_guess)(sim_game_t* game);
+
+} policy_t;
+
+typedef struct task_queue
+{
+    Uint32*      task;
+    Uint32       head;
+    Uint32       tail;
+    SDL_SpinLock lock;
+    Uint8        padding[SIM_CACHE_LINE];
+
+} task_queue_t;
+
+typedef struct simulation simulation_t;
+
+typedef struct worker
+{
+    simulation_t*         simulation;
+    SDL_Thread*           thread;
+    Uint32                index;
+    const unsigned char** candidate;
+    Uint32                distribution[7]; // Index 6: not solved
+    Uint32                steal_count;
+
+} worker_t;
+
+struct simulation
+{
+    wordlist_t      wordlist;
+    opening_book_t  book;
+    const policy_t* policy;
+    Uint32*         answer;
+    Uint32          game_count;
+    unsigned int    seed;
+    Uint32          thread_count;
+    task_queue_t    queue[SIM_MAX_THREADS];
+    worker_t        worker[SIM_MAX_THREADS];
+};
+
+static const unsigned char* policy_book(sim_game_t* game);
+static const unsigned char* policy_first(sim_game_t* game);
+static const unsigned char* policy_random(sim_game_t* game);
+
+static const policy_t policies[] =
+{
+    { "first",  policy_first  },
+    { "random", policy_random },
+    { "book",   policy_book   }
+};
+
+static void     play_game(Uint32 game_index, worker_t* worker);
+static SDL_bool pop_task(task_queue_t* queue, Uint32* task);
+static size_t   read_book(lang_t language, void* buffer, size_t size, void* user_data);
+static int      run_worker(void* data);
+static SDL_bool steal_task(task_queue_t* queue, Uint32* task);
+static void     write_book(lang_t language, const void* buffer, size_t size, void* user_data);
+
+extern void run_tasks(void (*task)(Uint32 index, void* data), Uint32 count, void* data, void* user_data);
+
+int main(int argc, char *argv[])
+{
+    simulation_t* simulation;
+    lang_t        language     = LANG_ENGLISH;
+    const char*   policy_name  = "first";
+    Uint32        game_count   = 0;
+    Uint32        thread_count = (Uint32)SDL_GetCPUCount();
+    Uint32        total[7]     = { 0 };
+    Uint32        steal_count  = 0;
+    Uint32        index;
+    Uint32        games;
+    Uint64        start;
+    double        seconds;
+    double        guesses      = 0.0;
+    int           arg;
+
+    simulation = (simulation_t*)SDL_calloc(1, sizeof(simulation_t));
+    if (NULL == simulation)
+    {
+        return 1;
+    }
+    simulation->seed = (unsigned int)time(NULL);
+
+    for (arg = 1; arg < argc; arg += 1)
+    {
+        if ((0 == SDL_strcmp(argv[arg], "--lang")) && ((arg + 1) < argc))
+        {
+            arg += 1;
+            if (0 == SDL_strcmp(argv[arg], "ru"))
+            {
+                language = LANG_RUSSIAN;
+            }
+            else if (0 == SDL_strcmp(argv[arg], "de"))
+            {
+                language = LANG_GERMAN;
+            }
+            else if (0 == SDL_strcmp(argv[arg], "fi"))
+            {
+                language = LANG_FINNISH;
+            }
+        }
+        else if ((0 == SDL_strcmp(argv[arg], "--policy")) && ((arg + 1) < argc))
+        {
+            arg         += 1;
+            policy_name  = argv[arg];
+        }
+        else if ((0 == SDL_strcmp(argv[arg], "--games")) && ((arg + 1) < argc))
+        {
+            arg        += 1;
+            game_count  = (Uint32)SDL_strtoul(argv[arg], NULL, 0);
+        }
+        else if ((0 == SDL_strcmp(argv[arg], "--seed")) && ((arg + 1) < argc))
+        {
+            arg              += 1;
+            simulation->seed  = (unsigned int)SDL_strtoul(argv[arg], NULL, 0);
+        }
+        else if ((0 == SDL_strcmp(argv[arg], "--threads")) && ((arg + 1) < argc))
+        {
+            arg          += 1;
+            thread_count  = (Uint32)SDL_strtoul(argv[arg], NULL, 0);
+        }
+    }
+
+    for (index = 0; index < SDL_arraysize(policies); index += 1)
+    {
+        if (0 == SDL_strcmp(policies[index].name, policy_name))
+        {
+            simulation->policy = &policies[index];
+        }
+    }
+
+    if (NULL == simulation->policy)
+    {
+        fprintf(stderr, "Unknown policy: %s\n", policy_name);
+        SDL_free(simulation);
+        return 1;
+    }
+
+    load_wordlist(language, &simulation->wordlist);
+    thread_count = SDL_clamp(thread_count, 1, SIM_MAX_THREADS);
+
+    // Shares the game's cache files when run from the same directory.
+    if (policy_book == simulation->policy->next_guess)
+    {
+        game_hooks_t hooks;
+
+        SDL_memset(&hooks, 0, sizeof(hooks));
+        hooks.read_book  = read_book;
+        hooks.write_book = write_book;
+        hooks.run_tasks  = run_tasks;
+
+        opening_book_load(&simulation->wordlist, &hooks, &simulation->book);
+    }
+
+    // Either every answer once, or random endless games picked the
+    // same way as in the game.
+    if (0 == game_count)
+    {
+        game_count = simulation->wordlist.word_count;
+    }
+
+    simulation->answer = (Uint32*)SDL_malloc(game_count * sizeof(Uint32));
+    if (NULL == simulation->answer)
+    {
+        SDL_free(simulation);
+        return 1;
+    }
+
+    if (game_count == simulation->wordlist.word_count)
+    {
+        for (index = 0; index < game_count; index += 1)
+        {
+            simulation->answer[index] = index;
+        }
+    }
+    else
+    {
+        unsigned int seed = (0 == simulation->seed) ? 1 : simulation->seed;
+
+        for (index = 0; index < game_count; index += 1)
+        {
+            simulation->answer[index] = xorshift(&seed) % simulation->wordlist.word_count;
+        }
+    }
+
+    simulation->game_count   = game_count;
+    simulation->thread_count = thread_count;
+
+    // Deal out contiguous blocks; idle workers steal from the others.
+    for (index = 0; index < thread_count; index += 1)
+    {
+        task_queue_t* queue = &simulation->queue[index];
+        worker_t*     worker = &simulation->worker[index];
+        Uint32        first  = (Uint32)(((Uint64)game_count * index) / thread_count);
+        Uint32        last   = (Uint32)(((Uint64)game_count * (index + 1)) / thread_count);
+        Uint32        task;
+
+        queue->task = (Uint32*)SDL_malloc((last - first + 1) * sizeof(Uint32));
+        for (task = first; NULL != queue->task && task < last; task += 1)
+        {
+            queue->task[queue->tail++] = task;
+        }
+
+        worker->simulation = simulation;
+        worker->index      = index;
+        worker->candidate  = (const unsigned char**)SDL_malloc(simulation->wordlist.word_count * sizeof(const unsigned char*));
+    }
+
+    start = SDL_GetPerformanceCounter();
+
+    for (index = 1; index < thread_count; index += 1)
+    {
+        simulation->worker[index].thread = SDL_CreateThread(run_worker, "simulation", &simulation->worker[index]);
+    }
+    run_worker(&simulation->worker[0]);
+
+    for (index = 1; index < thread_count; index += 1)
+    {
+        SDL_WaitThread(simulation->worker[index].thread, NULL);
+    }
+
+    seconds = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+
+    for (index = 0; index < thread_count; index += 1)
+    {
+        Uint32 attempt;
+
+        for (attempt = 0; attempt < 7; attempt += 1)
+        {
+            total[attempt] += simulation->worker[index].distribution[attempt];
+        }
+        steal_count += simulation->worker[index].steal_count;
+
+        SDL_free(simulation->queue[index].task);
+        SDL_free((void*)simulation->worker[index].candidate);
+    }
+
+    games = 0;
+    for (index = 0; index < 7; index += 1)
+    {
+        games += total[index];
+    }
+
+    printf("policy %s, %u games, %u threads\n", simulation->policy->name, games, thread_count);
+    for (index = 0; index < 6; index += 1)
+    {
+        printf("%u: %7u\n", index + 1, total[index]);
+        guesses += (double)(index + 1) * total[index];
+    }
+    printf("X: %7u\n", total[6]);
+
+    if (games > 0)
+    {
+        printf("failure rate %.2f %%, %.3f guesses per solved game\n",
+               100.0 * total[6] / games,
+               (games > total[6]) ? guesses / (games - total[6]) : 0.0);
+    }
+    printf("%.0f games/s (%.3f s, %u tasks stolen)\n", (seconds > 0.0) ? games / seconds : 0.0, seconds, steal_count);
+
+    SDL_free(simulation->answer);
+    SDL_free(simulation);
+
+    return 0;
+}
+
+static int run_worker(void* data)
+{
+    worker_t*     worker     = (worker_t*)data;
+    simulation_t* simulation = worker->simulation;
+    Uint32        task;
+
+    if (NULL == worker->candidate || NULL == simulation->queue[worker->index].task)
+    {
+        return 1;
+    }
+
+    for (;;)
+    {
+        Uint32 victim;
+
+        while (SDL_TRUE == pop_task(&simulation->queue[worker->index], &task))
+        {
+            play_game(task, worker);
+        }
+
+        // Own queue is empty: steal from the others, starting with the
+        // next worker.  Queues are never refilled, so one unsuccessful
+        // round means all work has been handed out.
+        for (victim = 1; victim < simulation->thread_count; victim += 1)
+        {
+            task_queue_t* queue = &simulation->queue[(worker->index + victim) % simulation->thread_count];
+
+            if (SDL_TRUE == steal_task(queue, &task))
+            {
+                worker->steal_count += 1;
+                play_game(task, worker);
+                break;
+            }
+        }
+
+        if (victim == simulation->thread_count)
+        {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+// The owner takes tasks from the back of its queue, thieves from the
+// front, so they rarely touch the same end.
+static SDL_bool pop_task(task_queue_t* queue, Uint32* task)
+{
+    SDL_bool found = SDL_FALSE;
+
+    SDL_AtomicLock(&queue->lock);
+    if (queue->head < queue->tail)
+    {
+        queue->tail -= 1;
+        *task        = queue->task[queue->tail];
+        found        = SDL_TRUE;
+    }
+    SDL_AtomicUnlock(&queue->lock);
+
+    return found;
+}
+
+static SDL_bool steal_task(task_queue_t* queue, Uint32* task)
+{
+    SDL_bool found = SDL_FALSE;
+
+    if (NULL == queue->task)
+    {
+        return SDL_FALSE;
+    }
+
+    SDL_AtomicLock(&queue->lock);
+    if (queue->head < queue->tail)
+    {
+        *task        = queue->task[queue->head];
+        queue->head += 1;
+        found        = SDL_TRUE;
+    }
+    SDL_AtomicUnlock(&queue->lock);
+
+    return found;
+}
+
+static void play_game(Uint32 game_index, worker_t* worker)
+{
+    simulation_t*        simulation = worker->simulation;
+    const unsigned char* answer     = simulation->wordlist.list[simulation->answer[game_index]];
+    sim_game_t           game;
+    Uint32               index;
+
+    game.wordlist        = &simulation->wordlist;
+    game.book            = &simulation->book;
+    game.candidate       = worker->candidate;
+    game.candidate_count = simulation->wordlist.word_count;
+    game.attempt         = 0;
+    game.first_pattern   = 0;
+    game.seed            = (simulation->seed ^ (game_index * 0x9e3779b9u)) | 1u;
+
+    for (index = 0; index < game.candidate_count; index += 1)
+    {
+        game.candidate[index] = simulation->wordlist.list[index];
+    }
+
+    for (game.attempt = 0; game.attempt < 6; game.attempt += 1)
+    {
+        const unsigned char* guess = simulation->policy->next_guess(&game);
+        state_t              result[5];
+        state_t              candidate_result[5];
+        Uint8                pattern;
+        Uint32               kept = 0;
+
+        if (SDL_TRUE == score_guess(guess, answer, result))
+        {
+            worker->distribution[game.attempt] += 1;
+            return;
+        }
+
+        // Keep the answers that would have produced the same feedback.
+        pattern = get_pattern_code(result);
+        if (0 == game.attempt)
+        {
+            game.first_pattern = pattern;
+        }
+
+        for (index = 0; index < game.candidate_count; index += 1)
+        {
+            score_guess(guess, game.candidate[index], candidate_result);
+            if (pattern == get_pattern_code(candidate_result))
+            {
+                game.candidate[kept++] = game.candidate[index];
+            }
+        }
+        game.candidate_count = kept;
+    }
+
+    worker->distribution[6] += 1;
+}
+
+// The opening book's first two guesses, then like policy_first().
+static const unsigned char* policy_book(sim_game_t* game)
+{
+    const unsigned char* guess = opening_book_guess(game->book, game->wordlist, game->attempt, game->first_pattern);
+
+    return (NULL != guess) ? guess : game->candidate[0];
+}
+
+static const unsigned char* policy_first(sim_game_t* game)
+{
+    return game->candidate[0];
+}
+
+static const unsigned char* policy_random(sim_game_t* game)
+{
+    return game->candidate[xorshift(&game->seed) % game->candidate_count];
+}
+
+static size_t read_book(lang_t language, void* buffer, size_t size, void* user_data)
+{
+    const char* book_file[] = { "book_en.bin", "book_ru.bin", "book_de.bin", "book_fi.bin" };
+    FILE*       file        = fopen(book_file[language], "rb");
+    size_t      read_size;
+
+    (void)user_data;
+
+    if (NULL == file)
+    {
+        return 0;
+    }
+
+    read_size = fread(buffer, 1, size, file);
+    fclose(file);
+
+    return read_size;
+}
+
+static void write_book(lang_t language, const void* buffer, size_t size, void* user_data)
+{
+    const char* book_file[] = { "book_en.bin", "book_ru.bin", "book_de.bin", "book_fi.bin" };
+    FILE*       file        = fopen(book_file[language], "wb");
+
+    (void)user_data;
+
+    if (NULL == file)
+    {
+        return;
+    }
+
+    fwrite(buffer, size, 1, file);
+    fclose(file);
+}
@@ -0,0 +1,392 @@
+/** @file stats.c
+ *
+ *  Game statistics: an append-only log per language with one record
+ *  per finished game, and a summary per game mode which every record
+ *  updates, so nothing is counted when the statistics are shown.
+ *
+ *  The file starts with the summary, followed by the log:
+ *
+ *    "WST" version:u8 log_size:u32 last_day:u32
+ *    played:u32 won:u32 streak:u32 max_streak:u32 last_day:u32
+ *    distribution:u32[7]           for each game mode
+ *    crc:u32                       of everything before it
+ *
+ *  Record, a single byte unless more than six days have passed since
+ *  the previous one:
+ *
+ *    bits 0-2   guesses, 0 if lost, 7 if more than six
+ *    bits 3-4   game_mode_t
+ *    bits 5-7   days since the previous record, 7 if followed by
+ *    varint     the number of days
+ *
+ *  Loading only reads the header and the records appended after it
+ *  was written, if any.  If it is missing or damaged, the summary is
+ *  rebuilt from the whole log.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL_stdinc.h"
+#include "game_core.h"
+
+#define STATS_VERSION     1
+#define STATS_CHUNK_SIZE  256
+#define STATS_RECORD_SIZE 6
+#define STATS_DAYS_ESCAPE 7
+
+static void     add_game(game_mode_t mode, Uint32 day, Uint8 guesses, stats_t* stats);
+static size_t   decode_record(const Uint8* buffer, size_t size, stats_t* stats);
+static Uint32   read_log(const game_hooks_t* hooks, stats_t* stats);
+static void     write_header(const game_hooks_t* hooks, const stats_t* stats);
+static SDL_bool read_header(const Uint8 header[STATS_HEADER_SIZE], stats_t* stats);
+static Uint8*   write_le32(Uint32 value, Uint8* data);
+static Uint32   read_le32(const Uint8** data);
+
+void stats_load(lang_t language, const game_hooks_t* hooks, stats_t* stats)
+{
+    Uint8 header[STATS_HEADER_SIZE];
+
+    if (NULL == hooks || NULL == stats)
+    {
+        return;
+    }
+
+    if ((SDL_TRUE == stats->is_valid) && (language == stats->language))
+    {
+        return;
+    }
+
+    SDL_memset(stats, 0, sizeof(stats_t));
+    stats->language = language;
+    stats->is_valid = SDL_TRUE;
+
+    if (NULL == hooks->read_stats)
+    {
+        return;
+    }
+
+    if ((sizeof(header) != hooks->read_stats(language, 0, header, sizeof(header), hooks->user_data)) ||
+        (SDL_FALSE == read_header(header, stats)))
+    {
+        SDL_memset(stats->summary, 0, sizeof(stats->summary));
+        stats->last_day = 0;
+        stats->log_size = 0;
+    }
+
+    // Records the header does not cover yet, or all of them if it is
+    // missing.
+    if (0 != read_log(hooks, stats))
+    {
+        write_header(hooks, stats);
+    }
+}
+
+// Adds a finished game, 0 guesses if it was lost.  The day counts from
+// the epoch, not the daily word, whose index wraps around.  A daily
+// game is only counted once per day.
+void stats_record(game_mode_t mode, Uint32 day, Uint8 guesses, const game_hooks_t* hooks, stats_t* stats)
+{
+    stats_summary_t* summary;
+    Uint8            record[STATS_RECORD_SIZE];
+    size_t           size = 1;
+    Uint32           days;
+
+    if (NULL == stats || SDL_FALSE == stats->is_valid || mode >= STATS_MODES)
+    {
+        return;
+    }
+
+    summary = &stats->summary[mode];
+
+    // Days only move forward in the log.
+    if (day < stats->last_day)
+    {
+        day = stats->last_day;
+    }
+
+    if ((MODE_NYT == mode) && (0 != summary->played) && (day <= summary->last_day))
+    {
+        return;
+    }
+
+    if (guesses > STATS_GUESSES)
+    {
+        guesses = STATS_GUESSES;
+    }
+
+    days      = day - stats->last_day;
+    record[0] = (Uint8)(guesses | (mode << 3));
+
+    if (days < STATS_DAYS_ESCAPE)
+    {
+        record[0] |= (Uint8)(days << 5);
+    }
+    else
+    {
+        record[0] |= (Uint8)(STATS_DAYS_ESCAPE << 5);
+
+        do
+        {
+            record[size]  = (Uint8)(days & 0x7f);
+            days        >>= 7;
+            if (0 != days)
+            {
+                record[size] |= 0x80;
+            }
+            size += 1;
+        }
+        while (0 != days);
+    }
+
+    add_game(mode, day, guesses, stats);
+    stats->log_size += (Uint32)size;
+
+    if (NULL != hooks && NULL != hooks->append_stats)
+    {
+        hooks->append_stats(stats->language, record, size, hooks->user_data);
+        write_header(hooks, stats);
+    }
+}
+
+// A missed day ends the streak of daily games.
+Uint32 stats_get_streak(const stats_t* stats, game_mode_t mode, Uint32 day)
+{
+    const stats_summary_t* summary;
+
+    if (NULL == stats || mode >= STATS_MODES)
+    {
+        return 0;
+    }
+
+    summary = &stats->summary[mode];
+
+    if ((MODE_NYT == mode) && (summary->last_day + 1 < day))
+    {
+        return 0;
+    }
+
+    return summary->streak;
+}
+
+// In percent.
+Uint8 stats_get_win_rate(const stats_t* stats, game_mode_t mode)
+{
+    const stats_summary_t* summary;
+
+    if (NULL == stats || mode >= STATS_MODES)
+    {
+        return 0;
+    }
+
+    summary = &stats->summary[mode];
+
+    if (0 == summary->played)
+    {
+        return 0;
+    }
+
+    return (Uint8)(((Uint64)summary->won * 100) / summary->played);
+}
+
+static void add_game(game_mode_t mode, Uint32 day, Uint8 guesses, stats_t* stats)
+{
+    stats_summary_t* summary = &stats->summary[mode];
+
+    summary->played += 1;
+
+    if (0 == guesses)
+    {
+        summary->streak = 0;
+    }
+    else
+    {
+        if ((MODE_NYT == mode) && (summary->last_day + 1 != day))
+        {
+            summary->streak = 0;
+        }
+
+        summary->won                        += 1;
+        summary->streak                     += 1;
+        summary->distribution[guesses - 1]  += 1;
+
+        if (summary->streak > summary->max_streak)
+        {
+            summary->max_streak = summary->streak;
+        }
+    }
+
+    summary->last_day = day;
+    stats->last_day   = day;
+}
+
+// Returns the size of the record, 0 if it is incomplete.
+static size_t decode_record(const Uint8* buffer, size_t size, stats_t* stats)
+{
+    Uint32 days;
+    size_t length = 1;
+    int    shift  = 0;
+
+    if (0 == size)
+    {
+        return 0;
+    }
+
+    days = buffer[0] >> 5;
+
+    if (STATS_DAYS_ESCAPE == days)
+    {
+        days = 0;
+
+        do
+        {
+            if ((length >= size) || (length >= STATS_RECORD_SIZE))
+            {
+                return 0;
+            }
+
+            days   |= (Uint32)(buffer[length] & 0x7f) << shift;
+            shift  += 7;
+            length += 1;
+        }
+        while (0 != (buffer[length - 1] & 0x80));
+    }
+
+    add_game((game_mode_t)((buffer[0] >> 3) & 0x03), stats->last_day + days, buffer[0] & 0x07, stats);
+
+    return length;
+}
+
+// Folds the records from the end of the summed up log onwards and
+// returns their size.  A record may span two chunks; it is read again
+// with the next.
+static Uint32 read_log(const game_hooks_t* hooks, stats_t* stats)
+{
+    Uint8  buffer[STATS_CHUNK_SIZE];
+    Uint32 log_size = stats->log_size;
+
+    for (;;)
+    {
+        size_t size     = hooks->read_stats(stats->language, STATS_HEADER_SIZE + stats->log_size, buffer, sizeof(buffer), hooks->user_data);
+        size_t position = 0;
+        size_t record_size;
+
+        if (size > sizeof(buffer))
+        {
+            break;
+        }
+
+        while (0 != (record_size = decode_record(&buffer[position], size - position, stats)))
+        {
+            position += record_size;
+        }
+
+        stats->log_size += (Uint32)position;
+
+        if ((size < sizeof(buffer)) || (0 == position))
+        {
+            break;
+        }
+    }
+
+    return stats->log_size - log_size;
+}
+
+static void write_header(const game_hooks_t* hooks, const stats_t* stats)
+{
+    Uint8  header[STATS_HEADER_SIZE];
+    Uint8* data = header;
+    int    mode;
+    int    index;
+
+    if (NULL == hooks->write_stats_header)
+    {
+        return;
+    }
+
+    *data++ = 'W';
+    *data++ = 'S';
+    *data++ = 'T';
+    *data++ = STATS_VERSION;
+    data    = write_le32(stats->log_size, data);
+    data    = write_le32(stats->last_day, data);
+
+    for (mode = 0; mode < STATS_MODES; mode += 1)
+    {
+        const stats_summary_t* summary = &stats->summary[mode];
+
+        data = write_le32(summary->played, data);
+        data = write_le32(summary->won, data);
+        data = write_le32(summary->streak, data);
+        data = write_le32(summary->max_streak, data);
+        data = write_le32(summary->last_day, data);
+
+        for (index = 0; index < STATS_GUESSES; index += 1)
+        {
+            data = write_le32(summary->distribution[index], data);
+        }
+    }
+
+    write_le32(get_crc(header, (size_t)(data - header)), data);
+
+    hooks->write_stats_header(stats->language, header, sizeof(header), hooks->user_data);
+}
+
+static SDL_bool read_header(const Uint8 header[STATS_HEADER_SIZE], stats_t* stats)
+{
+    const Uint8* data = &header[STATS_HEADER_SIZE - 4];
+    int          mode;
+    int          index;
+
+    if (('W' != header[0]) || ('S' != header[1]) || ('T' != header[2]) || (STATS_VERSION != header[3]))
+    {
+        return SDL_FALSE;
+    }
+
+    if (get_crc(header, STATS_HEADER_SIZE - 4) != read_le32(&data))
+    {
+        return SDL_FALSE;
+    }
+
+    data = &header[4];
+    stats->log_size = read_le32(&data);
+    stats->last_day = read_le32(&data);
+
+    for (mode = 0; mode < STATS_MODES; mode += 1)
+    {
+        stats_summary_t* summary = &stats->summary[mode];
+
+        summary->played     = read_le32(&data);
+        summary->won        = read_le32(&data);
+        summary->streak     = read_le32(&data);
+        summary->max_streak = read_le32(&data);
+        summary->last_day   = read_le32(&data);
+
+        for (index = 0; index < STATS_GUESSES; index += 1)
+        {
+            summary->distribution[index] = read_le32(&data);
+        }
+    }
+
+    return SDL_TRUE;
+}
+
+static Uint8* write_le32(Uint32 value, Uint8* data)
+{
+    data[0] = (Uint8)value;
+    data[1] = (Uint8)(value >> 8);
+    data[2] = (Uint8)(value >> 16);
+    data[3] = (Uint8)(value >> 24);
+
+    return data + 4;
+}
+
+static Uint32 read_le32(const Uint8** data)
+{
+    const Uint8* byte = *data;
+
+    *data += 4;
+
+    return (Uint32)byte[0] | ((Uint32)byte[1] << 8) | ((Uint32)byte[2] << 16) | ((Uint32)byte[3] << 24);
+}
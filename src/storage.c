@@ -0,0 +1,752 @@
+/** @file storage.c
+ *
+ *  Save and statistics files.  Writing a save state only copies it; the copy is
+ *  committed once no further save has been requested for a moment, on
+ *  a worker thread where available, so the game never waits for the
+ *  storage.
+ *
+ *  A commit appends the save state to a journal:
+ *
+ *    record*          size:u16le data[size]
+ *
+ *  The last complete record is the current save state.  Every
+ *  STORAGE_JOURNAL_LIMIT records, it is written to a temporary file
+ *  which then replaces the save file, and the journal is cleared.  A
+ *  crash at any point leaves either the journal or the save file
+ *  intact.
+ *
+ *  Statistics records and headers, see stats.c, are handed over the
+ *  same way but written without delay.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include <stdio.h>
+#include "SDL.h"
+#include "game.h"
+#include "stb_sprintf.h"
+
+#ifndef STORAGE_DELAY
+#define STORAGE_DELAY         1000 // ms without further saves
+#endif
+
+#ifndef STORAGE_JOURNAL_LIMIT
+#define STORAGE_JOURNAL_LIMIT 32
+#endif
+
+#if defined __SYMBIAN32__
+#define SAVE_FILE             "C:\\wordle.sav"
+#define SAVE_JOURNAL_FILE     "C:\\wordle.jnl"
+#define SAVE_TEMP_FILE        "C:\\wordle.tmp"
+#define DAILY_SAVE_FILE       "C:\\daily.sav"
+#define DAILY_JOURNAL_FILE    "C:\\daily.jnl"
+#define DAILY_TEMP_FILE       "C:\\daily.tmp"
+#define STATS_FILE_EN         "C:\\stats_en.log"
+#define STATS_FILE_RU         "C:\\stats_ru.log"
+#define STATS_FILE_DE         "C:\\stats_de.log"
+#define STATS_FILE_FI         "C:\\stats_fi.log"
+#else
+#define SAVE_FILE             "wordle.sav"
+#define SAVE_JOURNAL_FILE     "wordle.jnl"
+#define SAVE_TEMP_FILE        "wordle.tmp"
+#define DAILY_SAVE_FILE       "daily.sav"
+#define DAILY_JOURNAL_FILE    "daily.jnl"
+#define DAILY_TEMP_FILE       "daily.tmp"
+#define STATS_FILE_EN         "stats_en.log"
+#define STATS_FILE_RU         "stats_ru.log"
+#define STATS_FILE_DE         "stats_de.log"
+#define STATS_FILE_FI         "stats_fi.log"
+#endif
+
+void       storage_init(game_t* core);
+void       storage_quit(game_t* core);
+void       storage_update(game_t* core);
+SDL_bool   storage_has_save(void);
+SDL_RWops* storage_open(const char* file_name, const char* mode);
+size_t     storage_read_save(SDL_bool daily, void* buffer, size_t size, game_t* core);
+void       storage_write_save(SDL_bool daily, const void* buffer, size_t size, game_t* core);
+size_t     storage_read_stats(lang_t language, Uint32 offset, void* buffer, size_t size, game_t* core);
+void       storage_append_stats(lang_t language, const void* buffer, size_t size, game_t* core);
+void       storage_write_stats_header(lang_t language, const void* buffer, size_t size, game_t* core);
+
+static void     commit_pending(SDL_bool flush, storage_t* storage);
+static void     commit_save(SDL_bool daily, const Uint8* buffer, size_t size, storage_t* storage);
+static void     commit_stats(storage_t* storage);
+static SDL_bool reserve_log(size_t size, Uint8** log, size_t* capacity);
+static void     write_stats(lang_t language, stats_slot_t* slot);
+static SDL_bool replace_file(const char* temp_name, const char* file_name);
+static size_t   read_journal(SDL_bool daily, void* buffer, size_t size);
+static void     get_storage_path(const char* file_name, char* path, size_t size);
+static int      run_writer(void* data);
+
+void storage_init(game_t* core)
+{
+    storage_t* storage = &core->storage;
+    int        language;
+
+    SDL_memset(storage, 0, sizeof(storage_t));
+
+    // Allocated up front, so that recording a game does not allocate
+    // unless records pile up.
+    for (language = 0; language < LANGUAGE_COUNT; language += 1)
+    {
+        stats_slot_t* slot = &storage->stats[language];
+
+        reserve_log(STORAGE_STATS_SIZE, &slot->log, &slot->log_capacity);
+        reserve_log(STORAGE_STATS_SIZE, &slot->writing, &slot->writing_capacity);
+    }
+
+    // The first commit compacts, which drops a torn record a crash
+    // may have left at the end of the journal.
+    storage->journal_count[0] = STORAGE_JOURNAL_LIMIT;
+    storage->journal_count[1] = STORAGE_JOURNAL_LIMIT;
+
+    // Without a worker, pending saves are committed by
+    // storage_update().  The N-Gage writes on the main thread.
+#ifndef __SYMBIAN32__
+    storage->lock = SDL_CreateMutex();
+    storage->wake = SDL_CreateCond();
+
+    if (NULL != storage->lock && NULL != storage->wake)
+    {
+        storage->thread = SDL_CreateThread(run_writer, "storage", storage);
+    }
+#endif
+}
+
+// Commits everything that is still pending.
+void storage_quit(game_t* core)
+{
+    storage_t* storage = &core->storage;
+    int        language;
+
+    if (NULL != storage->thread)
+    {
+        SDL_LockMutex(storage->lock);
+        storage->quit = SDL_TRUE;
+        SDL_CondSignal(storage->wake);
+        SDL_UnlockMutex(storage->lock);
+
+        SDL_WaitThread(storage->thread, NULL);
+        storage->thread = NULL;
+    }
+    else
+    {
+        commit_pending(SDL_TRUE, storage);
+    }
+
+    if (NULL != storage->wake)
+    {
+        SDL_DestroyCond(storage->wake);
+        storage->wake = NULL;
+    }
+
+    if (NULL != storage->lock)
+    {
+        SDL_DestroyMutex(storage->lock);
+        storage->lock = NULL;
+    }
+
+    for (language = 0; language < LANGUAGE_COUNT; language += 1)
+    {
+        SDL_free(storage->stats[language].log);
+        SDL_free(storage->stats[language].writing);
+    }
+}
+
+// Called once per frame.
+void storage_update(game_t* core)
+{
+    if (NULL == core->storage.thread)
+    {
+        commit_pending(SDL_FALSE, &core->storage);
+    }
+}
+
+SDL_bool storage_has_save(void)
+{
+    const char* file_name[2] = { SAVE_FILE, SAVE_JOURNAL_FILE };
+    int         index;
+
+    for (index = 0; index < 2; index += 1)
+    {
+        SDL_RWops* file = storage_open(file_name[index], "rb");
+
+        if (NULL != file)
+        {
+            SDL_RWclose(file);
+            return SDL_TRUE;
+        }
+    }
+
+    return SDL_FALSE;
+}
+
+SDL_RWops* storage_open(const char* file_name, const char* mode)
+{
+    char file_path[256] = { 0 };
+
+    get_storage_path(file_name, file_path, sizeof(file_path));
+
+    return SDL_RWFromFile(file_path, mode);
+}
+
+size_t storage_read_save(SDL_bool daily, void* buffer, size_t size, game_t* core)
+{
+    save_slot_t* slot      = &core->storage.slot[daily ? 1 : 0];
+    size_t       read_size = 0;
+    SDL_RWops*   save_file;
+
+    // Anything saved in this session is newer than the files.
+    if (NULL != core->storage.lock)
+    {
+        SDL_LockMutex(core->storage.lock);
+    }
+
+    if (0 != slot->size)
+    {
+        read_size = (slot->size < size) ? slot->size : size;
+        SDL_memcpy(buffer, slot->buffer, read_size);
+    }
+
+    if (NULL != core->storage.lock)
+    {
+        SDL_UnlockMutex(core->storage.lock);
+    }
+
+    if (0 != read_size)
+    {
+        return read_size;
+    }
+
+    read_size = read_journal(daily, buffer, size);
+    if (0 != read_size)
+    {
+        return read_size;
+    }
+
+    save_file = storage_open(daily ? DAILY_SAVE_FILE : SAVE_FILE, "rb");
+    if (NULL == save_file)
+    {
+        return 0;
+    }
+
+    read_size = SDL_RWread(save_file, buffer, 1, size);
+    SDL_RWclose(save_file);
+
+    return read_size;
+}
+
+void storage_write_save(SDL_bool daily, const void* buffer, size_t size, game_t* core)
+{
+    save_slot_t* slot = &core->storage.slot[daily ? 1 : 0];
+
+    if (size > SAVE_BUFFER_SIZE)
+    {
+        return;
+    }
+
+    if (NULL != core->storage.lock)
+    {
+        SDL_LockMutex(core->storage.lock);
+    }
+
+    SDL_memcpy(slot->buffer, buffer, size);
+    slot->size          = size;
+    slot->is_pending    = SDL_TRUE;
+    slot->request_ticks = SDL_GetTicks();
+
+    if (NULL != core->storage.lock)
+    {
+        SDL_CondSignal(core->storage.wake);
+        SDL_UnlockMutex(core->storage.lock);
+    }
+}
+
+size_t storage_read_stats(lang_t language, Uint32 offset, void* buffer, size_t size, game_t* core)
+{
+    const char*   stats_file[] = { STATS_FILE_EN, STATS_FILE_RU, STATS_FILE_DE, STATS_FILE_FI };
+    stats_slot_t* slot         = &core->storage.stats[language];
+    size_t        header_size  = 0;
+    size_t        read_size    = 0;
+    SDL_RWops*    file;
+
+    // A header written in this session is newer than the file.  The
+    // records it covers are not read back, they are already summed up.
+    if (NULL != core->storage.lock)
+    {
+        SDL_LockMutex(core->storage.lock);
+    }
+
+    if ((SDL_TRUE == slot->is_header_pending) && (offset < STATS_HEADER_SIZE))
+    {
+        header_size = STATS_HEADER_SIZE - offset;
+        if (header_size > size)
+        {
+            header_size = size;
+        }
+        SDL_memcpy(buffer, &slot->header[offset], header_size);
+    }
+
+    if (NULL != core->storage.lock)
+    {
+        SDL_UnlockMutex(core->storage.lock);
+    }
+
+    if (header_size == size)
+    {
+        return size;
+    }
+
+    file = storage_open(stats_file[language], "rb");
+    if (NULL == file)
+    {
+        return header_size;
+    }
+
+    offset += (Uint32)header_size;
+
+    if (offset == SDL_RWseek(file, offset, RW_SEEK_SET))
+    {
+        read_size = SDL_RWread(file, (Uint8*)buffer + header_size, 1, size - header_size);
+    }
+    SDL_RWclose(file);
+
+    return header_size + read_size;
+}
+
+// Records are committed right away, without waiting for further ones,
+// and never by the caller.  While the writer holds the previous ones,
+// they wait in the log, which grows if they pile up, e.g. on a full
+// disk.  Should that fail, the record is left out of the log.  The
+// header is then no longer written, as it would count the record, and
+// the next start sums up the log instead.
+void storage_append_stats(lang_t language, const void* buffer, size_t size, game_t* core)
+{
+    storage_t*    storage = &core->storage;
+    stats_slot_t* slot    = &storage->stats[language];
+
+    if (size > STORAGE_STATS_SIZE)
+    {
+        return;
+    }
+
+    if (NULL != storage->lock)
+    {
+        SDL_LockMutex(storage->lock);
+    }
+
+    if (SDL_TRUE == reserve_log(slot->log_size + size, &slot->log, &slot->log_capacity))
+    {
+        SDL_memcpy(&slot->log[slot->log_size], buffer, size);
+        slot->log_size += size;
+    }
+    else
+    {
+        slot->is_log_lost       = SDL_TRUE;
+        slot->is_header_pending = SDL_FALSE;
+    }
+
+    if (NULL != storage->lock)
+    {
+        SDL_CondSignal(storage->wake);
+        SDL_UnlockMutex(storage->lock);
+    }
+}
+
+void storage_write_stats_header(lang_t language, const void* buffer, size_t size, game_t* core)
+{
+    storage_t*    storage = &core->storage;
+    stats_slot_t* slot    = &storage->stats[language];
+
+    if (STATS_HEADER_SIZE != size)
+    {
+        return;
+    }
+
+    if (NULL != storage->lock)
+    {
+        SDL_LockMutex(storage->lock);
+    }
+
+    if (SDL_FALSE == slot->is_log_lost)
+    {
+        SDL_memcpy(slot->header, buffer, size);
+        slot->is_header_pending = SDL_TRUE;
+    }
+
+    if (NULL != storage->lock)
+    {
+        SDL_CondSignal(storage->wake);
+        SDL_UnlockMutex(storage->lock);
+    }
+}
+
+// Without a worker thread only.
+static void commit_pending(SDL_bool flush, storage_t* storage)
+{
+    Uint32 ticks = SDL_GetTicks();
+    int    index;
+
+    commit_stats(storage);
+
+    for (index = 0; index < 2; index += 1)
+    {
+        save_slot_t* slot = &storage->slot[index];
+
+        if (SDL_FALSE == slot->is_pending)
+        {
+            continue;
+        }
+
+        if ((SDL_FALSE == flush) && (ticks - slot->request_ticks < STORAGE_DELAY))
+        {
+            continue;
+        }
+
+        slot->is_pending = SDL_FALSE;
+        commit_save((SDL_bool)index, slot->buffer, slot->size, storage);
+    }
+}
+
+static void commit_save(SDL_bool daily, const Uint8* buffer, size_t size, storage_t* storage)
+{
+    Uint8*     journal_count = &storage->journal_count[daily ? 1 : 0];
+    SDL_bool   is_appended   = SDL_FALSE;
+    SDL_RWops* file;
+
+    file = storage_open(daily ? DAILY_JOURNAL_FILE : SAVE_JOURNAL_FILE, "ab");
+    if (NULL != file)
+    {
+        Uint8 header[2];
+
+        header[0] = (Uint8)(size & 0xff);
+        header[1] = (Uint8)(size >> 8);
+
+        if ((1 == SDL_RWwrite(file, header, sizeof(header), 1)) && (1 == SDL_RWwrite(file, buffer, size, 1)))
+        {
+            is_appended = SDL_TRUE;
+        }
+        SDL_RWclose(file);
+    }
+
+    if (*journal_count < STORAGE_JOURNAL_LIMIT)
+    {
+        *journal_count += 1;
+    }
+
+    if ((SDL_TRUE == is_appended) && (*journal_count < STORAGE_JOURNAL_LIMIT))
+    {
+        return;
+    }
+
+    // Compact.  The journal is only cleared once the save file has
+    // been replaced.
+    file = storage_open(daily ? DAILY_TEMP_FILE : SAVE_TEMP_FILE, "wb");
+    if (NULL == file)
+    {
+        return;
+    }
+
+    if (1 != SDL_RWwrite(file, buffer, size, 1))
+    {
+        SDL_RWclose(file);
+        return;
+    }
+    SDL_RWclose(file);
+
+    if (SDL_TRUE == replace_file(daily ? DAILY_TEMP_FILE : SAVE_TEMP_FILE, daily ? DAILY_SAVE_FILE : SAVE_FILE))
+    {
+        file = storage_open(daily ? DAILY_JOURNAL_FILE : SAVE_JOURNAL_FILE, "wb");
+        if (NULL != file)
+        {
+            SDL_RWclose(file);
+        }
+        *journal_count = 0;
+    }
+}
+
+// Called with the lock held, if any, which is released while writing.
+// The writer takes the log and leaves its own buffer for new records;
+// it only gives it back once everything in it was written, so nothing
+// is lost if the file could not be written.  Until then, the header is
+// still read from memory.
+static void commit_stats(storage_t* storage)
+{
+    int language;
+
+    for (language = 0; language < LANGUAGE_COUNT; language += 1)
+    {
+        stats_slot_t* slot = &storage->stats[language];
+        stats_slot_t  copy;
+        SDL_bool      is_header_written;
+
+        if ((0 == slot->log_size) && (0 == slot->writing_size) && (SDL_FALSE == slot->is_header_pending))
+        {
+            continue;
+        }
+
+        if (0 == slot->writing_size)
+        {
+            Uint8* log      = slot->log;
+            size_t capacity = slot->log_capacity;
+
+            slot->log              = slot->writing;
+            slot->log_capacity     = slot->writing_capacity;
+            slot->writing          = log;
+            slot->writing_capacity = capacity;
+            slot->writing_size     = slot->log_size;
+            slot->log_size         = 0;
+        }
+        else if ((0 != slot->log_size) && (SDL_TRUE == reserve_log(slot->writing_size + slot->log_size, &slot->writing, &slot->writing_capacity)))
+        {
+            SDL_memcpy(&slot->writing[slot->writing_size], slot->log, slot->log_size);
+            slot->writing_size += slot->log_size;
+            slot->log_size      = 0;
+        }
+
+        // The header covers all records, it must not get ahead of the
+        // file's log.
+        SDL_memcpy(copy.header, slot->header, STATS_HEADER_SIZE);
+        copy.log               = slot->writing;
+        copy.log_size          = slot->writing_size;
+        copy.is_header_pending = ((SDL_TRUE == slot->is_header_pending) && (0 == slot->log_size)) ? SDL_TRUE : SDL_FALSE;
+        is_header_written      = copy.is_header_pending;
+
+        if (NULL != storage->lock)
+        {
+            SDL_UnlockMutex(storage->lock);
+        }
+
+        write_stats((lang_t)language, &copy);
+
+        if (NULL != storage->lock)
+        {
+            SDL_LockMutex(storage->lock);
+        }
+
+        if (0 == copy.log_size)
+        {
+            slot->writing_size = 0;
+        }
+
+        if ((SDL_TRUE == is_header_written) && (SDL_FALSE == copy.is_header_pending) && (0 == SDL_memcmp(slot->header, copy.header, STATS_HEADER_SIZE)))
+        {
+            slot->is_header_pending = SDL_FALSE;
+        }
+    }
+}
+
+// Grows the buffer to hold at least size bytes.
+static SDL_bool reserve_log(size_t size, Uint8** log, size_t* capacity)
+{
+    size_t grown_capacity = (0 == *capacity) ? STORAGE_STATS_SIZE : *capacity;
+    Uint8* grown;
+
+    if (size <= *capacity)
+    {
+        return SDL_TRUE;
+    }
+
+    while (grown_capacity < size)
+    {
+        grown_capacity *= 2;
+    }
+
+    grown = (Uint8*)SDL_realloc(*log, grown_capacity);
+    if (NULL == grown)
+    {
+        return SDL_FALSE;
+    }
+
+    *log      = grown;
+    *capacity = grown_capacity;
+
+    return SDL_TRUE;
+}
+
+// Records are appended before the header which covers them is
+// replaced, so the header is never ahead of the log.  Clears what was
+// written.
+static void write_stats(lang_t language, stats_slot_t* slot)
+{
+    const char* stats_file[] = { STATS_FILE_EN, STATS_FILE_RU, STATS_FILE_DE, STATS_FILE_FI };
+    SDL_RWops*  file;
+
+    file = storage_open(stats_file[language], "r+b");
+    if (NULL == file)
+    {
+        file = storage_open(stats_file[language], "w+b");
+        if (NULL == file)
+        {
+            return;
+        }
+    }
+
+    // A new file starts with the header.  Without one to write yet, it
+    // is left blank, which has the log summed up when loading.
+    if (SDL_RWseek(file, 0, RW_SEEK_END) < STATS_HEADER_SIZE)
+    {
+        Uint8 blank[STATS_HEADER_SIZE];
+
+        SDL_memset(blank, 0, sizeof(blank));
+
+        if ((0 != SDL_RWseek(file, 0, RW_SEEK_SET)) ||
+            (1 != SDL_RWwrite(file, (SDL_TRUE == slot->is_header_pending) ? slot->header : blank, STATS_HEADER_SIZE, 1)))
+        {
+            SDL_RWclose(file);
+            return;
+        }
+        slot->is_header_pending = SDL_FALSE;
+    }
+
+    if (0 != slot->log_size)
+    {
+        if (1 != SDL_RWwrite(file, slot->log, slot->log_size, 1))
+        {
+            SDL_RWclose(file);
+            return;
+        }
+        slot->log_size = 0;
+    }
+
+    if ((SDL_TRUE == slot->is_header_pending) &&
+        (0 == SDL_RWseek(file, 0, RW_SEEK_SET)) &&
+        (1 == SDL_RWwrite(file, slot->header, STATS_HEADER_SIZE, 1)))
+    {
+        slot->is_header_pending = SDL_FALSE;
+    }
+
+    SDL_RWclose(file);
+}
+
+static SDL_bool replace_file(const char* temp_name, const char* file_name)
+{
+    char temp_path[256] = { 0 };
+    char file_path[256] = { 0 };
+
+    get_storage_path(temp_name, temp_path, sizeof(temp_path));
+    get_storage_path(file_name, file_path, sizeof(file_path));
+
+#ifdef _WIN32
+    // rename() does not replace existing files here.  The journal
+    // still holds the save state until the rename has succeeded.
+    remove(file_path);
+#endif
+
+    return (0 == rename(temp_path, file_path)) ? SDL_TRUE : SDL_FALSE;
+}
+
+// Returns the last complete record; a torn one at the end is ignored.
+static size_t read_journal(SDL_bool daily, void* buffer, size_t size)
+{
+    SDL_RWops* file;
+    size_t     read_size = 0;
+    Uint8      record[SAVE_BUFFER_SIZE];
+    Uint8      header[2];
+
+    file = storage_open(daily ? DAILY_JOURNAL_FILE : SAVE_JOURNAL_FILE, "rb");
+    if (NULL == file)
+    {
+        return 0;
+    }
+
+    while (1 == SDL_RWread(file, header, sizeof(header), 1))
+    {
+        size_t record_size = (size_t)header[0] | ((size_t)header[1] << 8);
+
+        if ((0 == record_size) || (record_size > sizeof(record)) || (1 != SDL_RWread(file, record, record_size, 1)))
+        {
+            break;
+        }
+
+        read_size = (record_size < size) ? record_size : size;
+        SDL_memcpy(buffer, record, read_size);
+    }
+
+    SDL_RWclose(file);
+
+    return read_size;
+}
+
+static void get_storage_path(const char* file_name, char* path, size_t size)
+{
+#ifdef __ANDROID__
+    stbsp_snprintf(path, (int)size, "%s/%s", SDL_AndroidGetInternalStoragePath(), file_name);
+#else
+    SDL_strlcpy(path, file_name, size);
+#endif
+}
+
+static int run_writer(void* data)
+{
+    storage_t* storage = (storage_t*)data;
+
+    SDL_LockMutex(storage->lock);
+
+    for (;;)
+    {
+        Uint32       ticks = SDL_GetTicks();
+        save_slot_t* slot  = NULL;
+        Uint32       wait  = 0;
+        int          index;
+
+        commit_stats(storage);
+
+        for (index = 0; index < 2; index += 1)
+        {
+            Uint32 elapsed = ticks - storage->slot[index].request_ticks;
+
+            if (SDL_FALSE == storage->slot[index].is_pending)
+            {
+                continue;
+            }
+
+            if ((SDL_TRUE == storage->quit) || (elapsed >= STORAGE_DELAY))
+            {
+                slot = &storage->slot[index];
+                break;
+            }
+
+            if (0 == wait || STORAGE_DELAY - elapsed < wait)
+            {
+                wait = STORAGE_DELAY - elapsed;
+            }
+        }
+
+        if (NULL != slot)
+        {
+            Uint8  buffer[SAVE_BUFFER_SIZE];
+            size_t size = slot->size;
+
+            SDL_memcpy(buffer, slot->buffer, size);
+            slot->is_pending = SDL_FALSE;
+
+            // Further saves may be requested while writing.
+            SDL_UnlockMutex(storage->lock);
+            commit_save((SDL_bool)index, buffer, size, storage);
+            SDL_LockMutex(storage->lock);
+            continue;
+        }
+
+        if (SDL_TRUE == storage->quit)
+        {
+            break;
+        }
+
+        if (0 == wait)
+        {
+            SDL_CondWait(storage->wake, storage->lock);
+        }
+        else
+        {
+            SDL_CondWaitTimeout(storage->wake, storage->lock, wait);
+        }
+    }
+
+    SDL_UnlockMutex(storage->lock);
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/** @file suggest.c
+ *
+ *  Suggests the closest allowed words when a guess is rejected.
+ *
+ *  All words have five letters, so the distance between two words is
+ *  the number of positions in which they differ.  Each word is packed
+ *  into a Uint32 with six bits per letter, which allows comparing all
+ *  five letters at once; a scan over the largest word list takes well
+ *  below a millisecond.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL_stdinc.h"
+#include "game_core.h"
+
+#define FIELD_LOW_BITS 0x01041041 // Lowest bit of each letter
+#define MAX_DISTANCE   2          // Anything further is not helpful
+
+static Uint32 pack_word(const unsigned char* word, const Uint8 letter_code[256]);
+
+// Packs every answer and allowed guess of a word list.  Letters are
+// numbered in the order they first appear, so any alphabet fits.
+void suggest_build(const wordlist_t* wordlist, suggest_t* index)
+{
+    Uint32 word_index;
+    Uint8  next_code = 1;
+
+    if (NULL == wordlist || NULL == index)
+    {
+        return;
+    }
+
+    if ((SDL_TRUE == index->is_valid) && (wordlist->language == index->language))
+    {
+        return;
+    }
+
+    SDL_memset(index->letter_code, 0, sizeof(index->letter_code));
+
+    index->word_count = wordlist->word_count + ((NULL != wordlist->allowed_list) ? wordlist->allowed_count : 0);
+    if (index->word_count > SUGGEST_MAX_WORDS)
+    {
+        index->word_count = SUGGEST_MAX_WORDS;
+    }
+
+    for (word_index = 0; word_index < index->word_count; word_index += 1)
+    {
+        const unsigned char* word = get_guess_word(wordlist, word_index);
+        int                  letter_index;
+
+        for (letter_index = 0; letter_index < 5; letter_index += 1)
+        {
+            if ((0 == index->letter_code[word[letter_index]]) && (next_code < 0x3f))
+            {
+                index->letter_code[word[letter_index]] = next_code;
+                next_code                             += 1;
+            }
+        }
+
+        index->packed[word_index] = pack_word(word, index->letter_code);
+    }
+
+    index->language = wordlist->language;
+    index->is_valid = SDL_TRUE;
+}
+
+// Fills in up to SUGGEST_COUNT guess indices, closest first, see
+// get_guess_word().  Answers come before other allowed words at the
+// same distance.  Returns the number of suggestions.
+Uint8 suggest_words(const suggest_t* index, const unsigned char* guess, Uint32 suggestion[SUGGEST_COUNT])
+{
+    Uint8  distance[SUGGEST_COUNT];
+    Uint8  count = 0;
+    Uint32 packed_guess;
+    Uint32 word_index;
+
+    if (NULL == index || NULL == guess || SDL_FALSE == index->is_valid)
+    {
+        return 0;
+    }
+
+    packed_guess = pack_word(guess, index->letter_code);
+
+    for (word_index = 0; word_index < index->word_count; word_index += 1)
+    {
+        Uint32 diff = packed_guess ^ index->packed[word_index];
+        Uint8  word_distance;
+        int    slot;
+
+        // Fold each six-bit field onto its lowest bit, then add up
+        // the fields in the top one.
+        diff |= diff >> 1;
+        diff |= diff >> 2;
+        diff |= diff >> 2;
+        diff &= FIELD_LOW_BITS;
+
+        word_distance = (Uint8)(((diff * FIELD_LOW_BITS) >> 24) & 0x3f);
+
+        if (0 == word_distance || word_distance > MAX_DISTANCE)
+        {
+            continue;
+        }
+
+        if (SUGGEST_COUNT == count && word_distance >= distance[count - 1])
+        {
+            continue;
+        }
+
+        // Insert, keeping the list sorted by distance.
+        slot = (count < SUGGEST_COUNT) ? count : SUGGEST_COUNT - 1;
+        while (slot > 0 && distance[slot - 1] > word_distance)
+        {
+            distance[slot]   = distance[slot - 1];
+            suggestion[slot] = suggestion[slot - 1];
+            slot            -= 1;
+        }
+
+        distance[slot]   = word_distance;
+        suggestion[slot] = word_index;
+
+        if (count < SUGGEST_COUNT)
+        {
+            count += 1;
+        }
+    }
+
+    return count;
+}
+
+// Letters that do not occur in the word list get code 0, which never
+// matches.
+static Uint32 pack_word(const unsigned char* word, const Uint8 letter_code[256])
+{
+    Uint32 packed = 0;
+    int    letter_index;
+
+    for (letter_index = 0; letter_index < 5; letter_index += 1)
+    {
+        packed |= (Uint32)letter_code[word[letter_index]] << (letter_index * 6);
+    }
+
+    return packed;
+}
@@ -0,0 +1,85 @@
+/** @file tasks.c
+ *
+ *  Runs a batch of independent tasks on all CPUs, see the run_tasks
+ *  hook in game_core.h.
+ *
+ *  Copyright (c) 2022, Michael Fitzmayer. All rights reserved.
+ *  SPDX-License-Identifier: MIT
+ *
+ **/
+
+#include "SDL.h"
+
+#ifndef TASKS_MAX_THREADS
+#define TASKS_MAX_THREADS 16
+#endif
+
+typedef struct task_batch
+{
+    void         (*task)(Uint32 index, void* data);
+    void*        data;
+    Uint32       count;
+    SDL_atomic_t next;
+
+} task_batch_t;
+
+void run_tasks(void (*task)(Uint32 index, void* data), Uint32 count, void* data, void* user_data);
+
+static int run_worker(void* data);
+
+void run_tasks(void (*task)(Uint32 index, void* data), Uint32 count, void* data, void* user_data)
+{
+    SDL_Thread*  thread[TASKS_MAX_THREADS];
+    task_batch_t batch;
+    int          thread_count = SDL_GetCPUCount();
+    int          index;
+
+    (void)user_data;
+
+    batch.task  = task;
+    batch.data  = data;
+    batch.count = count;
+    SDL_AtomicSet(&batch.next, 0);
+
+    thread_count = SDL_clamp(thread_count, 1, TASKS_MAX_THREADS);
+    if ((Uint32)thread_count > count)
+    {
+        thread_count = (int)count;
+    }
+
+    // The calling thread works as well; if a thread cannot be created,
+    // the others pick up its share.
+    for (index = 1; index < thread_count; index += 1)
+    {
+        thread[index] = SDL_CreateThread(run_worker, "tasks", &batch);
+    }
+
+    run_worker(&batch);
+
+    for (index = 1; index < thread_count; index += 1)
+    {
+        if (NULL != thread[index])
+        {
+            SDL_WaitThread(thread[index], NULL);
+        }
+    }
+}
+
+static int run_worker(void* data)
+{
+    task_batch_t* batch = (task_batch_t*)data;
+
+    for (;;)
+    {
+        Uint32 index = (Uint32)SDL_AtomicAdd(&batch->next, 1);
+
+        if (index >= batch->count)
+        {
+            break;
+        }
+
+        batch->task(index, batch->data);
+    }
+
+    return 0;
+}
@@ -10,94 +10,308 @@
 #include "SDL.h"
 #include "game.h"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+int    load_surface_from_file(const pfs_t* pfs, const char* file_name, Uint32 format, arena_t* arena, SDL_Surface** surface);
+int    load_texture_from_file(const char* file_name, image_t** texture, game_t* core);
+void   free_texture(image_t* texture);
+Uint32 select_texture_format(game_t* core);
+
+static unsigned char* load_image_from_file(const pfs_t* pfs, const char* file_name, arena_t* arena, int* width, int* height);
+static void*          decoder_alloc(size_t size);
+static void*          decoder_realloc(void* pointer, size_t size);
+static void           decoder_free(void* pointer);
+
+extern size_t  size_of_file(const pfs_t * pfs, const char * path);
+extern Uint8  *load_binary_file_from_path(const pfs_t * pfs, const char * path, arena_t * arena);
+extern void    arena_reset(arena_t* arena);
+extern void*   arena_alloc(size_t size, arena_t* arena);
+extern void*   arena_realloc(void* pointer, size_t size, arena_t* arena);
+extern void    arena_free(void* pointer, arena_t* arena);
+extern Uint32  arena_get_heap_allocations(void);
 
-int          load_texture_from_file(const char* file_name, SDL_Texture** texture, game_t* core);
-Uint32       generate_hash(const unsigned char* name);
-unsigned int xorshift(unsigned int* xs);
+// The decoder's buffers are only needed while loading, see arena.c.
+// Its allocators take no context, so the arena of the caller is kept
+// in thread-local storage for the duration of each
+// stbi_load_from_memory(); instances may load on different threads.
+static SDL_TLSID    decoder_arena;
+static SDL_SpinLock decoder_arena_lock;
 
-extern size_t  size_of_file(const char * path);
-extern Uint8  *load_binary_file_from_path(const char * path);
+#define STBI_MALLOC(size)           decoder_alloc(size)
+#define STBI_REALLOC(pointer, size) decoder_realloc(pointer, size)
+#define STBI_FREE(pointer)          decoder_free(pointer)
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
 
-int load_texture_from_file(const char* file_name, SDL_Texture** texture, game_t* core)
+int load_surface_from_file(const pfs_t* pfs, const char* file_name, Uint32 format, arena_t* arena, SDL_Surface** surface)
 {
-    Uint8*         resource_buf;
-    SDL_RWops*     resource;
-    SDL_Surface*   surface;
+    SDL_Surface*   image;
     unsigned char* image_data;
-    int            req_format = STBI_rgb;
     int            width;
     int            height;
-    int            orig_format;
 
-    if (NULL == file_name)
+    image_data = load_image_from_file(pfs, file_name, arena, &width, &height);
+    if (NULL == image_data)
     {
         return 1;
     }
 
-    resource_buf = (Uint8*)load_binary_file_from_path(file_name);
-    if (NULL == resource_buf)
+    image = SDL_CreateRGBSurfaceWithFormatFrom((void*)image_data, width, height, 24, 3 * width, SDL_PIXELFORMAT_RGB24);
+
+    if (NULL == image)
     {
+        arena_free(image_data, arena);
         return 1;
     }
 
-    resource = SDL_RWFromConstMem((Uint8*)resource_buf, size_of_file(file_name));
-    if (NULL == resource)
+    // Convert once at load time so that blitting onto the render
+    // target never has to convert pixel formats.
+    *surface = SDL_ConvertSurfaceFormat(image, format, 0);
+    SDL_FreeSurface(image);
+    arena_free(image_data, arena);
+
+    if (NULL == *surface)
     {
-        free(resource_buf);
         return 1;
     }
 
-    image_data = stbi_load_from_memory(resource_buf, size_of_file(file_name), &width, &height, &orig_format, req_format);
+    return 0;
+}
+
+// Resets the arena once the image is uploaded.
+int load_texture_from_file(const char* file_name, image_t** texture, game_t* core)
+{
+#ifdef USE_FRAMEBUFFER
+    int status = load_surface_from_file(&core->pfs, file_name, core->screen->format->format, &core->arena, texture);
+
+    arena_reset(&core->arena);
+
+    return status;
+#else
+    unsigned char* image_data;
+    Uint8*         pixels;
+    SDL_Rect       band;
+    int            width;
+    int            height;
+    int            pitch;
+    int            status     = 1;
+
+    image_data = load_image_from_file(&core->pfs, file_name, &core->arena, &width, &height);
     if (NULL == image_data)
     {
-        free(resource_buf);
+        arena_reset(&core->arena);
         return 1;
     }
-    free(resource_buf);
 
-    surface = SDL_CreateRGBSurfaceWithFormatFrom((void*)image_data, width, height, 24, 3 * width, SDL_PIXELFORMAT_RGB24);
+    // Convert once at load time so that blitting onto the render
+    // target never has to convert pixel formats.  The pixels are
+    // converted and uploaded a band of rows at a time, so no copy of
+    // the whole image is needed.
+    pitch    = width * SDL_BYTESPERPIXEL(core->texture_format);
+    pixels   = (Uint8*)arena_alloc((size_t)pitch * ARENA_BAND_ROWS, &core->arena);
+    *texture = SDL_CreateTexture(core->renderer, core->texture_format, SDL_TEXTUREACCESS_STATIC, width, height);
 
-    if (NULL == surface)
+    if ((NULL != pixels) && (NULL != *texture))
     {
-        stbi_image_free(image_data);
-        return 1;
+        status = 0;
+
+        for (band.y = 0; band.y < height; band.y += ARENA_BAND_ROWS)
+        {
+            band.x = 0;
+            band.w = width;
+            band.h = (height - band.y < ARENA_BAND_ROWS) ? (height - band.y) : ARENA_BAND_ROWS;
+
+            if ((0 != SDL_ConvertPixels(band.w, band.h, SDL_PIXELFORMAT_RGB24, &image_data[band.y * 3 * width], 3 * width, core->texture_format, pixels, pitch)) ||
+                (0 != SDL_UpdateTexture(*texture, &band, pixels, pitch)))
+            {
+                status = 1;
+                break;
+            }
+        }
     }
 
-    *texture = SDL_CreateTextureFromSurface(core->renderer, surface);
-    if (NULL == *texture)
+    if ((0 != status) && (NULL != *texture))
     {
-        SDL_FreeSurface(surface);
-        stbi_image_free(image_data);
-        return 1;
+        SDL_DestroyTexture(*texture);
+        *texture = NULL;
     }
-    SDL_FreeSurface(surface);
-    stbi_image_free(image_data);
 
-    return 0;
+    // Either may have come from the heap if the arena was full.
+    arena_free(pixels, &core->arena);
+    arena_free(image_data, &core->arena);
+    arena_reset(&core->arena);
+
+    return status;
+#endif
+}
+
+void free_texture(image_t* texture)
+{
+#ifdef USE_FRAMEBUFFER
+    SDL_FreeSurface(texture);
+#else
+    SDL_DestroyTexture(texture);
+#endif
+}
+
+#ifndef USE_FRAMEBUFFER
+Uint32 select_texture_format(game_t* core)
+{
+    SDL_RendererInfo info;
+    Uint32           preferred[2];
+    Uint32           index;
+    Uint32           format_index;
+
+    preferred[0] = SDL_GetWindowPixelFormat(core->window);
+    preferred[1] = SDL_PIXELFORMAT_RGB444;
+
+    if (0 != SDL_GetRendererInfo(core->renderer, &info) || 0 == info.num_texture_formats)
+    {
+        return SDL_PIXELFORMAT_RGB444;
+    }
+
+    for (index = 0; index < 2; index += 1)
+    {
+        for (format_index = 0; format_index < info.num_texture_formats; format_index += 1)
+        {
+            if (preferred[index] == info.texture_formats[format_index])
+            {
+                return preferred[index];
+            }
+        }
+    }
+
+    for (format_index = 0; format_index < info.num_texture_formats; format_index += 1)
+    {
+        if (! SDL_ISPIXELFORMAT_FOURCC(info.texture_formats[format_index]))
+        {
+            return info.texture_formats[format_index];
+        }
+    }
+
+    return SDL_PIXELFORMAT_RGB444;
+}
+
+#endif /* USE_FRAMEBUFFER */
+
+// Returns the image as RGB24, released with arena_free().
+static unsigned char* load_image_from_file(const pfs_t* pfs, const char* file_name, arena_t* arena, int* width, int* height)
+{
+    Uint8*         resource_buf;
+    unsigned char* image_data;
+    int            orig_format;
+
+    if (NULL == file_name)
+    {
+        return NULL;
+    }
+
+    resource_buf = (Uint8*)load_binary_file_from_path(pfs, file_name, arena);
+    if (NULL == resource_buf)
+    {
+        return NULL;
+    }
+
+    SDL_AtomicLock(&decoder_arena_lock);
+    if (0 == decoder_arena)
+    {
+        decoder_arena = SDL_TLSCreate();
+    }
+    SDL_AtomicUnlock(&decoder_arena_lock);
+
+    // Without thread-local storage, the decoder uses the heap.
+    if (0 != decoder_arena)
+    {
+        SDL_TLSSet(decoder_arena, arena, NULL);
+    }
+
+    image_data = stbi_load_from_memory(resource_buf, size_of_file(pfs, file_name), width, height, &orig_format, STBI_rgb);
+
+    if (0 != decoder_arena)
+    {
+        SDL_TLSSet(decoder_arena, NULL, NULL);
+    }
+
+    arena_free(resource_buf, arena);
+
+    return image_data;
+}
+
+static void* decoder_alloc(size_t size)
+{
+    arena_t* arena = (arena_t*)SDL_TLSGet(decoder_arena);
+
+    return (NULL != arena) ? arena_alloc(size, arena) : SDL_malloc(size);
 }
 
-/* djb2 by Dan Bernstein
- * http://www.cse.yorku.ca/~oz/hash.html
- */
-Uint32 generate_hash(const unsigned char* name)
+static void* decoder_realloc(void* pointer, size_t size)
 {
-    Uint64 hash = 5381;
-    Uint32 c;
+    arena_t* arena = (arena_t*)SDL_TLSGet(decoder_arena);
 
-    while ((c = *name++))
+    return (NULL != arena) ? arena_realloc(pointer, size, arena) : SDL_realloc(pointer, size);
+}
+
+static void decoder_free(void* pointer)
+{
+    arena_t* arena = (arena_t*)SDL_TLSGet(decoder_arena);
+
+    if (NULL != arena)
+    {
+        arena_free(pointer, arena);
+    }
+    else
+    {
+        SDL_free(pointer);
+    }
+}
+
+#if !defined NDEBUG && !defined USE_FRAMEBUFFER
+void check_blit_format(SDL_Texture* texture, game_t* core)
+{
+    Uint32 format = SDL_PIXELFORMAT_UNKNOWN;
+
+    if (SDL_TRUE == core->conversion_reported)
+    {
+        return;
+    }
+
+    if (0 != SDL_QueryTexture(texture, &format, NULL, NULL, NULL))
     {
-        hash = ((hash << 5) + hash) + c;
+        return;
     }
 
-    return (Uint32)(hash & 0xffffffff);
+    if (format != core->texture_format)
+    {
+        SDL_Log("Blit requires pixel format conversion: %s -> %s",
+                SDL_GetPixelFormatName(format),
+                SDL_GetPixelFormatName(core->texture_format));
+        core->conversion_reported = SDL_TRUE;
+    }
 }
+#endif
 
-unsigned int xorshift(unsigned int* xs)
+#ifndef NDEBUG
+// Once running, a frame should not allocate from the heap.  Reports
+// the first one that did; the renderer may still grow its buffers
+// during the first frames.
+void check_heap_allocations(game_t* core)
 {
-    *xs ^= *xs << 7;
-    *xs ^= *xs >> 9;
-    *xs ^= *xs << 8;
-    return *xs;
+    Uint32 allocations = arena_get_heap_allocations();
+
+    if (SDL_TRUE == core->allocation_reported)
+    {
+        return;
+    }
+
+    if (core->heap_frame_count < HEAP_CHECK_WARMUP)
+    {
+        core->heap_frame_count += 1;
+        return;
+    }
+
+    if (allocations != core->heap_allocations)
+    {
+        SDL_Log("Frame allocated from the heap %u time(s)", allocations - core->heap_allocations);
+        core->allocation_reported = SDL_TRUE;
+    }
 }
+#endif
@@ -4,7 +4,7 @@
  *
  **/
 
-#include "SDL.h"
+#include "SDL_stdinc.h"
 
 const unsigned int  wordlist_de_letter_count     = 26;
 const unsigned int  wordlist_de_word_count       = 0x1855;
@@ -14,6 +14,25 @@ const SDL_bool      wordlist_de_is_cyrillic      = SDL_FALSE;
 const unsigned char wordlist_de_special_chars[5] = { 0xc4, 0xd6, 0xdc, 0xdf, 0x00 }; // Ä, Ö, Ü, ß
 const unsigned char wordlist_de_title[5]         = { 'W', 0xd6, 'R', 'D', 'L' };
 
+// First and last codepoint, and the letter of the first one.
+const Uint16        wordlist_de_input[9][3]      =
+{
+    { 0x0041, 0x005a, 0x41 }, // A-Z
+    { 0x0061, 0x007a, 0x41 }, // a-z
+    { 0x00c4, 0x00c4, 0xc4 }, // Ä
+    { 0x00e4, 0x00e4, 0xc4 }, // ä
+    { 0x00d6, 0x00d6, 0xd6 }, // Ö
+    { 0x00f6, 0x00f6, 0xd6 }, // ö
+    { 0x00dc, 0x00dc, 0xdc }, // Ü
+    { 0x00fc, 0x00fc, 0xdc }, // ü
+    { 0x00df, 0x00df, 0xdf }  // ß
+};
+const unsigned char wordlist_de_keypad[8][2]     =
+{
+    { 'A', 'C' }, { 'D', 'F' }, { 'G', 'I' }, { 'J', 'L' }, // Keys 2 to 5
+    { 'M', 'O' }, { 'P', 'S' }, { 'T', 'V' }, { 'W', 'Z' }  // Keys 6 to 9
+};
+
 const Uint32 wordlist_de_hash[0x1855] = {
     0x0cbc2a06, // AALEN
     0x0cbc2a83, // AALIG
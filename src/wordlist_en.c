@@ -4,7 +4,7 @@
  *
  **/
 
-#include "SDL.h"
+#include "SDL_stdinc.h"
 
 const unsigned int  wordlist_en_letter_count     = 26;
 const unsigned int  wordlist_en_word_count       = 0x905;
@@ -15,6 +15,18 @@ const SDL_bool      wordlist_en_is_cyrillic      = SDL_FALSE;
 const unsigned char wordlist_en_special_chars[1] = { 0x00 };
 const unsigned char wordlist_en_title[5]         = { 'W', 'O', 'R', 'D', 'L' };
 
+// First and last codepoint, and the letter of the first one.
+const Uint16        wordlist_en_input[2][3]      =
+{
+    { 0x0041, 0x005a, 0x41 }, // A-Z
+    { 0x0061, 0x007a, 0x41 }  // a-z
+};
+const unsigned char wordlist_en_keypad[8][2]     =
+{
+    { 'A', 'C' }, { 'D', 'F' }, { 'G', 'I' }, { 'J', 'L' }, // Keys 2 to 5
+    { 'M', 'O' }, { 'P', 'S' }, { 'T', 'V' }, { 'W', 'Z' }  // Keys 6 to 9
+};
+
 const unsigned int wordlist_en_hash[0x905] =
 {
     0x0ce4a84b, // CIGAR
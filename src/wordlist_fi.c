@@ -7,7 +7,7 @@
  *
  **/
 
-#include "SDL.h"
+#include "SDL_stdinc.h"
 
 const unsigned int  wordlist_fi_letter_count     = 26;
 const unsigned int  wordlist_fi_word_count       = 0xcc7;
@@ -17,6 +17,22 @@ const SDL_bool      wordlist_fi_is_cyrillic      = SDL_FALSE;
 const unsigned char wordlist_fi_special_chars[3] = { 0xc4, 0xd6, 0x00 }; // Ä, Ö
 const unsigned char wordlist_fi_title[5]         = { 'S', 'A', 'N', 'I', 'S' };
 
+// First and last codepoint, and the letter of the first one.
+const Uint16        wordlist_fi_input[6][3]      =
+{
+    { 0x0041, 0x005a, 0x41 }, // A-Z
+    { 0x0061, 0x007a, 0x41 }, // a-z
+    { 0x00c4, 0x00c4, 0xc4 }, // Ä
+    { 0x00e4, 0x00e4, 0xc4 }, // ä
+    { 0x00d6, 0x00d6, 0xd6 }, // Ö
+    { 0x00f6, 0x00f6, 0xd6 }  // ö
+};
+const unsigned char wordlist_fi_keypad[8][2]     =
+{
+    { 'A', 'C' }, { 'D', 'F' }, { 'G', 'I' }, { 'J', 'L' }, // Keys 2 to 5
+    { 'M', 'O' }, { 'P', 'S' }, { 'T', 'V' }, { 'W', 'Z' }  // Keys 6 to 9
+};
+
 const unsigned int wordlist_fi_hash[0xcc7] =
 {
     0x0cbc2b47, // AALOE
@@ -4,7 +4,7 @@
  *
  **/
 
-#include "SDL.h"
+#include "SDL_stdinc.h"
 
 const unsigned int  wordlist_ru_letter_count     = 32;
 const unsigned int  wordlist_ru_word_count       = 0x1039;
@@ -14,6 +14,22 @@ const SDL_bool      wordlist_ru_is_cyrillic      = SDL_TRUE;
 const unsigned char wordlist_ru_special_chars[2] = { 0x2d, 0x00 }; // -
 const unsigned char wordlist_ru_title[5]         = { 0xd1, 0xcb, 0xce, 0xc2, 0xce }; // СЛОВО
 
+// First and last codepoint, and the letter of the first one.  Ё is
+// written as Е in the word list.
+const Uint16        wordlist_ru_input[5][3]      =
+{
+    { 0x0410, 0x042f, 0xc0 }, // А-Я
+    { 0x0430, 0x044f, 0xc0 }, // а-я
+    { 0x0401, 0x0401, 0xc5 }, // Ё
+    { 0x0451, 0x0451, 0xc5 }, // ё
+    { 0x002d, 0x002d, 0x2d }  // -
+};
+const unsigned char wordlist_ru_keypad[8][2]     =
+{
+    { 0xc0, 0xc3 }, { 0xc4, 0xc7 }, { 0xc8, 0xca }, { 0xcb, 0xcf }, // Keys 2 to 5: А-Г, Д-З, И-К, Л-П
+    { 0xd0, 0xd3 }, { 0xd4, 0xd7 }, { 0xd8, 0xdb }, { 0xdc, 0xdf }  // Keys 6 to 9: Р-У, Ф-Ч, Ш-Ы, Ь-Я
+};
+
 const Uint32 wordlist_ru_hash[0x1039] = {
     0x15fe8499, // АББАТ
     0x15fe9e23, // АБЗАЦ
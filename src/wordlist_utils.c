@@ -5,17 +5,8 @@
  **/
 
 #include <time.h>
-#include "SDL.h"
-#include "game.h"
-
-void         set_language(const lang_t language, const SDL_bool set_title_screen, game_t* core);
-void         set_next_language(game_t* core);
-unsigned int get_nyt_daily_index(void);
-void         get_valid_answer(unsigned char valid_answer[6], game_t* core);
-SDL_bool     is_guess_allowed(const unsigned char* guess, game_t* core);
-void         validate_current_guess(SDL_bool* is_won, game_t* core);
-
-extern Uint32 generate_hash(const unsigned char* name);
+#include "SDL_stdinc.h"
+#include "game_core.h"
 
 extern const unsigned int  wordlist_en_letter_count;
 extern const unsigned int  wordlist_en_word_count;
@@ -29,6 +20,8 @@ extern const unsigned char wordlist_en_allowed[0x29a9][5];
 extern const SDL_bool      wordlist_en_is_cyrillic;
 extern const unsigned char wordlist_en_special_chars[1];
 extern const unsigned char wordlist_en_title[5];
+extern const Uint16        wordlist_en_input[2][3];
+extern const unsigned char wordlist_en_keypad[8][2];
 
 extern const unsigned int  wordlist_ru_letter_count;
 extern const unsigned int  wordlist_ru_word_count;
@@ -39,6 +32,8 @@ extern const unsigned char wordlist_ru[0x1039][5];
 extern const SDL_bool      wordlist_ru_is_cyrillic;
 extern const unsigned char wordlist_ru_special_chars[1];
 extern const unsigned char wordlist_ru_title[5];
+extern const Uint16        wordlist_ru_input[5][3];
+extern const unsigned char wordlist_ru_keypad[8][2];
 
 extern const unsigned int  wordlist_de_letter_count;
 extern const unsigned int  wordlist_de_word_count;
@@ -49,6 +44,8 @@ extern const unsigned char wordlist_de[0x185d][5];
 extern const SDL_bool      wordlist_de_is_cyrillic;
 extern const unsigned char wordlist_de_special_chars[4];
 extern const unsigned char wordlist_de_title[5];
+extern const Uint16        wordlist_de_input[9][3];
+extern const unsigned char wordlist_de_keypad[8][2];
 
 extern const unsigned int  wordlist_fi_letter_count;
 extern const unsigned int  wordlist_fi_word_count;
@@ -59,162 +56,202 @@ extern const unsigned char wordlist_fi[0xcc7][5];
 extern const SDL_bool      wordlist_fi_is_cyrillic;
 extern const unsigned char wordlist_fi_special_chars[1];
 extern const unsigned char wordlist_fi_title[5];
+extern const Uint16        wordlist_fi_input[6][3];
+extern const unsigned char wordlist_fi_keypad[8][2];
 
-void set_language(const lang_t language, const SDL_bool set_title_screen, game_t* core)
+static void load_input_letters(const wordlist_t* wordlist, unsigned char input_letter[INPUT_CODEPOINTS]);
+
+void set_language(const lang_t language, const SDL_bool set_title_screen, game_state_t* state)
 {
-    int index;
+    const unsigned char* title;
+    int                  index;
 
-    if (NULL == core)
+    if (NULL == state)
     {
         return;
     }
 
     if (SDL_TRUE == set_title_screen)
     {
-        core->show_menu       = SDL_TRUE;
-        core->tile[5].letter  = 'N';
-        core->tile[6].letter  = 'G';
-        core->tile[7].letter  = 'A';
-        core->tile[8].letter  = 'G';
-        core->tile[9].letter  = 'E';
-        core->tile[10].state  = CORRECT_LETTER;
-        core->tile[11].state  = CORRECT_LETTER;
-        core->tile[12].state  = CORRECT_LETTER;
-        core->tile[13].state  = WRONG_POSITION;
-        core->tile[14].state  = WRONG_POSITION;
-
-        core->tile[25].letter = 0x01; // New game icon
-        core->tile[26].letter = 0x02; // Load game icon
-        core->tile[27].letter = 0x03; // Game mode icon
-        core->tile[28].letter = 0x04; // Set lang. icon
-        core->tile[29].letter = 0x05; // Quit game icon
-
-        if (SDL_TRUE == core->language_set_once)
+        state->show_menu       = SDL_TRUE;
+        state->tile[5].letter  = 'N';
+        state->tile[6].letter  = 'G';
+        state->tile[7].letter  = 'A';
+        state->tile[8].letter  = 'G';
+        state->tile[9].letter  = 'E';
+        state->tile[10].state  = CORRECT_LETTER;
+        state->tile[11].state  = CORRECT_LETTER;
+        state->tile[12].state  = CORRECT_LETTER;
+        state->tile[13].state  = WRONG_POSITION;
+        state->tile[14].state  = WRONG_POSITION;
+
+        state->tile[25].letter = 0x01; // New game icon
+        state->tile[26].letter = 0x02; // Load game icon
+        state->tile[27].letter = 0x03; // Game mode icon
+        state->tile[28].letter = 0x04; // Set lang. icon
+        state->tile[29].letter = 0x05; // Quit game icon
+
+        if (SDL_TRUE == state->language_set_once)
+        {
+            state->tile[23].letter = 0x06; // Flag icon
+        }
+    }
+
+    load_wordlist(language, &state->wordlist);
+    suggest_build(&state->wordlist, &state->suggest);
+    predict_build(&state->wordlist, &state->predict);
+    stats_load(language, &state->hooks, &state->stats);
+    load_input_letters(&state->wordlist, state->input_letter);
+
+    if (SDL_TRUE == set_title_screen)
+    {
+        switch (state->wordlist.language)
+        {
+            default:
+            case LANG_ENGLISH:
+                title = wordlist_en_title;
+                break;
+            case LANG_RUSSIAN:
+                title = wordlist_ru_title;
+                break;
+            case LANG_GERMAN:
+                title = wordlist_de_title;
+                break;
+            case LANG_FINNISH:
+                title = wordlist_fi_title;
+                break;
+        }
+
+        for (index = 10; index <= 14; index += 1)
         {
-            core->tile[23].letter = 0x06; // Flag icon
+            state->tile[index].letter = title[index - 10];
         }
     }
+}
 
-    core->wordlist.language = language;
+void load_wordlist(const lang_t language, wordlist_t* wordlist)
+{
+    if (NULL == wordlist)
+    {
+        return;
+    }
 
     switch (language)
     {
         default:
         case LANG_ENGLISH:
-            if (SDL_TRUE == set_title_screen)
-            {
-                for (index = 10; index <= 14; index += 1)
-                {
-                    core->tile[index].letter = wordlist_en_title[index - 10];
-                }
-            }
-
-            core->wordlist.letter_count  = wordlist_en_letter_count;
-            core->wordlist.word_count    = wordlist_en_word_count;
-            core->wordlist.allowed_count = wordlist_en_allowed_count;
-            core->wordlist.first_letter  = wordlist_en_first_letter;
-            core->wordlist.last_letter   = wordlist_en_last_letter;
-            core->wordlist.is_cyrillic   = wordlist_en_is_cyrillic;
-            core->wordlist.special_chars = wordlist_en_special_chars;
-            core->wordlist.hash          = wordlist_en_hash;
-            core->wordlist.list          = wordlist_en;
-            core->wordlist.allowed_hash  = wordlist_en_allowed_hash;
-            core->wordlist.allowed_list  = wordlist_en_allowed;
+            wordlist->language      = LANG_ENGLISH;
+            wordlist->letter_count  = wordlist_en_letter_count;
+            wordlist->word_count    = wordlist_en_word_count;
+            wordlist->allowed_count = wordlist_en_allowed_count;
+            wordlist->first_letter  = wordlist_en_first_letter;
+            wordlist->last_letter   = wordlist_en_last_letter;
+            wordlist->is_cyrillic   = wordlist_en_is_cyrillic;
+            wordlist->special_chars = wordlist_en_special_chars;
+            wordlist->input         = wordlist_en_input;
+            wordlist->input_count   = sizeof(wordlist_en_input) / sizeof(wordlist_en_input[0]);
+            wordlist->keypad        = wordlist_en_keypad;
+            wordlist->hash          = wordlist_en_hash;
+            wordlist->list          = wordlist_en;
+            wordlist->allowed_hash  = wordlist_en_allowed_hash;
+            wordlist->allowed_list  = wordlist_en_allowed;
             break;
         case LANG_RUSSIAN:
-            if (SDL_TRUE == set_title_screen)
-            {
-                for (index = 10; index <= 14; index += 1)
-                {
-                    core->tile[index].letter = wordlist_ru_title[index - 10];
-                }
-            }
-
-            core->wordlist.letter_count  = wordlist_ru_letter_count;
-            core->wordlist.word_count    = wordlist_ru_word_count;
-            core->wordlist.allowed_count = 0;
-            core->wordlist.first_letter  = wordlist_ru_first_letter;
-            core->wordlist.last_letter   = wordlist_ru_last_letter;
-            core->wordlist.is_cyrillic   = wordlist_ru_is_cyrillic;
-            core->wordlist.special_chars = wordlist_ru_special_chars;
-            core->wordlist.hash          = wordlist_ru_hash;
-            core->wordlist.list          = wordlist_ru;
-            core->wordlist.allowed_hash  = NULL;
-            core->wordlist.allowed_list  = NULL;
+            wordlist->language      = LANG_RUSSIAN;
+            wordlist->letter_count  = wordlist_ru_letter_count;
+            wordlist->word_count    = wordlist_ru_word_count;
+            wordlist->allowed_count = 0;
+            wordlist->first_letter  = wordlist_ru_first_letter;
+            wordlist->last_letter   = wordlist_ru_last_letter;
+            wordlist->is_cyrillic   = wordlist_ru_is_cyrillic;
+            wordlist->special_chars = wordlist_ru_special_chars;
+            wordlist->input         = wordlist_ru_input;
+            wordlist->input_count   = sizeof(wordlist_ru_input) / sizeof(wordlist_ru_input[0]);
+            wordlist->keypad        = wordlist_ru_keypad;
+            wordlist->hash          = wordlist_ru_hash;
+            wordlist->list          = wordlist_ru;
+            wordlist->allowed_hash  = NULL;
+            wordlist->allowed_list  = NULL;
             break;
         case LANG_GERMAN:
-            if (SDL_TRUE == set_title_screen)
-            {
-                for (index = 10; index <= 14; index += 1)
-                {
-                    core->tile[index].letter = wordlist_de_title[index - 10];
-                }
-            }
-
-            core->wordlist.letter_count  = wordlist_de_letter_count;
-            core->wordlist.word_count    = wordlist_de_word_count;
-            core->wordlist.allowed_count = 0;
-            core->wordlist.first_letter  = wordlist_de_first_letter;
-            core->wordlist.last_letter   = wordlist_de_last_letter;
-            core->wordlist.is_cyrillic   = wordlist_de_is_cyrillic;
-            core->wordlist.special_chars = wordlist_de_special_chars;
-            core->wordlist.hash          = wordlist_de_hash;
-            core->wordlist.list          = wordlist_de;
-            core->wordlist.allowed_hash  = NULL;
-            core->wordlist.allowed_list  = NULL;
+            wordlist->language      = LANG_GERMAN;
+            wordlist->letter_count  = wordlist_de_letter_count;
+            wordlist->word_count    = wordlist_de_word_count;
+            wordlist->allowed_count = 0;
+            wordlist->first_letter  = wordlist_de_first_letter;
+            wordlist->last_letter   = wordlist_de_last_letter;
+            wordlist->is_cyrillic   = wordlist_de_is_cyrillic;
+            wordlist->special_chars = wordlist_de_special_chars;
+            wordlist->input         = wordlist_de_input;
+            wordlist->input_count   = sizeof(wordlist_de_input) / sizeof(wordlist_de_input[0]);
+            wordlist->keypad        = wordlist_de_keypad;
+            wordlist->hash          = wordlist_de_hash;
+            wordlist->list          = wordlist_de;
+            wordlist->allowed_hash  = NULL;
+            wordlist->allowed_list  = NULL;
             break;
         case LANG_FINNISH:
-            if (SDL_TRUE == set_title_screen)
-            {
-                for (index = 10; index <= 14; index += 1)
-                {
-                    core->tile[index].letter = wordlist_fi_title[index - 10];
-                }
-            }
-
-            core->wordlist.letter_count  = wordlist_fi_letter_count;
-            core->wordlist.word_count    = wordlist_fi_word_count;
-            core->wordlist.allowed_count = 0;
-            core->wordlist.first_letter  = wordlist_fi_first_letter;
-            core->wordlist.last_letter   = wordlist_fi_last_letter;
-            core->wordlist.is_cyrillic   = wordlist_fi_is_cyrillic;
-            core->wordlist.special_chars = wordlist_fi_special_chars;
-            core->wordlist.hash          = wordlist_fi_hash;
-            core->wordlist.list          = wordlist_fi;
-            core->wordlist.allowed_hash  = NULL;
-            core->wordlist.allowed_list  = NULL;
+            wordlist->language      = LANG_FINNISH;
+            wordlist->letter_count  = wordlist_fi_letter_count;
+            wordlist->word_count    = wordlist_fi_word_count;
+            wordlist->allowed_count = 0;
+            wordlist->first_letter  = wordlist_fi_first_letter;
+            wordlist->last_letter   = wordlist_fi_last_letter;
+            wordlist->is_cyrillic   = wordlist_fi_is_cyrillic;
+            wordlist->special_chars = wordlist_fi_special_chars;
+            wordlist->input         = wordlist_fi_input;
+            wordlist->input_count   = sizeof(wordlist_fi_input) / sizeof(wordlist_fi_input[0]);
+            wordlist->keypad        = wordlist_fi_keypad;
+            wordlist->hash          = wordlist_fi_hash;
+            wordlist->list          = wordlist_fi;
+            wordlist->allowed_hash  = NULL;
+            wordlist->allowed_list  = NULL;
             break;
     }
 }
 
-void set_next_language(game_t* core)
+// Of the answers, without loading the word list.
+Uint32 get_word_count(const lang_t language)
+{
+    switch (language)
+    {
+        case LANG_ENGLISH:
+            return wordlist_en_word_count;
+        case LANG_RUSSIAN:
+            return wordlist_ru_word_count;
+        case LANG_GERMAN:
+            return wordlist_de_word_count;
+        case LANG_FINNISH:
+            return wordlist_fi_word_count;
+        default:
+            return 0;
+    }
+}
+
+void set_next_language(game_state_t* state)
 {
-    switch (core->wordlist.language)
+    switch (state->wordlist.language)
     {
         case LANG_ENGLISH:
-            set_language(LANG_RUSSIAN, SDL_TRUE, core);
+            set_language(LANG_RUSSIAN, SDL_TRUE, state);
             break;
         case LANG_RUSSIAN:
-            set_language(LANG_GERMAN, SDL_TRUE, core);
+            set_language(LANG_GERMAN, SDL_TRUE, state);
             break;
         case LANG_GERMAN:
-            set_language(LANG_FINNISH, SDL_TRUE, core);
+            set_language(LANG_FINNISH, SDL_TRUE, state);
             break;
         case LANG_FINNISH:
-            set_language(LANG_ENGLISH, SDL_TRUE, core);
+            set_language(LANG_ENGLISH, SDL_TRUE, state);
             break;
     }
 }
 
 unsigned int get_nyt_daily_index(void)
 {
-    time_t seconds;
-    int    days_since_epoch;
-    int    daily_index;
+    int daily_index;
 
-    seconds          = time(NULL);
-    days_since_epoch = seconds / (60 * 60 * 24);
-    daily_index      = days_since_epoch - 18797u;
+    daily_index = (int)get_days_since_epoch() - 18797;
 
     if (daily_index < 0)
     {
@@ -229,23 +266,35 @@ unsigned int get_nyt_daily_index(void)
     return daily_index;
 }
 
-void get_valid_answer(unsigned char valid_answer[6], game_t* core)
+unsigned int get_days_since_epoch(void)
+{
+    time_t seconds = time(NULL);
+
+    if (seconds < 0)
+    {
+        return 0;
+    }
+
+    return (unsigned int)(seconds / (60 * 60 * 24));
+}
+
+void get_valid_answer(unsigned char valid_answer[6], game_state_t* state)
 {
     int index;
 
-    if (NULL == core)
+    if (NULL == state)
     {
         return;
     }
 
     for (index = 0; index < 5; index += 1)
     {
-        valid_answer[index] = core->wordlist.list[core->valid_answer_index][index];
+        valid_answer[index] = state->wordlist.list[state->valid_answer_index][index];
     }
     valid_answer[5] = 0;
 }
 
-SDL_bool is_guess_allowed(const unsigned char* guess, game_t* core)
+SDL_bool is_guess_allowed(const unsigned char* guess, game_state_t* state)
 {
     Uint32 guess_hash;
 
@@ -264,24 +313,24 @@ SDL_bool is_guess_allowed(const unsigned char* guess, game_t* core)
     {
         int index;
         int start_index = 0;
-        int end_index   = core->wordlist.word_count - 1;
+        int end_index   = state->wordlist.word_count - 1;
 
         for (index = start_index; index < end_index; index +=1)
         {
-            if (guess_hash == core->wordlist.hash[index])
+            if (guess_hash == state->wordlist.hash[index])
             {
                 return SDL_TRUE;
             }
         }
 
-        if ((NULL != core->wordlist.allowed_hash) &&
-            (NULL != core->wordlist.allowed_list) &&
-            (core->wordlist.allowed_count > 0))
+        if ((NULL != state->wordlist.allowed_hash) &&
+            (NULL != state->wordlist.allowed_list) &&
+            (state->wordlist.allowed_count > 0))
         {
-            end_index = core->wordlist.allowed_count;
+            end_index = state->wordlist.allowed_count;
             for (index = start_index; index < end_index; index +=1)
             {
-                if (guess_hash == core->wordlist.allowed_hash[index])
+                if (guess_hash == state->wordlist.allowed_hash[index])
                 {
                     return SDL_TRUE;
                 }
@@ -292,94 +341,134 @@ SDL_bool is_guess_allowed(const unsigned char* guess, game_t* core)
     return SDL_FALSE;
 }
 
-void validate_current_guess(SDL_bool* is_won, game_t* core)
+void validate_current_guess(SDL_bool* is_won, game_state_t* state)
 {
-    Uint32 guess_hash;
+    unsigned char valid_answer[6] = { 0 };
+    state_t       result[5];
+    int           letter_index;
 
-    if (NULL == core)
+    if (NULL == state)
     {
         return;
     }
 
-    guess_hash = generate_hash(core->current_guess);
+    get_valid_answer(valid_answer, state);
+    *is_won = score_guess(state->current_guess, valid_answer, result);
 
+    for (letter_index = 0; letter_index < 5; letter_index += 1)
     {
-        int           letter_index;
-        int           answer_index;
-        Uint32        answer_hash;
-        int           start_index     = 0;
-        int           end_index       = core->wordlist.word_count - 1;
-        unsigned char valid_answer[6] = { 0 };
-        //unsigned char shelf[5];       = { 0 };
-
-        for (answer_index = start_index; answer_index < end_index; answer_index +=1)
+        int tile_index = (state->current_index - 4) + letter_index;
+
+        state->tile[tile_index].state = result[letter_index];
+    }
+}
+
+SDL_bool score_guess(const unsigned char* guess, const unsigned char* answer, state_t result[5])
+{
+    unsigned char remaining[5];
+    int           letter_index;
+    SDL_bool      is_won = SDL_TRUE;
+
+    // First check for exact matches.
+    for (letter_index = 0; letter_index < 5; letter_index += 1)
+    {
+        if (guess[letter_index] == answer[letter_index])
         {
-            if (guess_hash == core->wordlist.hash[answer_index])
-            {
-                break;
-            }
+            result[letter_index]    = CORRECT_LETTER;
+            remaining[letter_index] = 0;
+        }
+        else
+        {
+            result[letter_index]    = WRONG_LETTER;
+            remaining[letter_index] = answer[letter_index];
+            is_won                  = SDL_FALSE;
         }
+    }
 
-        get_valid_answer(valid_answer, core);
-        answer_hash = generate_hash(valid_answer);
+    // Then check for matches in the wrong location.
+    for (letter_index = 0; letter_index < 5; letter_index += 1)
+    {
+        int temp_index;
 
-        // First check for exact matches.
-        for (letter_index = 0; letter_index < 5; letter_index += 1)
+        if (CORRECT_LETTER == result[letter_index])
         {
-            int     tile_index   = (core->current_index - 4) + letter_index;
-            tile_t* current_tile = &core->tile[tile_index];
-
-            if (core->current_guess[letter_index] == valid_answer[letter_index])
-            {
-                current_tile->state        = CORRECT_LETTER;
-                //shelf[letter_index]        = valid_answer[letter_index];
-                valid_answer[letter_index] = 0;
-            }
+            continue;
         }
 
-        // Then check for matches in the wrong location.
-        for (letter_index = 0; letter_index < 5; letter_index += 1)
+        for (temp_index = 0; temp_index < 5; temp_index += 1)
         {
-            int     tile_index   = (core->current_index - 4) + letter_index;
-            tile_t* current_tile = &core->tile[tile_index];
-
-            if (CORRECT_LETTER == current_tile->state)
-            {
-                continue;
-            }
-            else
+            if (guess[letter_index] == remaining[temp_index])
             {
-                int temp_index;
-                for (temp_index = 0; temp_index < 5; temp_index += 1)
-                {
-                    if (core->current_guess[letter_index] == valid_answer[temp_index])
-                    {
-                        current_tile->state = WRONG_POSITION;
-                    }
-                }
+                result[letter_index] = WRONG_POSITION;
+                break;
             }
         }
+    }
 
-        // Finally, check for wrong letters.
-        for (letter_index = 0; letter_index < 5; letter_index += 1)
-        {
-            int     tile_index   = (core->current_index - 4) + letter_index;
-            tile_t* current_tile = &core->tile[tile_index];
+    return is_won;
+}
 
-            if (LETTER_SELECT == current_tile->state)
-            {
-                current_tile->state = WRONG_LETTER;
-            }
-        }
+// Identifies the contents of a word list, so data derived from it can
+// be checked before use.
+Uint32 get_wordlist_checksum(const wordlist_t* wordlist)
+{
+    Uint32       checksum = 5381;
+    unsigned int index;
+
+    for (index = 0; index < wordlist->word_count; index += 1)
+    {
+        checksum = ((checksum << 5) + checksum) ^ wordlist->hash[index];
+    }
 
-        // Do we have a winner?
-        if (guess_hash == answer_hash)
+    if (NULL != wordlist->allowed_hash)
+    {
+        for (index = 0; index < wordlist->allowed_count; index += 1)
         {
-            *is_won = SDL_TRUE;
+            checksum = ((checksum << 5) + checksum) ^ wordlist->allowed_hash[index];
         }
-        else
+    }
+
+    return checksum;
+}
+
+// Guesses are numbered through the answers, then the allowed guesses.
+const unsigned char* get_guess_word(const wordlist_t* wordlist, Uint32 index)
+{
+    if (index < wordlist->word_count)
+    {
+        return wordlist->list[index];
+    }
+
+    index -= wordlist->word_count;
+    if ((NULL != wordlist->allowed_list) && (index < wordlist->allowed_count))
+    {
+        return wordlist->allowed_list[index];
+    }
+
+    return NULL;
+}
+
+// Expands the input ranges of a word list, so that text input is a
+// single lookup.
+static void load_input_letters(const wordlist_t* wordlist, unsigned char input_letter[INPUT_CODEPOINTS])
+{
+    unsigned int range_index;
+
+    SDL_memset(input_letter, 0, INPUT_CODEPOINTS);
+
+    if (NULL == wordlist->input)
+    {
+        return;
+    }
+
+    for (range_index = 0; range_index < wordlist->input_count; range_index += 1)
+    {
+        const Uint16* range = wordlist->input[range_index];
+        Uint16        codepoint;
+
+        for (codepoint = range[0]; codepoint <= range[1] && codepoint < INPUT_CODEPOINTS; codepoint += 1)
         {
-            *is_won = SDL_FALSE;
+            input_letter[codepoint] = (unsigned char)(range[2] + (codepoint - range[0]));
         }
     }
 }
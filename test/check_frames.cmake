@@ -0,0 +1,54 @@
+# Plays back a headless script and compares the frame checksums with
+# the expected ones:
+#   cmake -DWORDLE=<executable> -DSCRIPT=<script> -DEXPECTED=<file>
+#         [-DUPDATE=ON] -P check_frames.cmake
+# With UPDATE, the expected file is written instead.  Run it from the
+# directory that contains data.pfs.
+
+cmake_minimum_required(VERSION 3.0)
+
+execute_process(
+    COMMAND         ${WORDLE} --headless ${SCRIPT}
+    OUTPUT_VARIABLE output
+    RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${WORDLE} --headless ${SCRIPT} failed: ${result}")
+endif()
+
+# Keep the checksums only, the frame rate differs from run to run.
+string(REGEX MATCHALL "frame [0-9]+ [0-9a-f]+\n" frames "${output}")
+string(REPLACE ";" "" frames "${frames}")
+
+if("${frames}" STREQUAL "")
+    message(FATAL_ERROR "No frames rendered by ${SCRIPT}")
+endif()
+
+if(UPDATE)
+    file(WRITE ${EXPECTED} "${frames}")
+    message(STATUS "Wrote ${EXPECTED}")
+    return()
+endif()
+
+if(NOT EXISTS ${EXPECTED})
+    message("No expected frames in ${EXPECTED}, build the headless_frames target first.")
+    return()
+endif()
+
+file(READ ${EXPECTED} expected)
+
+if(NOT "${frames}" STREQUAL "${expected}")
+    string(STRIP "${frames}"   frames)
+    string(STRIP "${expected}" expected)
+    string(REPLACE "\n" ";" frame_list    "${frames}")
+    string(REPLACE "\n" ";" expected_list "${expected}")
+
+    foreach(line IN LISTS frame_list)
+        list(FIND expected_list "${line}" index)
+        if(index EQUAL -1)
+            message("Differs: ${line}")
+        endif()
+    endforeach()
+
+    message(FATAL_ERROR "Frame checksums differ from ${EXPECTED}")
+endif()